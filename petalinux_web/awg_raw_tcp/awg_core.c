@@ -0,0 +1,272 @@
+// =============================================================
+// awg_core.c  —  libawg_core front end: backend selection + frame helpers
+// -------------------------------------------------------------
+// One core for every frontend (awg_server, the WS/UDP Python servers,
+// the test programs). The backend is picked at runtime through an ops
+// table (awg_core_backend.h):
+//   AWG_CORE_BACKEND=auto   (default) mmap, then gpiod if compiled in
+//   AWG_CORE_BACKEND=mmap   AXI GPIO through mmap (awg_core_mmap.c)
+//   AWG_CORE_BACKEND=gpiod  libgpiod v2 (awg_core_libgpiod.c, WITH_GPIOD=1)
+//   AWG_CORE_BACKEND=dma    AXI DMA + PL pacer (awg_core_dma.c)
+//   AWG_CORE_BACKEND=sim    no hardware (awg_core_sim.c)
+// Register addresses come from AWG_ADDR_*, UIO or the device tree
+// (awg_core_dt.c); the old base macros are only the fallback.
+// AWG_BURST_STATS=1 turns on the burst engine counters (off by default:
+// they cost two clock reads and three 64-bit atomics per burst).
+//
+// Build (shared lib, see Makefile.onboard 'lib'):
+//   make -f Makefile.onboard lib   ->  libawg_core.so
+//
+// Minimal Python usage (ctypes):
+//   import ctypes
+//   lib = ctypes.CDLL("./libawg_core.so")
+//   assert lib.awg_init() == 0
+//   lib.awg_send_hex4(b"...24hex...", b"...144hex...", b"...24hex...", b"...144hex...")
+//   lib.awg_close()
+//
+// -------------------------------------------------------------
+// Input Format (FOUR HEX STRINGS, fixed length):
+//   1) idxA_hex  : 24 hex chars  (3 hex per tone * 8 tones)
+//   2) gainA_hex : 144 hex chars (18 hex per tone * 8 tones)
+//   3) idxB_hex  : 24 hex chars
+//   4) gainB_hex : 144 hex chars
+//
+//   - Index (idx): each tone uses 3 hex chars, 0x000 .. 0x383 (0..899)
+//   - Gain (Q1.17): each tone uses 18 hex chars (72 bits) BUT ONLY THE
+//     LOWEST 20 BITS ARE USED by hardware (mask to 0x1FFFF).
+//     This matches the original Q1.17 format (0..0x1FFFF).
+//
+//   Total per channel: 24 + 144 = 168 hex
+//   Both channels (A+B): 336 hex total, but passed as 4 groups to improve readability.
+//   Order within each group is tone 0..7 (exactly 8 tones).
+//
+// -------------------------------------------------------------
+// Words on the bus (32-bit):
+//   [31:28] cmd: 0x1 = INDEX, 0x2 = GAIN, 0xF = COMMIT
+//   [27]    ch : 0=A, 1=B
+//   [26:24] tone: 0..7
+//   [23:20] reserved (0)
+//   [19:0]  payload: idx20 or gain20 (Q1.17 low 20 bits)
+// =============================================================
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "awg_core.h"
+#include "awg_core_backend.h"
+#include "awg_hex_decode.h"
+
+static const awg_backend_ops_t *const k_backends[] = {
+    &awg_backend_mmap,
+#ifdef AWG_WITH_GPIOD
+    &awg_backend_gpiod,
+#endif
+    &awg_backend_dma,
+    &awg_backend_sim,
+};
+
+static const awg_backend_ops_t *g_ops = NULL;   // NULL until awg_init() succeeded
+
+// ------------------ Burst engine counters ------------------
+// Opt-in (AWG_BURST_STATS): on ARMv7 each 64-bit atomic add is an
+// ldrexd/strexd loop, too much for every frame of the player.
+static int      g_burst_stats = 0;    // read once by awg_init_backend()
+static uint64_t g_burst_words = 0;    // totals, updated with relaxed atomics
+static uint64_t g_burst_calls = 0;
+static uint64_t g_burst_ns    = 0;
+
+static inline uint64_t mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static const awg_backend_ops_t *find_backend(const char *name) {
+    for (size_t i = 0; i < sizeof(k_backends) / sizeof(k_backends[0]); ++i)
+        if (strcmp(k_backends[i]->name, name) == 0) return k_backends[i];
+    return NULL;
+}
+
+// ------------------ Public API ------------------
+// Backend close() must cope with a partial init: it is called on failure.
+int awg_init_backend(const char *name)
+{
+    if (g_ops) return 0;
+    const char *bs = getenv("AWG_BURST_STATS");
+    g_burst_stats = bs && atoi(bs) != 0;
+    if (!name || !*name || strcmp(name, "auto") == 0) {
+        // Fastest hardware path first; dma/sim only when asked for
+        const char *order[] = { "mmap", "gpiod" };
+        for (size_t i = 0; i < sizeof(order) / sizeof(order[0]); ++i) {
+            const awg_backend_ops_t *ops = find_backend(order[i]);
+            if (!ops) continue;
+            if (ops->init() == 0) { g_ops = ops; return 0; }
+            ops->close();                          // release a partial init
+        }
+        fprintf(stderr, "[CORE] no hardware backend available\n");
+        return -1;
+    }
+
+    const awg_backend_ops_t *ops = find_backend(name);
+    if (!ops) { fprintf(stderr, "[CORE] unknown backend '%s'\n", name); return -4; }
+    int rc = ops->init();
+    if (rc != 0) {
+        fprintf(stderr, "[CORE] backend '%s' init failed (%d)\n", name, rc);
+        ops->close();
+        return rc;
+    }
+    g_ops = ops;
+    return 0;
+}
+
+int awg_init(void)
+{
+    return awg_init_backend(getenv("AWG_CORE_BACKEND"));
+}
+
+const char *awg_core_backend_name(void)
+{
+    return g_ops ? g_ops->name : "none";
+}
+
+void awg_close(void)
+{
+    if (g_ops) { g_ops->close(); g_ops = NULL; }
+}
+
+// ---- Fast path: accept four HEX blocks, parse & stream immediately ----
+// Decoded in one pass by awg_hex_decode.c (NEON / SWAR, validated), then
+// written as one 33-word burst. Returns -3 on a non-hex char.
+int awg_send_hex4(const char *idxA_hex, const char *gainA_hex,
+                  const char *idxB_hex, const char *gainB_hex)
+{
+    if (!g_ops) return -1;
+    if (!idxA_hex || !gainA_hex || !idxB_hex || !gainB_hex) return -2;
+
+    uint32_t words[AWG_HEX_FRAME_WORDS];
+    if (awg_hex_decode4(idxA_hex, gainA_hex, idxB_hex, gainB_hex, words) != 0) return -3;
+    return awg_send_words32_burst(words, AWG_HEX_FRAME_WORDS);
+}
+
+// Same for one contiguous 336-char frame (UDP/WS datagram layout)
+int awg_send_hex336(const char *hex336)
+{
+    if (!g_ops) return -1;
+    if (!hex336) return -2;
+
+    uint32_t words[AWG_HEX_FRAME_WORDS];
+    if (awg_hex_decode_frame(hex336, words) != 0) return -3;
+    return awg_send_words32_burst(words, AWG_HEX_FRAME_WORDS);
+}
+
+// Flexible version: stream exactly "count" words (caller decides commit)
+int awg_send_words32(const uint32_t *words32, int count)
+{
+    if (!g_ops) return -1;
+    if (!words32 || count <= 0) return -2;
+    return g_ops->write_strict ? g_ops->write_strict(words32, count)
+                               : g_ops->write(words32, count);
+}
+
+// [NEW] Tones per channel, see awg_core.h (read once; every caller agrees)
+int awg_tones(void)
+{
+    static int tones = 0;
+    if (!tones) {
+        const char *e = getenv("AWG_TONES");
+        int n = e ? atoi(e) : 8;
+        if (n != 8 && n != AWG_MAX_TONES) {
+            fprintf(stderr, "[CORE] AWG_TONES=%s unsupported (8 or %d), using 8\n", e, AWG_MAX_TONES);
+            n = 8;
+        }
+        tones = n;
+    }
+    return tones;
+}
+
+// Sets all tone gains to zero and issues a commit command.
+// This is a safety function to ensure the hardware is in a known safe state.
+int awg_zero_output(void)
+{
+    if (!g_ops) return -1;
+
+    // Build: write GAIN=0 for every tone of A and B, then COMMIT
+    uint32_t words[2 * AWG_MAX_TONES + 1];
+    int idx = 0;
+
+    for (int ch = 0; ch < 2; ++ch) {
+        for (int tone = 0; tone < awg_tones(); ++tone) {
+            words[idx++] = awg_make_cfg_word(0x2u, (uint32_t)ch, (uint32_t)tone, 0u); // gain20 = 0
+        }
+    }
+    words[idx++] = (0xFu << 28); // COMMIT
+
+    // Use the existing awg_send_words32 to send the sequence
+    return awg_send_words32(words, idx);
+}
+
+// [NEW] Fast reset words, see awg_core.h. SAFE first: a client may have left
+// commit_safe_reg at 0, which would make the PL ignore both COMMITs.
+int awg_make_reset_words(uint32_t *words)
+{
+    int n = 0;
+    words[n++] = (0xCu << 28) | 1u;                 // SAFE: allow commit
+    for (int bank = 0; bank < 2; ++bank) {
+        for (int ch = 0; ch < 2; ++ch) {
+            for (int tone = 0; tone < awg_tones(); ++tone) {
+                words[n++] = awg_make_cfg_word(0x1u, (uint32_t)ch, (uint32_t)tone, 0u); // INDEX = 0
+                words[n++] = awg_make_cfg_word(0x2u, (uint32_t)ch, (uint32_t)tone, 0u); // GAIN  = 0
+            }
+        }
+        words[n++] = (0xFu << 28);                   // COMMIT: this bank goes on air
+    }
+    return n;
+}
+
+int awg_reset_banks(void)
+{
+    if (!g_ops) return -1;
+
+    uint32_t words[AWG_RESET_WORDS_MAX];
+    int n = awg_make_reset_words(words);
+    return awg_send_words32_burst(words, n);
+}
+
+// Burst version: same wire protocol as awg_send_words32(), through the
+// backend's fastest path (mmap: WEN shadow and release stores). Counted
+// only with AWG_BURST_STATS=1; otherwise it is the bare backend write.
+int awg_send_words32_burst(const uint32_t *words32, int count)
+{
+    if (!g_ops) return -1;
+    if (!words32 || count <= 0) return -2;
+    if (!g_burst_stats) return g_ops->write(words32, count);
+
+    uint64_t t0 = mono_ns();
+    int rc = g_ops->write(words32, count);
+    uint64_t dt = mono_ns() - t0;
+
+    __atomic_fetch_add(&g_burst_words, (uint64_t)count, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&g_burst_calls, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&g_burst_ns, dt, __ATOMIC_RELAXED);
+    return rc;
+}
+
+void awg_get_burst_stats(awg_burst_stats_t *st)
+{
+    if (!st) return;
+    st->enabled = g_burst_stats;
+    st->words   = __atomic_load_n(&g_burst_words, __ATOMIC_RELAXED);
+    st->bursts  = __atomic_load_n(&g_burst_calls, __ATOMIC_RELAXED);
+    st->busy_ns = __atomic_load_n(&g_burst_ns,    __ATOMIC_RELAXED);
+    st->words_per_sec = st->busy_ns ? (double)st->words * 1e9 / (double)st->busy_ns : 0.0;
+}
+
+void awg_reset_burst_stats(void)
+{
+    __atomic_store_n(&g_burst_words, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&g_burst_calls, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&g_burst_ns,    0, __ATOMIC_RELAXED);
+}
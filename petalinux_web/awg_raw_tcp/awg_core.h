@@ -3,10 +3,18 @@
 #define AWG_CORE_H
 
 #include <stdint.h>
+#include <stddef.h>
 
-// Initialize GPIO (call only once at startup)
+// Initialize the core (call only once at startup). The backend comes from
+// AWG_CORE_BACKEND (auto|mmap|gpiod|dma|sim, default auto), see awg_core.c.
 int awg_init(void);
 
+// [NEW] Same with an explicit backend name (NULL/"auto" = fastest available)
+int awg_init_backend(const char *name);
+
+// [NEW] Name of the active backend ("mmap", "gpiod", "dma", "sim", "none")
+const char *awg_core_backend_name(void);
+
 // Send a set of hex strings (4 strings: 24, 144, 24, 144 chars)
 int awg_send_hex4(
     const char *idxA_hex,   // 24 hex chars
@@ -15,13 +23,170 @@ int awg_send_hex4(
     const char *gainB_hex   // 144 hex chars
 );
 
+// [NEW] Same, for one contiguous 336-char frame (idxA gainA idxB gainB).
+// Both hex entry points validate: -3 = non-hex character, nothing sent.
+int awg_send_hex336(const char *hex336);
+
 // Send an array of pre-packed 32-bit words to the hardware
 int awg_send_words32(const uint32_t *words32, int count);
 
+// Burst version of awg_send_words32(): WEN level kept in a shadow copy, so no
+// read-back of the WEN register, and one barrier fewer per word (on ARMv7 the
+// release fences are still a dmb ish each). Same wire protocol; safe to call
+// from the player thread and the direct server.
+int awg_send_words32_burst(const uint32_t *words32, int count);
+
+// Throughput counters of the burst engine (totals since start / last reset).
+// Only counted with AWG_BURST_STATS=1 (read by awg_init), else all zero.
+typedef struct {
+    int      enabled;        // AWG_BURST_STATS was set
+    uint64_t words;          // words strobed
+    uint64_t bursts;         // awg_send_words32_burst() calls
+    uint64_t busy_ns;        // time spent inside the strobe loop
+    double   words_per_sec;  // words / busy time
+} awg_burst_stats_t;
+
+void awg_get_burst_stats(awg_burst_stats_t *st);
+void awg_reset_burst_stats(void);
+
+// ---- [NEW] Tone count of the PL build (waveform_generator_v5 TONES) ----
+// AWG_TONES=8 (default) or 16, must match the bitstream. Tone field of the
+// command word: bits 2:0 in [26:24], bit 3 in [23] (0 on 8-tone builds,
+// whose decoder drops INDEX/GAIN for tones 8..15). The 336-char hex frame
+// formats only address tones 0..7.
+#define AWG_MAX_TONES        16
+#define AWG_FRAME_WORDS_MAX  (2 * 2 * AWG_MAX_TONES + 1)  // INDEX+GAIN per tone, 2 channels, COMMIT
+
+int awg_tones(void);
+
+static inline uint32_t awg_make_cfg_word(uint32_t cmd, uint32_t ch, uint32_t tone, uint32_t data20) {
+    return (cmd << 28) | ((ch & 1u) << 27) | ((tone & 7u) << 24) | (((tone >> 3) & 1u) << 23)
+         | (data20 & 0xFFFFFu);
+}
+
 // Zeros all output gains for safety
 int awg_zero_output(void);
 
+// [NEW] Fast reset: SAFE=1 (commits enabled), then index=0/gain=0 for all
+// tones of both channels + COMMIT, twice, so BOTH ping-pong banks hold the
+// zero frame. Silent from the first COMMIT on; one burst (67 words, 131
+// with 16 tones).
+int awg_reset_banks(void);
+
+// [NEW] The same words into words[AWG_RESET_WORDS_MAX], nothing written;
+// returns the count. For callers that send them on another path (DMA).
+#define AWG_RESET_WORDS_MAX (1 + 2 * AWG_FRAME_WORDS_MAX)
+int awg_make_reset_words(uint32_t *words);
+
 // Deinitialize and release resources
 void awg_close(void);
 
+// ---- Simulator backend (AWG_CORE_BACKEND=sim), awg_core_sim.c ----
+// Index/gain are kept at the PL widths (IDX_W=10, GAIN_W=18 bits).
+typedef struct {
+    uint64_t words;           // words written
+    uint64_t commits;         // COMMIT words (bank swaps)
+    uint64_t other_words;     // SAFE / DWELL / unknown commands
+    uint32_t index[2][AWG_MAX_TONES]; // bank on air: [ch][tone] index
+    uint32_t gain[2][AWG_MAX_TONES];  // bank on air: [ch][tone] gain (Q1.17)
+    uint64_t blocked_commits; // COMMIT words ignored while SAFE=0
+    uint32_t safe;            // commit_safe_reg (1 after reset)
+    uint32_t shadow_gain_max; // largest gain in the shadow bank (0 = silent)
+    uint64_t last_commit_ns;  // [NEW] CLOCK_MONOTONIC of the last bank swap
+    uint64_t gap_count;       // [NEW] commit-to-commit intervals seen
+    uint64_t gap_min_ns;      //       (what the DAC sees as frame timing)
+    uint64_t gap_max_ns;
+    uint64_t gap_sum_ns;
+} awg_sim_state_t;
+
+// Snapshot of the simulated PL. Returns -1 unless the sim backend is active.
+int awg_sim_get_state(awg_sim_state_t *st);
+
+// [NEW] Zero the counters and commit-gap statistics (register banks kept).
+void awg_sim_reset_stats(void);
+
+// ---- AXI DMA (MM2S) backend, awg_core_dma.c ----
+// Streams a whole word array from a CMA buffer; the PL pacer
+// (axis_cmd_frame_pacer.v) releases one COMMIT per frame period.
+
+// Map DMA, pacer GPIO, UIO and the u-dma-buf CMA buffer (call once)
+int awg_dma_init(void);
+
+// 1 if awg_dma_init() succeeded
+int awg_dma_ready(void);
+
+// CPU pointer to the CMA buffer and its capacity in words
+uint32_t *awg_dma_buffer(size_t *cap_words);
+
+// Frame period enforced by the PL pacer (COMMIT to COMMIT)
+int awg_dma_set_period_us(uint32_t period_us);
+
+// Start streaming "count" words; zero-copy if words32 lies in the CMA buffer
+int awg_dma_send(const uint32_t *words32, size_t count);
+
+// 1 while a transfer started by awg_dma_send() is in flight
+int awg_dma_busy(void);
+
+// Block on the DMA interrupt until the transfer is done (0), or timeout (-2)
+int awg_dma_wait(int timeout_ms);
+
+// [NEW] Same, but returns -3 early once wake_fd (e.g. an eventfd) is readable
+int awg_dma_wait_fd(int timeout_ms, int wake_fd);
+
+// PL clock cycles for a duration in microseconds (saturating)
+uint32_t awg_dma_us_to_cycles(uint32_t us);
+
+// Abort the in-flight transfer (channel reset)
+int awg_dma_abort(void);
+
+// Stop the DMA channel and release resources
+void awg_dma_close(void);
+
+// ---- PL frame sequencer (frame_sequencer_axis.v), awg_core_dma.c ----
+// DWELL word: the next committed frame stays on air for "cycles" PL clocks.
+// Consumed by the sequencer; a no-op for the decoder on other paths.
+#define AWG_CMD_DWELL     0xDu
+#define AWG_DWELL_MAX     0x0FFFFFFFu
+
+static inline uint32_t awg_make_dwell_word(uint32_t cycles) {
+    if (cycles > AWG_DWELL_MAX) cycles = AWG_DWELL_MAX;
+    return (AWG_CMD_DWELL << 28) | cycles;
+}
+
+typedef struct {
+    int      armed;
+    uint32_t frame_cnt;   // COMMITs fired by the sequencer since clear
+    uint32_t late_cnt;    // COMMITs that missed their slot (stream underrun)
+} awg_seq_status_t;
+
+// Map the sequencer control/status GPIO (after awg_dma_init)
+int awg_seq_init(void);
+int awg_seq_ready(void);
+
+// Arm (COMMITs fire on the dwell grid) or hold the sequencer
+int awg_seq_arm(int on);
+
+// Clear frame_cnt / late_cnt
+int awg_seq_clear(void);
+int awg_seq_get_status(awg_seq_status_t *st);
+
+// ---- [NEW] PL commit trigger gate (axis_commit_trigger_gate.v) ----
+// TRIG word: hold the next COMMIT until an edge on the shared trigger line
+// (or the timeout); LEAD = this board drives the line with that COMMIT.
+// Consumed by the gate in front of the decoder, on every command path.
+#define AWG_CMD_TRIG        0xBu
+#define AWG_TRIG_ARM        0x1u
+#define AWG_TRIG_LEAD       0x2u
+#define AWG_TRIG_TMO_SHIFT  10           // timeout unit: 1024 PL clocks
+#define AWG_TRIG_TMO_MAX    0x3FFFFu     // 18-bit field, about 2.1 s
+
+static inline uint32_t awg_make_trig_word(uint32_t flags, uint32_t timeout_us) {
+    uint32_t units = 0;
+    if (timeout_us) {
+        units = (awg_dma_us_to_cycles(timeout_us) >> AWG_TRIG_TMO_SHIFT) + 1u;
+        if (units > AWG_TRIG_TMO_MAX) units = AWG_TRIG_TMO_MAX;
+    }
+    return (AWG_CMD_TRIG << 28) | (units << 2) | (flags & 3u);
+}
+
 #endif // AWG_CORE_H
\ No newline at end of file
@@ -0,0 +1,56 @@
+// awg_core_backend.h — Internal interface between awg_core.c and the
+// backends (awg_core_mmap.c, awg_core_libgpiod.c, awg_core_dma.c,
+// awg_core_sim.c). Frontends only include awg_core.h.
+
+#ifndef AWG_CORE_BACKEND_H
+#define AWG_CORE_BACKEND_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// One way of getting command words onto waveform_generator_v5.
+// write() is the fastest path (no read-back); write_strict() may add
+// barriers/read-backs for bring-up and defaults to write() when NULL.
+typedef struct {
+    const char *name;
+    int  (*init)(void);
+    void (*close)(void);
+    int  (*write)(const uint32_t *words32, int count);
+    int  (*write_strict)(const uint32_t *words32, int count);
+} awg_backend_ops_t;
+
+extern const awg_backend_ops_t awg_backend_mmap;     // AXI GPIO via mmap (default)
+extern const awg_backend_ops_t awg_backend_dma;      // AXI DMA + PL pacer, one transfer per call
+extern const awg_backend_ops_t awg_backend_sim;      // no hardware, models the PL banks
+#ifdef AWG_WITH_GPIOD
+extern const awg_backend_ops_t awg_backend_gpiod;    // libgpiod v2 character device
+#endif
+
+// ---- Register regions, awg_core_dt.c ----
+// A region is looked up by name, in this order:
+//   1) AWG_ADDR_<NAME> environment variable (hex address, /dev/mem)
+//   2) a UIO device whose name is <name> (generic-uio, map0; no /dev/mem)
+//   3) device tree label <name> (or AWG_DT_<NAME>) in __symbols__ -> reg
+//   4) the compiled-in default address (/dev/mem)
+// <NAME> is the name upper-cased, e.g. awg_data_gpio -> AWG_ADDR_AWG_DATA_GPIO.
+typedef struct {
+    volatile uint32_t *regs;   // register base (CPU view)
+    uint64_t phys;             // bus address (0 if unknown, UIO)
+    size_t   size;
+    void    *map;              // page-aligned mapping
+    size_t   map_len;
+    int      fd;               // /dev/mem or /dev/uioN
+    const char *how;           // "env", "uio", "dt", "default"
+} awg_regmap_t;
+
+int  awg_regmap_open (awg_regmap_t *m, const char *name, uint64_t def_phys, size_t def_size);
+void awg_regmap_close(awg_regmap_t *m);
+
+// Address only (steps 1, 3, 4 above); how may be NULL. Returns 0.
+int  awg_dt_lookup(const char *name, uint64_t def_phys, size_t def_size,
+                   uint64_t *phys, size_t *size, const char **how);
+
+// "/dev/uioN" of the UIO device named <name>. Returns 0 found, -1 not found.
+int  awg_uio_find(const char *name, char *dev, size_t len);
+
+#endif // AWG_CORE_BACKEND_H
@@ -0,0 +1,389 @@
+// =============================================================
+// awg_core_dma.c  —  AXI DMA (MM2S) backend for the AWG command stream
+// -------------------------------------------------------------
+// Instead of strobing every 32-bit command through AXI GPIO, a whole
+// word array is placed in a CMA buffer and streamed by an AXI DMA into
+// waveform_generator_v5's S_AXIS port. The PL block
+// axis_cmd_frame_pacer.v (vivado_hls/) sits in between and holds each
+// COMMIT until the frame period has elapsed, so frame timing comes from
+// the PL clock and the CPU only sees one interrupt per transfer.
+//
+// Block design (simple / direct register mode, no SG):
+//   AXI DMA M_AXIS_MM2S -> axis_cmd_frame_pacer -> waveform_generator_v5
+//   AXI GPIO (32-bit)   -> axis_cmd_frame_pacer.period_cycles
+//   AXI DMA mm2s_introut -> IRQ_F2P -> UIO (generic-uio in device tree)
+//   The DMA stream is the only command input of waveform_generator_v5:
+//   there is no mux or priority against the GPIO feed (gpio_to_axis_fifo_sync)
+//   in the PL, so with AWG_BACKEND=dma|seq the queue server sends every
+//   write through here, RESET and the shutdown zero-out included.
+//
+// CMA buffer: u-dma-buf kernel module (https://github.com/ikwzm/udmabuf)
+//   e.g. insmod u-dma-buf.ko udmabuf0=0x4000000
+//   -> /dev/udmabuf0 + /sys/class/u-dma-buf/udmabuf0/{phys_addr,size}
+//
+// Transfer size:
+//   Each simple-mode transfer is limited by "Width of Buffer Length
+//   Register" in the AXI DMA IP. Set it to 26 bits (64 MB) and a full
+//   list fits in one transfer (= one interrupt per list). Longer arrays
+//   are split into AWG_DMA_MAX_XFER chunks, one interrupt each.
+//
+// Hardware sequencer (optional, awg_seq_init):
+//   AXI DMA M_AXIS_MM2S -> frame_sequencer_axis -> waveform_generator_v5
+//   PACER GPIO ch1 (out) -> default_dwell,  ch2 (in) <- late_cnt
+//   SEQ   GPIO ch1 (out) -> {clear, arm},   ch2 (in) <- frame_cnt
+//   DWELL words (CMD=0xD) in the stream set per-frame dwell in PL cycles;
+//   COMMITs only fire while armed.
+//
+// Register regions (awg_core_dt.c): "awg_dma", "awg_pacer_gpio",
+// "awg_seq_gpio"; the DMA interrupt is the UIO device named "awg_dma"
+// (else DMA_UIO_DEV). The macros below are only the fallback addresses.
+//
+// Also usable as the libawg_core word backend (AWG_CORE_BACKEND=dma): each
+// write is one transfer, waited for. The queue server then leaves the
+// DMA to the core (see awg_server_raw_top.c).
+//
+// Build: part of libawg_core (see Makefile.onboard)
+// =============================================================
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+
+#include "awg_core.h"
+#include "awg_core_backend.h"
+
+// ------------------ Default addresses & devices ------------------
+// Fallback when AWG_ADDR_*, UIO and the device tree give nothing
+#define AXI_DMA_BASE       0x40400000u   // AXI DMA (S_AXI_LITE)
+#define PACER_GPIO_BASE    0x41220000u   // AXI GPIO driving period_cycles
+#define SEQ_GPIO_BASE      0x41230000u   // AXI GPIO (dual): sequencer ctrl / frame_cnt
+#define DMA_UIO_DEV        "/dev/uio0"   // mm2s_introut, if no UIO is named "awg_dma"
+#define UDMABUF_DEV        "/dev/udmabuf0"
+#define UDMABUF_SYSFS      "/sys/class/u-dma-buf/udmabuf0"
+#define PL_CLK_HZ          125000000u    // clock of the pacer / waveform core
+
+// Max bytes per simple-mode transfer (2^width - 1, rounded down to words)
+#define AWG_DMA_MAX_XFER   ((1u << 26) - 4u)
+
+// AXI DMA MM2S registers (PG021, direct register mode)
+#define MM2S_DMACR         0x00u
+#define MM2S_DMASR         0x04u
+#define MM2S_SA            0x18u
+#define MM2S_SA_MSB        0x1Cu
+#define MM2S_LENGTH        0x28u
+
+#define DMACR_RS           (1u << 0)
+#define DMACR_RESET        (1u << 2)
+#define DMACR_IOC_IRQEN    (1u << 12)
+#define DMACR_ERR_IRQEN    (1u << 14)
+
+#define DMASR_HALTED       (1u << 0)
+#define DMASR_IDLE         (1u << 1)
+#define DMASR_ERR_MASK     (0x70u)       // DMAIntErr | DMASlvErr | DMADecErr
+#define DMASR_IOC_IRQ      (1u << 12)
+#define DMASR_ERR_IRQ      (1u << 14)
+
+#define GPIO_DATA_OFFSET   0x00u
+#define GPIO_DATA2_OFFSET  0x08u
+
+#define SEQ_CTRL_ARM       (1u << 0)
+#define SEQ_CTRL_CLEAR     (1u << 1)
+
+#define REG_MAP_SIZE       0x1000u
+#define CORE_WAIT_MS       1000          // backend write: pacer may hold a COMMIT one period
+
+// ------------------ Globals ------------------
+static awg_regmap_t       g_dma_map   = { .fd = -1 };
+static awg_regmap_t       g_pace_map  = { .fd = -1 };
+static awg_regmap_t       g_seq_map   = { .fd = -1 };
+static int                g_fd_uio    = -1;
+static int                g_fd_buf    = -1;
+static volatile uint32_t *g_dma_regs  = NULL;
+static volatile uint32_t *g_pace_regs = NULL;
+static volatile uint32_t *g_seq_regs  = NULL;   // only mapped by awg_seq_init()
+static uint32_t           g_seq_ctrl  = 0;      // shadow of SEQ ctrl
+
+static uint32_t          *g_buf       = NULL;   // CMA buffer (CPU view)
+static uint64_t           g_buf_phys  = 0;      // CMA buffer (bus address)
+static size_t             g_buf_size  = 0;      // bytes
+
+// In-flight transfer (split into chunks of AWG_DMA_MAX_XFER)
+static uint64_t           g_xfer_phys = 0;
+static size_t             g_xfer_left = 0;      // bytes not yet submitted
+static int                g_xfer_busy = 0;
+
+// ------------------ Register helpers ------------------
+static inline void reg_write(volatile uint32_t *base, uint32_t off, uint32_t v) {
+    *(volatile uint32_t *)((uintptr_t)base + off) = v;
+    __sync_synchronize();
+}
+
+static inline uint32_t reg_read(volatile uint32_t *base, uint32_t off) {
+    uint32_t v = *(volatile uint32_t *)((uintptr_t)base + off);
+    __sync_synchronize();
+    return v;
+}
+
+static int read_sysfs_u64(const char *path, uint64_t *out) {
+    FILE *f = fopen(path, "r");
+    if (!f) { perror(path); return -1; }
+    long long v = 0;
+    int ok = fscanf(f, "%lli", &v);
+    fclose(f);
+    if (ok != 1) return -1;
+    *out = (uint64_t)v;
+    return 0;
+}
+
+// Re-arm the UIO interrupt (generic-uio masks it after each event)
+static inline void uio_unmask(void) {
+    uint32_t one = 1;
+    if (write(g_fd_uio, &one, sizeof(one)) != sizeof(one)) perror("uio unmask");
+}
+
+// Kick one chunk of the current transfer
+static void submit_chunk(void) {
+    size_t n = (g_xfer_left > AWG_DMA_MAX_XFER) ? AWG_DMA_MAX_XFER : g_xfer_left;
+    reg_write(g_dma_regs, MM2S_SA,     (uint32_t)g_xfer_phys);
+    reg_write(g_dma_regs, MM2S_SA_MSB, (uint32_t)(g_xfer_phys >> 32));
+    reg_write(g_dma_regs, MM2S_LENGTH, (uint32_t)n);   // starts the transfer
+    g_xfer_phys += n;
+    g_xfer_left -= n;
+}
+
+// Reset the MM2S channel and bring it back up with interrupts enabled
+static void channel_restart(void) {
+    reg_write(g_dma_regs, MM2S_DMACR, DMACR_RESET);
+    for (int i = 0; i < 1000 && (reg_read(g_dma_regs, MM2S_DMACR) & DMACR_RESET); ++i) usleep(10);
+    reg_write(g_dma_regs, MM2S_DMASR, DMASR_IOC_IRQ | DMASR_ERR_IRQ);
+    reg_write(g_dma_regs, MM2S_DMACR, DMACR_RS | DMACR_IOC_IRQEN | DMACR_ERR_IRQEN);
+}
+
+// ------------------ Public API ------------------
+int awg_dma_init(void)
+{
+    if (awg_dma_ready()) return 0;
+
+    if (awg_regmap_open(&g_dma_map, "awg_dma", AXI_DMA_BASE, REG_MAP_SIZE) != 0) { awg_dma_close(); return -2; }
+    g_dma_regs = g_dma_map.regs;
+
+    if (awg_regmap_open(&g_pace_map, "awg_pacer_gpio", PACER_GPIO_BASE, REG_MAP_SIZE) != 0) { awg_dma_close(); return -3; }
+    g_pace_regs = g_pace_map.regs;
+
+    char uio[64];
+    if (awg_uio_find("awg_dma", uio, sizeof(uio)) != 0) snprintf(uio, sizeof(uio), "%s", DMA_UIO_DEV);
+    g_fd_uio = open(uio, O_RDWR);
+    if (g_fd_uio < 0) { perror(uio); awg_dma_close(); return -4; }
+
+    uint64_t sz = 0;
+    if (read_sysfs_u64(UDMABUF_SYSFS "/phys_addr", &g_buf_phys) != 0 ||
+        read_sysfs_u64(UDMABUF_SYSFS "/size", &sz) != 0) {
+        awg_dma_close(); return -5;
+    }
+    g_buf_size = (size_t)sz;
+
+    // O_SYNC: uncached mapping, so no cache maintenance is needed before a kick
+    g_fd_buf = open(UDMABUF_DEV, O_RDWR | O_SYNC);
+    if (g_fd_buf < 0) { perror("open " UDMABUF_DEV); awg_dma_close(); return -6; }
+    g_buf = (uint32_t *)mmap(NULL, g_buf_size, PROT_READ|PROT_WRITE, MAP_SHARED, g_fd_buf, 0);
+    if (g_buf == MAP_FAILED) { perror("mmap udmabuf"); g_buf = NULL; awg_dma_close(); return -7; }
+
+    // Reset the MM2S channel, then run with IOC/error interrupts enabled
+    channel_restart();
+    uio_unmask();
+
+    awg_dma_set_period_us(1000);
+    g_xfer_busy = 0;
+    return 0;
+}
+
+void awg_dma_close(void)
+{
+    if (g_dma_regs) reg_write(g_dma_regs, MM2S_DMACR, DMACR_RESET);
+    if (g_seq_regs) reg_write(g_seq_regs, GPIO_DATA_OFFSET, 0);   // disarm
+    g_dma_regs = g_pace_regs = g_seq_regs = NULL;
+    awg_regmap_close(&g_dma_map);
+    awg_regmap_close(&g_pace_map);
+    awg_regmap_close(&g_seq_map);
+    if (g_buf)       { munmap(g_buf, g_buf_size); g_buf = NULL; }
+    if (g_fd_buf >= 0) { close(g_fd_buf); g_fd_buf = -1; }
+    if (g_fd_uio >= 0) { close(g_fd_uio); g_fd_uio = -1; }
+    g_buf_size = 0; g_xfer_busy = 0;
+}
+
+int awg_dma_ready(void)
+{
+    return g_dma_regs != NULL && g_buf != NULL;
+}
+
+uint32_t *awg_dma_buffer(size_t *cap_words)
+{
+    if (cap_words) *cap_words = g_buf ? g_buf_size / sizeof(uint32_t) : 0;
+    return g_buf;
+}
+
+uint32_t awg_dma_us_to_cycles(uint32_t us)
+{
+    uint64_t cyc = (uint64_t)us * (PL_CLK_HZ / 1000000u);
+    return (cyc > 0xFFFFFFFFull) ? 0xFFFFFFFFu : (uint32_t)cyc;
+}
+
+int awg_dma_set_period_us(uint32_t period_us)
+{
+    if (!g_pace_regs) return -1;
+    reg_write(g_pace_regs, GPIO_DATA_OFFSET, awg_dma_us_to_cycles(period_us));
+    return 0;
+}
+
+int awg_dma_send(const uint32_t *words32, size_t count)
+{
+    if (!awg_dma_ready()) return -1;
+    if (!words32 || count == 0) return -2;
+    if (g_xfer_busy) return -3;
+
+    // Zero-copy when the words already live in the CMA buffer
+    const uint32_t *end = g_buf + g_buf_size / sizeof(uint32_t);
+    if (words32 < g_buf || words32 + count > end) {
+        if (count * sizeof(uint32_t) > g_buf_size) return -4;
+        memcpy(g_buf, words32, count * sizeof(uint32_t));
+        words32 = g_buf;
+    }
+
+    g_xfer_phys = g_buf_phys + (uint64_t)((uintptr_t)words32 - (uintptr_t)g_buf);
+    g_xfer_left = count * sizeof(uint32_t);
+    g_xfer_busy = 1;
+    submit_chunk();
+    return 0;
+}
+
+int awg_dma_busy(void)
+{
+    return g_xfer_busy;
+}
+
+// Wait for the whole transfer (all chunks). Returns 0 done, -2 timeout,
+// -1 not initialized, -5 DMA error (channel is reset).
+int awg_dma_wait(int timeout_ms)
+{
+    return awg_dma_wait_fd(timeout_ms, -1);
+}
+
+// Same, but also returns -3 as soon as wake_fd is readable (not consumed),
+// so a caller can sleep on the DMA interrupt and its own eventfd at once.
+int awg_dma_wait_fd(int timeout_ms, int wake_fd)
+{
+    if (!awg_dma_ready()) return -1;
+
+    while (g_xfer_busy) {
+        struct pollfd pfd[2] = { { .fd = g_fd_uio, .events = POLLIN },
+                                 { .fd = wake_fd,  .events = POLLIN } };  // fd < 0 is ignored
+        int pr = poll(pfd, 2, timeout_ms);
+        if (pr == 0) return -2;
+        if (pr < 0) { if (errno == EINTR) continue; return -1; }
+        if (!(pfd[0].revents & POLLIN)) return (pfd[1].revents & POLLIN) ? -3 : -1;
+
+        uint32_t irq_count;
+        if (read(g_fd_uio, &irq_count, sizeof(irq_count)) != sizeof(irq_count)) continue;
+
+        uint32_t sr = reg_read(g_dma_regs, MM2S_DMASR);
+        reg_write(g_dma_regs, MM2S_DMASR, sr & (DMASR_IOC_IRQ | DMASR_ERR_IRQ)); // W1C
+        uio_unmask();
+
+        if (sr & (DMASR_ERR_IRQ | DMASR_ERR_MASK)) {
+            fprintf(stderr, "[DMA] MM2S error, DMASR=0x%08x\n", sr);
+            channel_restart();
+            g_xfer_busy = 0; g_xfer_left = 0;
+            return -5;
+        }
+        if (sr & DMASR_IOC_IRQ) {
+            if (g_xfer_left) submit_chunk();
+            else g_xfer_busy = 0;
+        }
+    }
+    return 0;
+}
+
+// Drop the in-flight transfer (words already in the PL stay there)
+int awg_dma_abort(void)
+{
+    if (!awg_dma_ready()) return -1;
+    channel_restart();
+    g_xfer_busy = 0; g_xfer_left = 0;
+    return 0;
+}
+
+// ------------------ PL frame sequencer ------------------
+// Only call when frame_sequencer_axis is in the bitstream: reading an
+// unmapped AXI address stalls the bus.
+int awg_seq_init(void)
+{
+    if (!g_dma_regs) return -1;
+    if (awg_regmap_open(&g_seq_map, "awg_seq_gpio", SEQ_GPIO_BASE, REG_MAP_SIZE) != 0) return -2;
+    g_seq_regs = g_seq_map.regs;
+    g_seq_ctrl = 0;
+    reg_write(g_seq_regs, GPIO_DATA_OFFSET, SEQ_CTRL_CLEAR);
+    reg_write(g_seq_regs, GPIO_DATA_OFFSET, g_seq_ctrl);
+    return 0;
+}
+
+int awg_seq_ready(void)
+{
+    return g_seq_regs != NULL;
+}
+
+int awg_seq_arm(int on)
+{
+    if (!g_seq_regs) return -1;
+    g_seq_ctrl = on ? (g_seq_ctrl | SEQ_CTRL_ARM) : (g_seq_ctrl & ~SEQ_CTRL_ARM);
+    reg_write(g_seq_regs, GPIO_DATA_OFFSET, g_seq_ctrl);
+    return 0;
+}
+
+int awg_seq_clear(void)
+{
+    if (!g_seq_regs) return -1;
+    reg_write(g_seq_regs, GPIO_DATA_OFFSET, g_seq_ctrl | SEQ_CTRL_CLEAR);
+    reg_write(g_seq_regs, GPIO_DATA_OFFSET, g_seq_ctrl);
+    return 0;
+}
+
+int awg_seq_get_status(awg_seq_status_t *st)
+{
+    if (!g_seq_regs || !st) return -1;
+    st->armed     = (g_seq_ctrl & SEQ_CTRL_ARM) ? 1 : 0;
+    st->frame_cnt = reg_read(g_seq_regs,  GPIO_DATA2_OFFSET);
+    st->late_cnt  = reg_read(g_pace_regs, GPIO_DATA2_OFFSET);
+    return 0;
+}
+
+// ------------------ libawg_core backend ops ------------------
+static int dma_backend_init(void)
+{
+    int rc = awg_dma_init();
+    if (rc == 0) printf("[CORE] dma: DMA 0x%08llx (%s), PACER 0x%08llx (%s)\n",
+                        (unsigned long long)g_dma_map.phys, g_dma_map.how,
+                        (unsigned long long)g_pace_map.phys, g_pace_map.how);
+    return rc;
+}
+
+// One transfer per call; COMMITs are released by the PL pacer
+static int dma_backend_write(const uint32_t *words32, int count)
+{
+    int rc = awg_dma_send(words32, (size_t)count);
+    if (rc != 0) return rc;
+    return awg_dma_wait(CORE_WAIT_MS);
+}
+
+const awg_backend_ops_t awg_backend_dma = {
+    .name         = "dma",
+    .init         = dma_backend_init,
+    .close        = awg_dma_close,
+    .write        = dma_backend_write,
+    .write_strict = NULL,
+};
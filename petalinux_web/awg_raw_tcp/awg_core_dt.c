@@ -0,0 +1,190 @@
+/*
+ * awg_core_dt.c — Register addresses from the environment, UIO or the
+ * device tree instead of hardcoded base macros (see awg_core_backend.h).
+ *
+ * Device tree: label the PL nodes (or pass AWG_DT_<NAME>=<label>) and build
+ * the DTB with symbols (-@, PetaLinux default for overlays), e.g.
+ *   awg_data_gpio: gpio@41200000 { ... };
+ * UIO: bind the node to generic-uio and name it, e.g. compatible =
+ * "generic-uio" with the node named awg_dma -> /sys/class/uio/uioN/name.
+ */
+#include <ctype.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "awg_core_backend.h"
+
+#define DT_ROOT   "/proc/device-tree"
+#define UIO_ROOT  "/sys/class/uio"
+
+static void env_key(char *dst, size_t len, const char *prefix, const char *name) {
+    size_t k = (size_t)snprintf(dst, len, "%s", prefix);
+    for (const char *p = name; *p && k + 1 < len; ++p) dst[k++] = (char)toupper((unsigned char)*p);
+    dst[k] = '\0';
+}
+
+static int read_text(const char *path, char *buf, size_t len) {
+    FILE *f = fopen(path, "r");
+    if (!f) return -1;
+    size_t n = fread(buf, 1, len - 1, f);
+    fclose(f);
+    buf[n] = '\0';
+    while (n && (buf[n - 1] == '\n' || buf[n - 1] == '\0')) buf[--n] = '\0';
+    return 0;
+}
+
+static int read_u64(const char *path, uint64_t *out) {
+    char buf[64];
+    if (read_text(path, buf, sizeof(buf)) != 0) return -1;
+    char *end; errno = 0;
+    unsigned long long v = strtoull(buf, &end, 0);
+    if (errno || end == buf) return -1;
+    *out = (uint64_t)v;
+    return 0;
+}
+
+static uint32_t be32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+// reg of the node behind a __symbols__ label; 1 or 2 address/size cells
+static int dt_reg(const char *label, uint64_t *phys, size_t *size) {
+    char path[256], node[192];
+    snprintf(path, sizeof(path), DT_ROOT "/__symbols__/%s", label);
+    if (read_text(path, node, sizeof(node)) != 0 || node[0] != '/') return -1;
+
+    snprintf(path, sizeof(path), DT_ROOT "%s/reg", node);
+    uint8_t reg[16];
+    FILE *f = fopen(path, "rb");
+    if (!f) return -1;
+    size_t n = fread(reg, 1, sizeof(reg), f);
+    fclose(f);
+    if (n == 8) {
+        *phys = be32(reg);
+        *size = be32(reg + 4);
+    } else if (n == 16) {
+        *phys = ((uint64_t)be32(reg) << 32) | be32(reg + 4);
+        *size = (size_t)(((uint64_t)be32(reg + 8) << 32) | be32(reg + 12));
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+int awg_dt_lookup(const char *name, uint64_t def_phys, size_t def_size,
+                  uint64_t *phys, size_t *size, const char **how)
+{
+    char key[64];
+    *phys = def_phys; *size = def_size;
+
+    env_key(key, sizeof(key), "AWG_ADDR_", name);
+    const char *v = getenv(key);
+    if (v && *v) {
+        *phys = (uint64_t)strtoull(v, NULL, 0);
+        if (how) *how = "env";
+        return 0;
+    }
+
+    env_key(key, sizeof(key), "AWG_DT_", name);
+    const char *label = getenv(key);
+    if (dt_reg(label && *label ? label : name, phys, size) == 0) {
+        if (*size == 0) *size = def_size;
+        if (how) *how = "dt";
+        return 0;
+    }
+    *phys = def_phys; *size = def_size;
+    if (how) *how = "default";
+    return 0;
+}
+
+int awg_uio_find(const char *name, char *dev, size_t len)
+{
+    DIR *d = opendir(UIO_ROOT);
+    if (!d) return -1;
+    struct dirent *e;
+    int found = -1;
+    while ((e = readdir(d)) != NULL) {
+        if (strncmp(e->d_name, "uio", 3) != 0) continue;
+        char path[300], nm[64];
+        snprintf(path, sizeof(path), UIO_ROOT "/%s/name", e->d_name);
+        if (read_text(path, nm, sizeof(nm)) == 0 && strcmp(nm, name) == 0) {
+            snprintf(dev, len, "/dev/%s", e->d_name);
+            found = 0;
+            break;
+        }
+    }
+    closedir(d);
+    return found;
+}
+
+// map0 of a UIO device: mmap offset 0 selects map 0
+static int map_uio(awg_regmap_t *m, const char *name) {
+    char dev[64], path[128];
+    if (awg_uio_find(name, dev, sizeof(dev)) != 0) return -1;
+
+    uint64_t size = 0, off = 0;
+    snprintf(path, sizeof(path), UIO_ROOT "/%s/maps/map0/size", dev + 5);
+    if (read_u64(path, &size) != 0 || size == 0) return -1;
+    snprintf(path, sizeof(path), UIO_ROOT "/%s/maps/map0/offset", dev + 5);
+    if (read_u64(path, &off) != 0) off = 0;        // older kernels: page aligned
+    snprintf(path, sizeof(path), UIO_ROOT "/%s/maps/map0/addr", dev + 5);
+    if (read_u64(path, &m->phys) != 0) m->phys = 0;
+
+    m->fd = open(dev, O_RDWR | O_SYNC);
+    if (m->fd < 0) { perror(dev); return -1; }
+    long pg = sysconf(_SC_PAGESIZE);
+    m->map_len = ((size_t)(off + size) + (size_t)pg - 1) & ~((size_t)pg - 1);
+    m->map = mmap(NULL, m->map_len, PROT_READ | PROT_WRITE, MAP_SHARED, m->fd, 0);
+    if (m->map == MAP_FAILED) { perror("mmap uio"); m->map = NULL; close(m->fd); m->fd = -1; return -1; }
+    m->regs = (volatile uint32_t *)((uint8_t *)m->map + off);
+    m->size = (size_t)size;
+    m->how  = "uio";
+    return 0;
+}
+
+int awg_regmap_open(awg_regmap_t *m, const char *name, uint64_t def_phys, size_t def_size)
+{
+    memset(m, 0, sizeof(*m));
+    m->fd = -1;
+
+    // An explicit address wins; otherwise prefer UIO (no /dev/mem needed)
+    char key[64];
+    env_key(key, sizeof(key), "AWG_ADDR_", name);
+    const char *env = getenv(key);
+    if (!(env && *env) && map_uio(m, name) == 0) return 0;
+
+    uint64_t phys; size_t size;
+    awg_dt_lookup(name, def_phys, def_size, &phys, &size, &m->how);
+
+    m->fd = open("/dev/mem", O_RDWR | O_SYNC);
+    if (m->fd < 0) { perror("open /dev/mem"); return -1; }
+    long pg = sysconf(_SC_PAGESIZE);
+    uint64_t base = phys & ~(uint64_t)(pg - 1);
+    size_t   off  = (size_t)(phys - base);
+    m->map_len = (off + size + (size_t)pg - 1) & ~((size_t)pg - 1);
+    m->map = mmap(NULL, m->map_len, PROT_READ | PROT_WRITE, MAP_SHARED, m->fd, (off_t)base);
+    if (m->map == MAP_FAILED) {
+        fprintf(stderr, "[CORE] mmap %s @0x%llx: %s\n", name, (unsigned long long)phys, strerror(errno));
+        m->map = NULL; close(m->fd); m->fd = -1;
+        return -2;
+    }
+    m->regs = (volatile uint32_t *)((uint8_t *)m->map + off);
+    m->phys = phys;
+    m->size = size;
+    return 0;
+}
+
+void awg_regmap_close(awg_regmap_t *m)
+{
+    if (m->map) munmap(m->map, m->map_len);
+    if (m->fd >= 0) close(m->fd);
+    memset(m, 0, sizeof(*m));
+    m->fd = -1;
+}
@@ -1,48 +1,20 @@
 // =============================================================
-// awg_core.c  —  High-speed AWG GPIO core (C, libgpiod v2)
+// awg_core_libgpiod.c  —  libgpiod v2 backend of libawg_core
 // -------------------------------------------------------------
-// Build:
-//   gcc -O3 -fPIC -shared -o libawg_core.so awg_core.c -lgpiod
+// AWG_CORE_BACKEND=gpiod (or auto when mmap is unavailable). Needs
+// libgpiod v2: build libawg_core / awg_server with WITH_GPIOD=1.
+// Slower than the mmap backend (one ioctl per edge) but needs no /dev/mem.
 //
-// Minimal Python usage (ctypes):
-//   import ctypes
-//   lib = ctypes.CDLL("./libawg_core.so")
-//   assert lib.awg_init() == 0
-//   lib.awg_send_hex4(b"...24hex...", b"...144hex...", b"...24hex...", b"...144hex...")
-//   lib.awg_close()
-//
-// -------------------------------------------------------------
-// Input Format (FOUR HEX STRINGS, fixed length):
-//   1) idxA_hex  : 24 hex chars  (3 hex per tone * 8 tones)
-//   2) gainA_hex : 144 hex chars (18 hex per tone * 8 tones)
-//   3) idxB_hex  : 24 hex chars
-//   4) gainB_hex : 144 hex chars
-//
-//   - Index (idx): each tone uses 3 hex chars, 0x000 .. 0x383 (0..899)
-//   - Gain (Q1.17): each tone uses 18 hex chars (72 bits) BUT ONLY THE
-//     LOWEST 20 BITS ARE USED by hardware (mask to 0x1FFFF).
-//     This matches the original Q1.17 format (0..0x1FFFF).
-//
-//   Total per channel: 24 + 144 = 168 hex
-//   Both channels (A+B): 336 hex total, but passed as 4 groups to improve readability.
-//   Order within each group is tone 0..7 (exactly 8 tones).
-//
-// -------------------------------------------------------------
 // HW Notes:
-//   - DATA bus: /dev/gpiochip0, 32-bit output (offsets 0..31)
-//   - WEN line: /dev/gpiochip3, 1-bit output (offset DEF_WEN_OFF)
+//   - DATA bus: 32-bit output (offsets 0..31) on the gpiochip of the AXI GPIO
+//     "awg_data_gpio"; WEN: 1-bit output (offset DEF_WEN_OFF) on "awg_wen_gpio"
+//   - The chip is found by its label "<addr>.gpio", with the address from
+//     the device tree (awg_core_dt.c); AWG_GPIOD_DATA_CHIP / AWG_GPIOD_WEN_CHIP
+//     override, DEF_DATA_CHIP / DEF_WEN_CHIP are the fallback.
 //   - WEN pulse: fastest possible edge (no delay).
-//   - Commit word sent once at the end.
-//
-// -------------------------------------------------------------
-// Words on the bus (32-bit):
-//   [31:28] cmd: 0x1 = INDEX, 0x2 = GAIN, 0xF = COMMIT
-//   [27]    ch : 0=A, 1=B
-//   [26:24] tone: 0..7
-//   [23:20] reserved (0)
-//   [19:0]  payload: idx20 or gain20 (Q1.17 low 20 bits)
 // =============================================================
 
+#include <dirent.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
@@ -50,9 +22,13 @@
 #include <time.h>
 #include <gpiod.h>
 
+#include "awg_core_backend.h"
+
 // ------------------ Tunables ------------------
 #define DEF_DATA_CHIP   "/dev/gpiochip0"
 #define DEF_WEN_CHIP    "/dev/gpiochip3"
+#define DATA_GPIO_BASE  0x41200000u     // only used to find the chip label
+#define WEN_GPIO_BASE   0x41210000u
 #define DEF_WEN_OFF     0
 
 #define DEF_WEN_ACTHI   1   // active-high WEN
@@ -84,39 +60,6 @@ static inline void map_word_to_values(uint32_t w, enum gpiod_line_value *vals32)
                                     : GPIOD_LINE_VALUE_INACTIVE;
 }
 
-// ---------- Word packing ----------
-static inline uint32_t pack_sel(int ch, int tone) {
-    return ((uint32_t)(ch & 1) << 27) | ((uint32_t)(tone & 7) << 24);
-}
-static inline uint32_t make_index_word(int ch, int tone, uint32_t idx20) {
-    return (0x1u << 28) | pack_sel(ch, tone) | (idx20 & 0xFFFFFu);
-}
-static inline uint32_t make_gain_word(int ch, int tone, uint32_t g20) {
-    return (0x2u << 28) | pack_sel(ch, tone) | (g20 & 0xFFFFFu);
-}
-static inline uint32_t make_commit_word(void) {
-    return (0xFu << 28);
-}
-
-// ---------- Ultra-fast hex helpers (NO validation) ----------
-static inline uint32_t parse_hex_n(const char *p, int n) {
-    uint32_t v = 0;
-    for (int i = 0; i < n; i++) {
-        unsigned char c = (unsigned char)p[i];
-        unsigned int h = (c <= '9') ? (c - '0') : ((c | 32) - 'a' + 10);
-        v = (v << 4) | h;
-    }
-    return v;
-}
-
-// idx: 3-hex; gain: 18-hex (take lowest 5 hex = 20 bits)
-static inline uint32_t parse_idx3_fast(const char *p3) {
-    return parse_hex_n(p3, 3);              // 12-bit -> 後面再 & 0xFFFFF
-}
-static inline uint32_t parse_gain18_low5_fast(const char *p18) {
-    return parse_hex_n(p18 + 13, 5);        // 只取最後 5 個 hex = 20-bit
-}
-
 // ------------------ Low-level I/O ------------------
 static inline void write_word32(uint32_t w) {
     map_word_to_values(w, g_vals32);
@@ -133,14 +76,58 @@ static inline void wen_edge(int active_high, int pulse_us) {
     gpiod_line_request_set_value(g_wen_req, DEF_WEN_OFF, off); 
 }
 
-// ------------------ Public API ------------------
-int awg_init(void)
+// gpiochip whose label is "<addr>.gpio" (AXI GPIO driver), else fallback
+static void find_chip(const char *env, const char *region, uint64_t def_phys,
+                      const char *fallback, char *path, size_t len)
+{
+    const char *v = getenv(env);
+    if (v && *v) { snprintf(path, len, "%s", v); return; }
+    snprintf(path, len, "%s", fallback);
+
+    uint64_t phys; size_t size;
+    awg_dt_lookup(region, def_phys, 0x1000, &phys, &size, NULL);
+    char want[32];
+    snprintf(want, sizeof(want), "%llx.gpio", (unsigned long long)phys);
+
+    DIR *d = opendir("/dev");
+    if (!d) return;
+    struct dirent *e;
+    while ((e = readdir(d)) != NULL) {
+        if (strncmp(e->d_name, "gpiochip", 8) != 0) continue;
+        char p[300];
+        snprintf(p, sizeof(p), "/dev/%s", e->d_name);
+        struct gpiod_chip *c = gpiod_chip_open(p);
+        if (!c) continue;
+        struct gpiod_chip_info *info = gpiod_chip_get_info(c);
+        int match = info && strcmp(gpiod_chip_info_get_label(info), want) == 0;
+        if (info) gpiod_chip_info_free(info);
+        gpiod_chip_close(c);
+        if (match) { snprintf(path, len, "%s", p); break; }
+    }
+    closedir(d);
+}
+
+// ------------------ Backend ops ------------------
+static void gpiod_close(void)
+{
+    if (g_wen_req)   { gpiod_line_request_release(g_wen_req); g_wen_req = NULL; }
+    if (g_data_req)  { gpiod_line_request_release(g_data_req); g_data_req = NULL; }
+    if (g_wen_chip)  { gpiod_chip_close(g_wen_chip);  g_wen_chip  = NULL; }
+    if (g_data_chip) { gpiod_chip_close(g_data_chip); g_data_chip = NULL; }
+}
+
+static int gpiod_init(void)
 {
     // open chips
-    g_data_chip = gpiod_chip_open(DEF_DATA_CHIP);
+    char data_path[300], wen_path[300];
+    find_chip("AWG_GPIOD_DATA_CHIP", "awg_data_gpio", DATA_GPIO_BASE, DEF_DATA_CHIP, data_path, sizeof(data_path));
+    find_chip("AWG_GPIOD_WEN_CHIP",  "awg_wen_gpio",  WEN_GPIO_BASE,  DEF_WEN_CHIP,  wen_path,  sizeof(wen_path));
+    printf("[CORE] gpiod: DATA %s, WEN %s\n", data_path, wen_path);
+
+    g_data_chip = gpiod_chip_open(data_path);
     if (!g_data_chip) { perror("gpiod_chip_open(data)"); return -1; }
 
-    g_wen_chip = gpiod_chip_open(DEF_WEN_CHIP);
+    g_wen_chip = gpiod_chip_open(wen_path);
     if (!g_wen_chip) { perror("gpiod_chip_open(wen)"); return -2; }
 
     // common out settings
@@ -194,49 +181,20 @@ int awg_init(void)
     return 0;
 }
 
-void awg_close(void)
-{
-    if (g_wen_req)   { gpiod_line_request_release(g_wen_req); g_wen_req = NULL; }
-    if (g_data_req)  { gpiod_line_request_release(g_data_req); g_data_req = NULL; }
-    if (g_wen_chip)  { gpiod_chip_close(g_wen_chip);  g_wen_chip  = NULL; }
-    if (g_data_chip) { gpiod_chip_close(g_data_chip); g_data_chip = NULL; }
-}
-
-// ---- Fast path: accept four HEX blocks, parse & stream immediately ----
-int awg_send_hex4(const char *idxA_hex, const char *gainA_hex,
-                  const char *idxB_hex, const char *gainB_hex)
+static int gpiod_write(const uint32_t *words32, int count)
 {
     if (!g_data_req || !g_wen_req) return -1;
-    if (!idxA_hex || !gainA_hex || !idxB_hex || !gainB_hex) return -2;
-
-    // 直接解析 + 送出
-    // Channel A: 8*index, 8*gain
-    for (int t = 0; t < 8; ++t) {
-        uint32_t v20 = parse_idx3_fast(idxA_hex + 3 * t) & 0xFFFFF;
-        write_word32(make_index_word(0, t, v20));
-        wen_edge(DEF_WEN_ACTHI, DEF_WEN_US);
-    }
-    for (int t = 0; t < 8; ++t) {
-        uint32_t v20 = parse_gain18_low5_fast(gainA_hex + 18 * t) & 0xFFFFF;
-        write_word32(make_gain_word(0, t, v20));
+    for (int i = 0; i < count; ++i) {
+        write_word32(words32[i]);
         wen_edge(DEF_WEN_ACTHI, DEF_WEN_US);
     }
-
-    // Channel B: 8*index, 8*gain
-    for (int t = 0; t < 8; ++t) {
-        uint32_t v20 = parse_idx3_fast(idxB_hex + 3 * t) & 0xFFFFF;
-        write_word32(make_index_word(1, t, v20));
-        wen_edge(DEF_WEN_ACTHI, DEF_WEN_US);
-    }
-    for (int t = 0; t < 8; ++t) {
-        uint32_t v20 = parse_gain18_low5_fast(gainB_hex + 18 * t) & 0xFFFFF;
-        write_word32(make_gain_word(1, t, v20));
-        wen_edge(DEF_WEN_ACTHI, DEF_WEN_US);
-    }
-
-    // Commit once
-    write_word32(make_commit_word());
-    wen_edge(DEF_WEN_ACTHI, DEF_WEN_US);
-
     return 0;
-}
\ No newline at end of file
+}
+
+const awg_backend_ops_t awg_backend_gpiod = {
+    .name         = "gpiod",
+    .init         = gpiod_init,
+    .close        = gpiod_close,
+    .write        = gpiod_write,
+    .write_strict = NULL,
+};
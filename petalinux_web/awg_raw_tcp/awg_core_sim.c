@@ -0,0 +1,165 @@
+// =============================================================
+// awg_core_sim.c  —  Simulator backend of libawg_core (no hardware)
+// -------------------------------------------------------------
+// AWG_CORE_BACKEND=sim. Models the command path of waveform_top.v in
+// software, word by word:
+//   gpio_cfg_decoder_axis32  : INDEX keeps data[IDX_W-1:0], GAIN keeps
+//                              data[GAIN_W-1:0], SAFE latches data[0],
+//                              DWELL and unknown commands are no-ops;
+//                              tone = {[23], [26:24]}, tones >= AWG_TONES dropped
+//   axis_commit_trigger_gate : no trigger line here, TRIG is a no-op and a
+//                              COMMIT it would hold is released at once
+//   commit_safe_reg          : 1 after reset, COMMIT is ignored while 0
+//   cfg_pingpong_idx_gain_2x8: INDEX/GAIN land in the shadow bank, COMMIT
+//                              swaps the banks, so the new shadow bank still
+//                              holds the frame from two commits ago
+// Every write() that swaps the banks is timestamped; the commit-to-commit
+// intervals are what the DAC would see as frame timing (gaps over
+// SIM_IDLE_GAP_NS count as an idle player, not as timing).
+// AWG_SIM_LOG=<path>     additionally appends every word ("%08x\n").
+// AWG_SIM_WORD_NS=<ns>   spin this long per word, to model the bus cost of
+//                        the real AXI GPIO path in host benchmarks.
+// =============================================================
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "awg_core.h"
+#include "awg_core_backend.h"
+
+#define SIM_IDX_W        10                   // waveform_top.v IDX_W
+#define SIM_GAIN_W       18                   // waveform_top.v GAIN_W
+#define SIM_IDLE_GAP_NS  1000000000ull
+
+static pthread_mutex_t g_sim_mu = PTHREAD_MUTEX_INITIALIZER;
+static int             g_sim_on = 0;
+static FILE           *g_sim_log = NULL;
+static uint64_t        g_word_ns = 0;        // modelled bus cost per word
+static uint32_t        g_bank[2][2][2][AWG_MAX_TONES];   // [bank][0=index,1=gain][ch][tone]
+static unsigned        g_tones = 8;          // AWG_TONES of the modelled build
+static int             g_active = 0;         // bank on air
+static int             g_safe   = 1;         // commit_safe_reg, 1 after reset
+static awg_sim_state_t g_cnt;                // counters (bank copy filled on read)
+
+static inline uint64_t sim_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void sim_clear_stats(void) {
+    memset(&g_cnt, 0, sizeof(g_cnt));
+    g_cnt.gap_min_ns = UINT64_MAX;
+}
+
+static int sim_init(void)
+{
+    pthread_mutex_lock(&g_sim_mu);
+    memset(g_bank, 0, sizeof(g_bank));
+    sim_clear_stats();
+    g_active = 0;
+    g_safe   = 1;
+    g_tones  = (unsigned)awg_tones();
+    const char *path = getenv("AWG_SIM_LOG");
+    if (path && *path) {
+        g_sim_log = fopen(path, "a");
+        if (!g_sim_log) perror(path);
+    }
+    const char *ns = getenv("AWG_SIM_WORD_NS");
+    g_word_ns = ns ? strtoull(ns, NULL, 10) : 0;
+    g_sim_on = 1;
+    pthread_mutex_unlock(&g_sim_mu);
+    printf("[CORE] sim backend (no hardware, %u tones)%s%s", g_tones, g_sim_log ? ", log " : "", g_sim_log ? path : "");
+    if (g_word_ns) printf(", %llu ns/word", (unsigned long long)g_word_ns);
+    printf("\n");
+    return 0;
+}
+
+static void sim_close(void)
+{
+    pthread_mutex_lock(&g_sim_mu);
+    if (g_sim_log) { fclose(g_sim_log); g_sim_log = NULL; }
+    g_sim_on = 0;
+    pthread_mutex_unlock(&g_sim_mu);
+}
+
+static int sim_write(const uint32_t *words32, int count)
+{
+    uint64_t t0 = g_word_ns ? sim_now_ns() : 0;
+    pthread_mutex_lock(&g_sim_mu);
+    if (!g_sim_on) { pthread_mutex_unlock(&g_sim_mu); return -1; }
+    bool swapped = false;
+    for (int i = 0; i < count; ++i) {
+        uint32_t w    = words32[i];
+        unsigned cmd  = w >> 28;
+        unsigned ch   = (w >> 27) & 1u;
+        unsigned tone = ((w >> 24) & 7u) | ((w >> 20) & 8u);
+        switch (cmd) {
+            case 0x1: if (tone < g_tones) g_bank[!g_active][0][ch][tone] = w & ((1u << SIM_IDX_W) - 1);  break;
+            case 0x2: if (tone < g_tones) g_bank[!g_active][1][ch][tone] = w & ((1u << SIM_GAIN_W) - 1); break;
+            case 0xC: g_safe = (int)(w & 1u); g_cnt.other_words++; break;
+            case 0xF:
+                if (g_safe) { g_active = !g_active; g_cnt.commits++; swapped = true; }
+                else        g_cnt.blocked_commits++;
+                break;
+            default:  g_cnt.other_words++; break;   // DWELL, TRIG, unknown
+        }
+        if (g_sim_log) fprintf(g_sim_log, "%08x\n", w);
+    }
+    g_cnt.words += (uint64_t)count;
+    if (swapped) {
+        uint64_t now = sim_now_ns();
+        if (g_cnt.last_commit_ns && now - g_cnt.last_commit_ns < SIM_IDLE_GAP_NS) {
+            uint64_t gap = now - g_cnt.last_commit_ns;
+            g_cnt.gap_count++;
+            g_cnt.gap_sum_ns += gap;
+            if (gap < g_cnt.gap_min_ns) g_cnt.gap_min_ns = gap;
+            if (gap > g_cnt.gap_max_ns) g_cnt.gap_max_ns = gap;
+        }
+        g_cnt.last_commit_ns = now;
+    }
+    pthread_mutex_unlock(&g_sim_mu);
+    if (g_word_ns) {                               // outside the lock, like a bus stall
+        uint64_t until = t0 + g_word_ns * (uint64_t)count;
+        while (sim_now_ns() < until) { }
+    }
+    return 0;
+}
+
+int awg_sim_get_state(awg_sim_state_t *st)
+{
+    if (!st) return -1;
+    pthread_mutex_lock(&g_sim_mu);
+    if (!g_sim_on) { pthread_mutex_unlock(&g_sim_mu); return -1; }
+    *st = g_cnt;
+    if (!st->gap_count) st->gap_min_ns = 0;
+    memcpy(st->index, g_bank[g_active][0], sizeof(st->index));
+    memcpy(st->gain,  g_bank[g_active][1], sizeof(st->gain));
+    st->safe = (uint32_t)g_safe;
+    st->shadow_gain_max = 0;
+    for (int ch = 0; ch < 2; ++ch)
+        for (unsigned t = 0; t < g_tones; ++t)
+            if (g_bank[!g_active][1][ch][t] > st->shadow_gain_max) st->shadow_gain_max = g_bank[!g_active][1][ch][t];
+    pthread_mutex_unlock(&g_sim_mu);
+    return 0;
+}
+
+void awg_sim_reset_stats(void)
+{
+    pthread_mutex_lock(&g_sim_mu);
+    sim_clear_stats();
+    pthread_mutex_unlock(&g_sim_mu);
+}
+
+const awg_backend_ops_t awg_backend_sim = {
+    .name         = "sim",
+    .init         = sim_init,
+    .close        = sim_close,
+    .write        = sim_write,
+    .write_strict = NULL,
+};
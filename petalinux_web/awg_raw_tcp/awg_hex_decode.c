@@ -0,0 +1,145 @@
+/*
+ * awg_hex_decode.c — 336-char hex frame decoder (see awg_hex_decode.h)
+ * Two passes per group: characters -> nibbles (+ validity), vectorized with
+ * NEON or SWAR (tails by table); then nibbles -> INDEX/GAIN words with plain shifts.
+ * Neither pass branches on the data.
+ */
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+  #include <arm_neon.h>
+  #define AWG_HEX_NEON 1
+#else
+  #define AWG_HEX_NEON 0
+#endif
+
+#include "awg_hex_decode.h"
+
+// 0x00..0x0F for hex digits, 0xFF otherwise (GCC range initializer)
+static const uint8_t k_hex_lut[256] = {
+    [0 ... 255] = 0xFF,
+    ['0'] = 0, ['1'] = 1, ['2'] = 2, ['3'] = 3, ['4'] = 4,
+    ['5'] = 5, ['6'] = 6, ['7'] = 7, ['8'] = 8, ['9'] = 9,
+    ['a'] = 10, ['b'] = 11, ['c'] = 12, ['d'] = 13, ['e'] = 14, ['f'] = 15,
+    ['A'] = 10, ['B'] = 11, ['C'] = 12, ['D'] = 13, ['E'] = 14, ['F'] = 15,
+};
+
+// Scalar tail / fallback. Returns nonzero if any character was not hex.
+static inline unsigned nibbles_lut(const char *p, int n, uint8_t *dst) {
+    unsigned bad = 0;
+    for (int i = 0; i < n; ++i) {
+        uint8_t v = k_hex_lut[(unsigned char)p[i]];
+        bad |= v;
+        dst[i] = v;
+    }
+    return bad & 0xF0u;
+}
+
+#if AWG_HEX_NEON
+// 16 (or 8) characters per step: digit = c-'0' < 10, letter = (c|0x20)-'a' < 6.
+static unsigned nibbles(const char *p, int n, uint8_t *dst) {
+    const uint8x16_t k0 = vdupq_n_u8('0'), k10 = vdupq_n_u8(10);
+    const uint8x16_t ka = vdupq_n_u8('a'), k6  = vdupq_n_u8(6), k20 = vdupq_n_u8(0x20);
+    uint8x16_t ok = vdupq_n_u8(0xFF);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        uint8x16_t c   = vld1q_u8((const uint8_t*)p + i);
+        uint8x16_t d   = vsubq_u8(c, k0);
+        uint8x16_t l   = vsubq_u8(vorrq_u8(c, k20), ka);
+        uint8x16_t isd = vcltq_u8(d, k10);
+        uint8x16_t isl = vcltq_u8(l, k6);
+        vst1q_u8(dst + i, vbslq_u8(isd, d, vaddq_u8(l, k10)));
+        ok = vandq_u8(ok, vorrq_u8(isd, isl));
+    }
+    uint8x8_t okd = vand_u8(vget_low_u8(ok), vget_high_u8(ok));
+    for (; i + 8 <= n; i += 8) {
+        uint8x8_t c   = vld1_u8((const uint8_t*)p + i);
+        uint8x8_t d   = vsub_u8(c, vget_low_u8(k0));
+        uint8x8_t l   = vsub_u8(vorr_u8(c, vget_low_u8(k20)), vget_low_u8(ka));
+        uint8x8_t isd = vclt_u8(d, vget_low_u8(k10));
+        uint8x8_t isl = vclt_u8(l, vget_low_u8(k6));
+        vst1_u8(dst + i, vbsl_u8(isd, d, vadd_u8(l, vget_low_u8(k10))));
+        okd = vand_u8(okd, vorr_u8(isd, isl));
+    }
+    okd = vpmin_u8(okd, okd);
+    okd = vpmin_u8(okd, okd);
+    okd = vpmin_u8(okd, okd);
+    unsigned bad = (vget_lane_u8(okd, 0) != 0xFF);
+    if (i < n) bad |= nibbles_lut(p + i, n - i, dst + i);
+    return bad;
+}
+#else
+// 8 characters per step in a 64-bit word (SWAR). On 7-bit bytes, x + (0x80 - lo)
+// sets bit 7 iff x >= lo and never carries into the next byte.
+#define SWAR_B(v) (0x0101010101010101ull * (uint64_t)(v))
+static unsigned nibbles(const char *p, int n, uint8_t *dst) {
+    uint64_t ok = SWAR_B(0x80);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t x;  memcpy(&x, p + i, 8);
+        uint64_t hi  = x & SWAR_B(0x80);             // non-ASCII bytes are invalid
+        uint64_t x7  = x & SWAR_B(0x7F);
+        uint64_t y7  = x7 | SWAR_B(0x20);            // fold case
+        uint64_t dig = ((x7 + SWAR_B(0x80 - '0')) & ~(x7 + SWAR_B(0x80 - '9' - 1))) & SWAR_B(0x80);
+        uint64_t let = ((y7 + SWAR_B(0x80 - 'a')) & ~(y7 + SWAR_B(0x80 - 'f' - 1))) & SWAR_B(0x80);
+        ok &= (dig | let) & ~hi;
+        uint64_t nib = (x & SWAR_B(0x0F)) + (let >> 7) * 9;   // 'a'/'A' & 0x0F = 1 -> 10
+        memcpy(dst + i, &nib, 8);
+    }
+    unsigned bad = (ok != SWAR_B(0x80));
+    if (i < n) bad |= nibbles_lut(p + i, n - i, dst + i);
+    return bad;
+}
+#endif
+
+// One channel: 8 INDEX words from 3 nibbles each, 8 GAIN words from the
+// last 5 of 18 nibbles each (bit layout as in awg_core_mmap.c).
+static inline void pack_channel(int ch, const uint8_t *ni, const uint8_t *ng, uint32_t *out) {
+    const uint32_t sel_ch = (uint32_t)(ch & 1) << 27;
+    for (int t = 0; t < 8; ++t) {
+        const uint8_t *q = ni + 3 * t;
+        uint32_t v = ((uint32_t)q[0] << 8) | ((uint32_t)q[1] << 4) | q[2];
+        out[t] = (0x1u << 28) | sel_ch | ((uint32_t)t << 24) | v;
+    }
+    for (int t = 0; t < 8; ++t) {
+        const uint8_t *q = ng + 18 * t + 13;
+        uint32_t v = ((uint32_t)q[0] << 16) | ((uint32_t)q[1] << 12) | ((uint32_t)q[2] << 8)
+                   | ((uint32_t)q[3] << 4) | q[4];
+        out[8 + t] = (0x2u << 28) | sel_ch | ((uint32_t)t << 24) | v;
+    }
+}
+
+int awg_hex_decode4(const char *idxA, const char *gainA,
+                    const char *idxB, const char *gainB,
+                    uint32_t out[AWG_HEX_FRAME_WORDS])
+{
+    uint8_t n[AWG_HEX_FRAME_LEN];
+    uint8_t *niA = n, *ngA = niA + AWG_HEX_IDX_LEN;
+    uint8_t *niB = ngA + AWG_HEX_GAIN_LEN, *ngB = niB + AWG_HEX_IDX_LEN;
+
+    unsigned bad = nibbles(idxA,  AWG_HEX_IDX_LEN,  niA)
+                 | nibbles(gainA, AWG_HEX_GAIN_LEN, ngA)
+                 | nibbles(idxB,  AWG_HEX_IDX_LEN,  niB)
+                 | nibbles(gainB, AWG_HEX_GAIN_LEN, ngB);
+    if (bad) return -1;
+
+    pack_channel(0, niA, ngA, out);
+    pack_channel(1, niB, ngB, out + 16);
+    out[32] = 0xFu << 28;   // COMMIT
+    return 0;
+}
+
+int awg_hex_decode_frame(const char *hex336, uint32_t out[AWG_HEX_FRAME_WORDS])
+{
+    const char *idxA  = hex336;
+    const char *gainA = idxA + AWG_HEX_IDX_LEN;
+    const char *idxB  = gainA + AWG_HEX_GAIN_LEN;
+    const char *gainB = idxB + AWG_HEX_IDX_LEN;
+    return awg_hex_decode4(idxA, gainA, idxB, gainB, out);
+}
+
+const char *awg_hex_decode_impl(void)
+{
+    return AWG_HEX_NEON ? "neon" : "swar";
+}
@@ -0,0 +1,30 @@
+// awg_hex_decode.h — Validating decoder for the 336-char ASCII hex frame
+// (idxA 24, gainA 144, idxB 24, gainB 144; see awg_core_mmap.c header).
+// NEON on ARM (Cortex-A9), 64-bit SWAR elsewhere, lookup table for tails.
+
+#ifndef AWG_HEX_DECODE_H
+#define AWG_HEX_DECODE_H
+
+#include <stdint.h>
+
+enum {
+    AWG_HEX_IDX_LEN    = 24,    // 8 tones * 3 hex
+    AWG_HEX_GAIN_LEN   = 144,   // 8 tones * 18 hex (low 5 hex = 20 bits used)
+    AWG_HEX_FRAME_LEN  = 2 * (AWG_HEX_IDX_LEN + AWG_HEX_GAIN_LEN),   // 336
+    AWG_HEX_FRAME_WORDS = 33    // 8 INDEX + 8 GAIN per channel, then COMMIT
+};
+
+// Decode the four groups into out[33]: A.index[0..7], A.gain[0..7],
+// B.index[0..7], B.gain[0..7], COMMIT — the order awg_send_hex4() always used.
+// Every character is checked. Returns 0, or -1 if any character is not hex.
+int awg_hex_decode4(const char *idxA, const char *gainA,
+                    const char *idxB, const char *gainB,
+                    uint32_t out[AWG_HEX_FRAME_WORDS]);
+
+// Same for one contiguous 336-char frame (UDP/WS datagram layout).
+int awg_hex_decode_frame(const char *hex336, uint32_t out[AWG_HEX_FRAME_WORDS]);
+
+// Name of the compiled-in implementation ("neon" or "swar").
+const char *awg_hex_decode_impl(void);
+
+#endif // AWG_HEX_DECODE_H
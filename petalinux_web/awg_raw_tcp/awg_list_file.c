@@ -0,0 +1,195 @@
+/*
+ * awg_list_file.c — Persistent list files (see awg_list_file.h).
+ * STORE writes the arena of a loaded list section by section; LOAD maps the
+ * file MAP_PRIVATE|MAP_POPULATE read-only, so the player reads the page
+ * cache directly and never faults (mlockall(MCL_FUTURE) also locks it).
+ */
+#define _GNU_SOURCE
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "awg_list_file.h"
+
+#ifdef DEBUG
+  #define DPRINT(fmt, ...) printf("[LISTFILE] " fmt, ##__VA_ARGS__)
+#else
+  #define DPRINT(fmt, ...) do{}while(0)
+#endif
+
+#define DEFAULT_LIST_DIR "/home/petalinux/awg_lists"
+#define MAX_FRAMES       2000000u     // same bound as BEGIN
+
+static inline uint64_t align_up(uint64_t v) {
+    return (v + AWG_LIST_FILE_ALIGN - 1) & ~(uint64_t)(AWG_LIST_FILE_ALIGN - 1);
+}
+
+static const char *list_dir(void) {
+    const char *d = getenv("AWG_LIST_DIR");
+    return (d && *d) ? d : DEFAULT_LIST_DIR;
+}
+
+// <dir>/<name>.awgl; the name must not be able to leave the directory
+static int list_path(const char *name, char *path, size_t len) {
+    size_t n = strnlen(name, AWG_LIST_NAME_MAX + 1);
+    if (n == 0 || n > AWG_LIST_NAME_MAX || name[0] == '.') return -1;
+    for (size_t i = 0; i < n; ++i) {
+        char c = name[i];
+        if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+              c == '_' || c == '-' || c == '.')) return -1;
+    }
+    int w = snprintf(path, len, "%s/%s.awgl", list_dir(), name);
+    return (w > 0 && (size_t)w < len) ? 0 : -1;
+}
+
+static int pwrite_all(int fd, const void *buf, size_t len, uint64_t pos) {
+    const uint8_t *p = buf;
+    while (len) {
+        ssize_t w = pwrite(fd, p, len, (off_t)pos);
+        if (w < 0) { if (errno == EINTR) continue; return -1; }
+        p += w; len -= (size_t)w; pos += (uint64_t)w;
+    }
+    return 0;
+}
+
+int awg_list_file_store(const char *name, const awg_list_file_t *src)
+{
+    char path[256], tmp[272];
+    if (list_path(name, path, sizeof(path)) != 0) return -1;
+    if (!src || src->frames == 0 || (!src->frame_words && !src->starts) || !src->wordv) return -2;
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+
+    awg_list_file_hdr_t h;
+    memset(&h, 0, sizeof(h));
+    h.magic       = AWG_LIST_FILE_MAGIC;
+    h.version     = AWG_LIST_FILE_VERSION;
+    h.frames      = src->frames;
+    h.words       = src->words;
+    h.period_us   = src->period_us;
+    h.repeat      = src->repeat;
+    h.flags       = src->flags;
+    h.frame_words = src->frame_words;
+    uint64_t index_bytes = src->frame_words ? 0 : ((uint64_t)src->frames + 1) * sizeof(uint32_t);
+    h.index_pos   = index_bytes ? AWG_LIST_FILE_ALIGN : 0;
+    h.words_pos   = align_up(AWG_LIST_FILE_ALIGN + index_bytes);
+    h.file_bytes  = align_up(h.words_pos + (uint64_t)src->words * sizeof(uint32_t));
+
+    mkdir(list_dir(), 0755);                          // EEXIST is fine
+    int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) { perror(tmp); return -2; }
+    int rc = 0;
+    if (ftruncate(fd, (off_t)h.file_bytes) != 0 ||    // sparse zero padding
+        pwrite_all(fd, &h, sizeof(h), 0) != 0 ||
+        (index_bytes && pwrite_all(fd, src->starts, (size_t)index_bytes, h.index_pos) != 0) ||
+        pwrite_all(fd, src->wordv, (size_t)src->words * sizeof(uint32_t), h.words_pos) != 0 ||
+        fsync(fd) != 0) {
+        perror(tmp);
+        rc = -2;
+    }
+    close(fd);
+    if (rc == 0 && rename(tmp, path) != 0) { perror(path); rc = -2; }
+    if (rc != 0) unlink(tmp);
+    else DPRINT("Stored %s: %u frames, %u words, %llu bytes.\n", path, h.frames, h.words,
+                (unsigned long long)h.file_bytes);
+    return rc;
+}
+
+int awg_list_file_load(const char *name, uint32_t max_frame_words, awg_list_file_t *out)
+{
+    char path[256];
+    memset(out, 0, sizeof(*out));
+    if (list_path(name, path, sizeof(path)) != 0) return -1;
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) { DPRINT("open %s: %s\n", path, strerror(errno)); return -2; }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (uint64_t)st.st_size < AWG_LIST_FILE_ALIGN) { close(fd); return -3; }
+
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    close(fd);                                        // the mapping keeps the file
+    if (map == MAP_FAILED) { perror("mmap list file"); return -2; }
+
+    const awg_list_file_hdr_t *h = map;
+    uint64_t size = (uint64_t)st.st_size;
+    bool ok = h->magic == AWG_LIST_FILE_MAGIC && h->version == AWG_LIST_FILE_VERSION &&
+              h->frames > 0 && h->frames <= MAX_FRAMES && h->file_bytes == size &&
+              h->index_pos % AWG_LIST_FILE_ALIGN == 0 && h->words_pos % AWG_LIST_FILE_ALIGN == 0 &&
+              h->words_pos + (uint64_t)h->words * sizeof(uint32_t) <= size;
+
+    // The player trusts the index: one bounds pass over it
+    const uint32_t *starts = NULL;
+    if (ok && h->frame_words) {
+        ok = h->frame_words <= max_frame_words && (uint64_t)h->frames * h->frame_words == h->words;
+    } else if (ok) {
+        starts = (const uint32_t *)((const uint8_t *)map + h->index_pos);
+        ok = h->index_pos >= AWG_LIST_FILE_ALIGN &&
+             h->index_pos + ((uint64_t)h->frames + 1) * sizeof(uint32_t) <= h->words_pos &&
+             starts[0] == 0 && starts[h->frames] == h->words;
+        for (uint32_t i = 0; ok && i < h->frames; ++i)
+            ok = starts[i + 1] > starts[i] && starts[i + 1] - starts[i] <= max_frame_words;
+    }
+    if (!ok) {
+        fprintf(stderr, "[LISTFILE] %s is not a valid list file\n", path);
+        munmap(map, (size_t)size);
+        return -3;
+    }
+
+    out->frames      = h->frames;
+    out->words       = h->words;
+    out->period_us   = h->period_us;
+    out->repeat      = h->repeat;
+    out->flags       = h->flags;
+    out->frame_words = h->frame_words;
+    out->starts      = starts;
+    out->wordv       = (const uint32_t *)((const uint8_t *)map + h->words_pos);
+    out->map         = map;
+    out->map_len     = (size_t)size;
+    DPRINT("Loaded %s: %u frames, %u words.\n", path, h->frames, h->words);
+    return 0;
+}
+
+void awg_list_file_unmap(awg_list_file_t *f)
+{
+    if (f->map) munmap(f->map, f->map_len);
+    memset(f, 0, sizeof(*f));
+}
+
+int awg_list_file_scan(awg_list_file_info_t *out, int max)
+{
+    DIR *d = opendir(list_dir());
+    if (!d) return -2;
+    int n = 0;
+    struct dirent *e;
+    while ((e = readdir(d)) != NULL) {
+        size_t len = strlen(e->d_name);
+        if (len <= 5 || strcmp(e->d_name + len - 5, ".awgl") != 0 || len - 5 > AWG_LIST_NAME_MAX) continue;
+        char name[AWG_LIST_NAME_MAX + 1], path[256];
+        memcpy(name, e->d_name, len - 5);
+        name[len - 5] = '\0';
+        if (list_path(name, path, sizeof(path)) != 0) continue;
+
+        awg_list_file_hdr_t h;
+        int fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) continue;
+        ssize_t r = pread(fd, &h, sizeof(h), 0);
+        close(fd);
+        if (r != (ssize_t)sizeof(h) || h.magic != AWG_LIST_FILE_MAGIC || h.version != AWG_LIST_FILE_VERSION) continue;
+        if (n < max) {
+            memcpy(out[n].name, name, len - 4);
+            out[n].frames    = h.frames;
+            out[n].words     = h.words;
+            out[n].period_us = h.period_us;
+        }
+        n++;
+    }
+    closedir(d);
+    return n;
+}
@@ -0,0 +1,75 @@
+// awg_list_file.h — On-board waveform library: fully loaded lists stored as
+// page-aligned binary files and mapped back read-only, without parsing.
+// Files live in AWG_LIST_DIR (default /home/petalinux/awg_lists) as
+// <name>.awgl; names are 1..64 chars of [A-Za-z0-9_.-], not starting with '.'.
+//
+// Layout (host byte order, every section starts on a 4 KiB boundary):
+//   0x0000     header (awg_list_file_hdr_t, rest of the page zero)
+//   index_pos  uint32_t starts[frames+1]  prefix sums, frame i = words[starts[i]..starts[i+1])
+//              (absent, index_pos = 0, when every frame has frame_words words)
+//   words_pos  uint32_t words[words]      command words as played
+
+#ifndef AWG_LIST_FILE_H
+#define AWG_LIST_FILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define AWG_LIST_FILE_MAGIC    0x4C475741u   // "AWGL" read as little-endian uint32
+#define AWG_LIST_FILE_VERSION  2u          // 2: compact frame index
+#define AWG_LIST_FILE_ALIGN    4096u
+#define AWG_LIST_FILE_DELTA    0x1u          // list holds delta frames (never skip)
+#define AWG_LIST_NAME_MAX      64
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t frames;
+    uint32_t words;
+    uint32_t period_us;      // 0 = global period
+    uint32_t repeat;         // 0 = loop
+    uint32_t flags;          // AWG_LIST_FILE_*
+    uint32_t frame_words;    // >0: fixed frame size, no index section
+    uint64_t index_pos;
+    uint64_t words_pos;
+    uint64_t file_bytes;
+    uint64_t reserved;
+} awg_list_file_hdr_t;
+
+// A list as stored/loaded. After awg_list_file_load() the arrays point into
+// a read-only private mapping (prefaulted) until awg_list_file_unmap().
+typedef struct {
+    uint32_t        frames;
+    uint32_t        words;
+    uint32_t        period_us;
+    uint32_t        repeat;
+    uint32_t        flags;
+    uint32_t        frame_words;   // >0: fixed frame size, starts == NULL
+    const uint32_t *starts;        // frames+1 prefix sums otherwise
+    const uint32_t *wordv;
+    void           *map;
+    size_t          map_len;
+} awg_list_file_t;
+
+// Write atomically (temp file + rename). Returns 0, -1 bad name, -2 I/O error.
+int  awg_list_file_store(const char *name, const awg_list_file_t *src);
+
+// Map and bounds-check (frames tile words[] exactly, each 1..max_frame_words).
+// Returns 0, -1 bad name, -2 not found / I/O error, -3 not a valid list file.
+int  awg_list_file_load(const char *name, uint32_t max_frame_words, awg_list_file_t *out);
+
+void awg_list_file_unmap(awg_list_file_t *f);
+
+// [NEW] Library listing: header of every valid <name>.awgl in AWG_LIST_DIR
+// (only the header is read). Fills up to max entries, returns the number of
+// valid files found (may exceed max), or -2 if the directory cannot be read.
+typedef struct {
+    char     name[AWG_LIST_NAME_MAX + 1];
+    uint32_t frames;
+    uint32_t words;
+    uint32_t period_us;
+} awg_list_file_info_t;
+
+int  awg_list_file_scan(awg_list_file_info_t *out, int max);
+
+#endif // AWG_LIST_FILE_H
@@ -0,0 +1,162 @@
+/*
+ * awg_reactor.c — epoll network reactor (see awg_reactor.h)
+ * Replaces the per-port accept threads and the per-client direct threads.
+ * Handlers are looked up through epoll_data.ptr; a removed handler is only
+ * marked dead and freed after the current batch, so it is never called.
+ */
+#define _GNU_SOURCE
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "awg_reactor.h"
+
+#ifdef DEBUG
+  #define DPRINT(fmt, ...) printf("[REACTOR] " fmt, ##__VA_ARGS__)
+#else
+  #define DPRINT(fmt, ...) do{}while(0)
+#endif
+
+#define MAX_EVENTS 32
+
+typedef struct handler {
+    int             fd;      // -1 once removed
+    awg_reactor_cb  cb;
+    void           *ctx;
+    struct handler *next;    // all handlers / dead list
+} handler_t;
+
+static int        g_epfd = -1;
+static int        g_evfd = -1;
+static pthread_t  g_thread;
+static bool       g_thread_running = false;
+static handler_t *g_handlers = NULL;   // live handlers (loop thread, or before start/after stop)
+static handler_t *g_dead = NULL;       // removed during the current batch
+
+int awg_reactor_init(void) {
+    g_epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (g_epfd < 0) { perror("[REACTOR] epoll_create1"); return -1; }
+    g_evfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (g_evfd < 0) { perror("[REACTOR] eventfd"); close(g_epfd); g_epfd = -1; return -2; }
+    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = NULL }; // NULL = shutdown
+    if (epoll_ctl(g_epfd, EPOLL_CTL_ADD, g_evfd, &ev) != 0) {
+        perror("[REACTOR] epoll_ctl(eventfd)");
+        awg_reactor_close();
+        return -3;
+    }
+    return 0;
+}
+
+static handler_t *find_handler(int fd) {
+    for (handler_t *h = g_handlers; h; h = h->next) if (h->fd == fd) return h;
+    return NULL;
+}
+
+int awg_reactor_add(int fd, uint32_t events, awg_reactor_cb cb, void *ctx) {
+    handler_t *h = calloc(1, sizeof(*h));
+    if (!h) return -1;
+    h->fd = fd; h->cb = cb; h->ctx = ctx;
+    struct epoll_event ev = { .events = events, .data.ptr = h };
+    if (epoll_ctl(g_epfd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        perror("[REACTOR] epoll_ctl(ADD)");
+        free(h);
+        return -1;
+    }
+    h->next = g_handlers;
+    g_handlers = h;
+    return 0;
+}
+
+int awg_reactor_mod(int fd, uint32_t events) {
+    handler_t *h = find_handler(fd);
+    if (!h) return -1;
+    struct epoll_event ev = { .events = events, .data.ptr = h };
+    return epoll_ctl(g_epfd, EPOLL_CTL_MOD, fd, &ev);
+}
+
+void awg_reactor_del(int fd) {
+    handler_t **pp = &g_handlers;
+    while (*pp && (*pp)->fd != fd) pp = &(*pp)->next;
+    handler_t *h = *pp;
+    if (!h) return;
+    *pp = h->next;
+    epoll_ctl(g_epfd, EPOLL_CTL_DEL, fd, NULL);
+    h->fd = -1;
+    h->next = g_dead;        // freed after the batch that may still reference it
+    g_dead = h;
+}
+
+int awg_reactor_listen_tcp(unsigned short port, int backlog) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) { perror("[REACTOR] socket"); return -1; }
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in a; memset(&a, 0, sizeof(a));
+    a.sin_family = AF_INET; a.sin_addr.s_addr = htonl(INADDR_ANY); a.sin_port = htons(port);
+    if (bind(fd, (struct sockaddr*)&a, sizeof(a)) < 0) { perror("[REACTOR] bind"); close(fd); return -1; }
+    if (listen(fd, backlog) < 0) { perror("[REACTOR] listen"); close(fd); return -1; }
+    return fd;
+}
+
+static void free_dead(void) {
+    while (g_dead) { handler_t *n = g_dead->next; free(g_dead); g_dead = n; }
+}
+
+static void *reactor_loop(void *arg) {
+    (void)arg;
+    struct epoll_event evs[MAX_EVENTS];
+    for (;;) {
+        int n = epoll_wait(g_epfd, evs, MAX_EVENTS, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("[REACTOR] epoll_wait");
+            break;
+        }
+        bool stop = false;
+        for (int i = 0; i < n; ++i) {
+            handler_t *h = (handler_t*)evs[i].data.ptr;
+            if (!h) { stop = true; continue; }
+            if (h->fd < 0) continue;              // removed earlier in this batch
+            h->cb(h->fd, evs[i].events, h->ctx);
+        }
+        free_dead();
+        if (stop) break;
+    }
+    DPRINT("Event loop exiting.\n");
+    return NULL;
+}
+
+int awg_reactor_start(void) {
+    if (pthread_create(&g_thread, NULL, reactor_loop, NULL) != 0) {
+        perror("[REACTOR] pthread_create");
+        return -1;
+    }
+    g_thread_running = true;
+    return 0;
+}
+
+void awg_reactor_stop(void) {
+    if (!g_thread_running) return;
+    uint64_t one = 1;
+    if (write(g_evfd, &one, sizeof(one)) != sizeof(one)) perror("[REACTOR] eventfd write");
+    pthread_join(g_thread, NULL);
+    g_thread_running = false;
+}
+
+void awg_reactor_close(void) {
+    while (g_handlers) { handler_t *n = g_handlers->next; free(g_handlers); g_handlers = n; }
+    free_dead();
+    if (g_evfd >= 0) { close(g_evfd); g_evfd = -1; }
+    if (g_epfd >= 0) { close(g_epfd); g_epfd = -1; }
+}
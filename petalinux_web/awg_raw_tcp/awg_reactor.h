@@ -0,0 +1,34 @@
+// awg_reactor.h — Single epoll event loop for all AWG server sockets.
+// One non-RT thread multiplexes the listening ports and every client socket;
+// shutdown is signalled through an eventfd. Handlers run on the loop thread.
+
+#ifndef AWG_REACTOR_H
+#define AWG_REACTOR_H
+
+#include <stdint.h>
+#include <sys/epoll.h>
+
+typedef void (*awg_reactor_cb)(int fd, uint32_t events, void *ctx);
+
+// Create the epoll instance and the shutdown eventfd. Returns 0 ok.
+int  awg_reactor_init(void);
+
+// Watch fd for events (EPOLLIN, ...). Returns 0 ok.
+int  awg_reactor_add(int fd, uint32_t events, awg_reactor_cb cb, void *ctx);
+int  awg_reactor_mod(int fd, uint32_t events);
+
+// Stop watching fd (the caller still owns and closes it). Safe from a handler,
+// also for fds with events pending in the current batch.
+void awg_reactor_del(int fd);
+
+// Non-blocking TCP listener on INADDR_ANY:port. Returns fd or -1.
+int  awg_reactor_listen_tcp(unsigned short port, int backlog);
+
+// Start the loop thread / wake it through the eventfd and join it.
+int  awg_reactor_start(void);
+void awg_reactor_stop(void);
+
+// Release epoll/eventfd and any handler still registered.
+void awg_reactor_close(void);
+
+#endif // AWG_REACTOR_H
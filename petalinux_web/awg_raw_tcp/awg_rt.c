@@ -0,0 +1,134 @@
+/*
+ * awg_rt.c — Real-time setup stage used by awg_server_raw_top.c (see awg_rt.h)
+ * The Zynq-7000 has two A9 cores: by default the player owns core 1 and
+ * everything else (network, notify, main) stays on core 0.
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "awg_rt.h"
+
+#define PROBE_PERIOD_NS 1000000L
+
+static int g_player_cpu = -1;
+
+static int env_int(const char *name, int def) {
+    const char *v = getenv(name);
+    return (v && *v) ? atoi(v) : def;
+}
+
+void awg_rt_load_config(awg_rt_cfg_t *cfg) {
+    cfg->player_cpu  = env_int("AWG_RT_PLAYER_CPU", 1);
+    cfg->net_cpu     = env_int("AWG_RT_NET_CPU", 0);
+    cfg->mlock       = env_int("AWG_RT_MLOCK", 1) != 0;
+    cfg->probe_ticks = env_int("AWG_RT_PROBE", 0);
+
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cfg->player_cpu >= ncpu || cfg->net_cpu >= ncpu || ncpu < 2) {
+        printf("[RT] %ld CPU(s) online, CPU pinning disabled.\n", ncpu);
+        cfg->player_cpu = cfg->net_cpu = -1;
+    }
+}
+
+int awg_rt_pin_thread(pthread_t th, int cpu) {
+    if (cpu < 0) return 0;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    int rc = pthread_setaffinity_np(th, sizeof(set), &set);
+    if (rc != 0) {
+        fprintf(stderr, "[RT] pthread_setaffinity_np(cpu %d) failed: %s\n", cpu, strerror(rc));
+        return -1;
+    }
+    return 0;
+}
+
+int awg_rt_player_cpu(void) { return g_player_cpu; }
+
+int awg_rt_setup(const awg_rt_cfg_t *cfg) {
+    int rc = 0;
+    g_player_cpu = cfg->player_cpu;
+
+    if (cfg->mlock && mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        fprintf(stderr, "[RT] mlockall failed: %s\n", strerror(errno));
+        rc = -1;
+    }
+    if (awg_rt_pin_thread(pthread_self(), cfg->net_cpu) != 0) rc = -2;
+
+    printf("[RT] player cpu %d, network cpu %d, mlockall %s\n",
+           cfg->player_cpu, cfg->net_cpu, cfg->mlock ? "on" : "off");
+    return rc;
+}
+
+void awg_rt_prefault(void *p, size_t len) {
+    if (!p || !len) return;
+    long pg = sysconf(_SC_PAGESIZE);
+    size_t step = pg > 0 ? (size_t)pg : 4096;
+    volatile uint8_t *b = (volatile uint8_t*)p;
+    for (size_t i = 0; i < len; i += step) b[i] = b[i];
+    b[len - 1] = b[len - 1];
+}
+
+// --- Jitter probe ---
+typedef struct {
+    int      ticks;
+    uint64_t max_ns;
+    uint64_t sum_ns;
+} probe_arg_t;
+
+static void *probe_thread(void *arg) {
+    probe_arg_t *a = (probe_arg_t*)arg;
+    struct timespec ts, now;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    for (int i = 0; i < a->ticks; ++i) {
+        ts.tv_nsec += PROBE_PERIOD_NS;
+        if (ts.tv_nsec >= 1000000000L) { ts.tv_nsec -= 1000000000L; ts.tv_sec++; }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        int64_t late = (int64_t)(now.tv_sec - ts.tv_sec) * 1000000000LL + (now.tv_nsec - ts.tv_nsec);
+        if (late < 0) late = 0;
+        a->sum_ns += (uint64_t)late;
+        if ((uint64_t)late > a->max_ns) a->max_ns = (uint64_t)late;
+    }
+    return NULL;
+}
+
+void awg_rt_probe(const char *label, int ticks, int cpu, int prio) {
+    if (ticks <= 0) return;
+    probe_arg_t a = { .ticks = ticks };
+    // Affinity and policy are set before the thread runs its first tick
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    if (cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        pthread_attr_setaffinity_np(&attr, sizeof(set), &set);
+    }
+    if (prio > 0) {
+        struct sched_param sp = { .sched_priority = prio };
+        pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+        pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+        pthread_attr_setschedparam(&attr, &sp);
+    }
+    pthread_t th;
+    int rc = pthread_create(&th, &attr, probe_thread, &a);
+    pthread_attr_destroy(&attr);
+    if (rc != 0) {
+        fprintf(stderr, "[RT] jitter probe thread failed: %s\n", strerror(rc));
+        return;
+    }
+    pthread_join(th, NULL);
+    printf("[RT] jitter %s: %d ticks @ 1 ms, mean late %llu us, max late %llu us\n",
+           label, ticks, (unsigned long long)(a.sum_ns / (uint64_t)ticks / 1000),
+           (unsigned long long)(a.max_ns / 1000));
+}
@@ -0,0 +1,42 @@
+// awg_rt.h — Real-time setup for the AWG server (CPU pinning, memory locking).
+// Configured from the environment (see awg_server.service):
+//   AWG_RT_PLAYER_CPU  core for the player thread         (default 1, -1 = no pinning)
+//   AWG_RT_NET_CPU     core for main/network/notify threads (default 0, -1 = no pinning)
+//   AWG_RT_MLOCK       1 = mlockall(MCL_CURRENT|MCL_FUTURE) (default 1)
+//   AWG_RT_PROBE       ticks of a 1 ms jitter probe run before and after setup (default 0 = off)
+
+#ifndef AWG_RT_H
+#define AWG_RT_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct {
+    int  player_cpu;
+    int  net_cpu;
+    bool mlock;
+    int  probe_ticks;
+} awg_rt_cfg_t;
+
+void awg_rt_load_config(awg_rt_cfg_t *cfg);
+
+// Lock memory and pin the calling thread (threads created later inherit it).
+// Returns 0 ok, <0 if a step failed (the server keeps running).
+int  awg_rt_setup(const awg_rt_cfg_t *cfg);
+
+// Configured player core, -1 if none.
+int  awg_rt_player_cpu(void);
+
+// Pin a thread to one core; cpu < 0 is a no-op. Returns 0 ok.
+int  awg_rt_pin_thread(pthread_t th, int cpu);
+
+// Touch every page of [p, p+len) so later accesses cannot page-fault.
+// Contents are preserved.
+void awg_rt_prefault(void *p, size_t len);
+
+// Run 'ticks' 1 ms absolute sleeps on 'cpu' (-1 = any) at SCHED_FIFO 'prio'
+// (0 = SCHED_OTHER) and print the wakeup lateness under 'label'.
+void awg_rt_probe(const char *label, int ticks, int cpu, int prio);
+
+#endif // AWG_RT_H
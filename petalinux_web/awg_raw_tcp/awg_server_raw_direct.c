@@ -3,25 +3,28 @@
  * Protocol:
  *   [2 bytes] COUNT (big-endian, number of 32-bit words; >0)
  *   [4*COUNT] WORDS (each 32-bit big-endian)
- * Each frame is applied immediately: awg_send_words32(words, COUNT).
- * Build:
- *  gcc -O2 -pthread -Wall -DDEBUG -o awg_server \
- *       awg_server_raw_top.c \
- *       awg_server_raw_direct.c \
- *       awg_server_raw_queue.c \
- *       awg_server_raw_notify.c \
- *       awg_core_mmap.c
- * 
+ * Each frame is applied immediately: awg_send_words32_burst(words, COUNT).
+ * [MODIFIED] While the queue player (9100) is playing, frames are merged
+ * into the player's frames instead of interleaving with them, see
+ * queue_direct_frame() in awg_server_raw_shared.h (RELEASE word 0xE).
+ * With the DMA backend frames go through the DMA when the player is idle
+ * and are rejected (counted in errors) while it streams a list.
+ * Sockets are served by the shared epoll reactor (awg_reactor.c): no
+ * per-client threads; a client may send frames in any TCP segmentation.
+ * Build: part of awg_server, see the source list in awg_server_raw_top.c
+ * (or make -f Makefile.onboard).
+ *
  * Exported API:
  *   int  start_direct_server(unsigned short port);
  *   void stop_direct_server(void);
+ *   void get_direct_server_stats(tcp_server_stats_t *st);   [NEW]
  */
 
+#define _GNU_SOURCE
 #include <arpa/inet.h>
 #include <errno.h>
 #include <netinet/tcp.h>
-#include <poll.h>
-#include <pthread.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -31,6 +34,9 @@
 #include <time.h>
 #include <unistd.h>
 #include "awg_core.h"
+#include "awg_sock_reader.h"
+#include "awg_reactor.h"
+#include "awg_server_raw_shared.h"
 
 #ifdef DEBUG
   #define DPRINT(fmt, ...) printf("[DIRECT] " fmt, ##__VA_ARGS__)
@@ -40,122 +46,110 @@
 
 #define SOCK_RCVBUF       (256*1024)
 #define IO_TIMEOUT_MS     100
-#define FRAME_TIMEOUT_MS  0     // 0 = per-read only
-#define MAX_WORDS         64
+#define MAX_WORDS         AWG_FRAME_WORDS_MAX   // [MODIFIED] a full 16-tone frame (65)
 
-static volatile int g_stop_direct = 0;
 static int g_listen = -1;
+static tcp_server_stats_t    g_net;    // [NEW] relaxed atomics, see get_direct_server_stats()
+static awg_reader_counters_t g_rx;
 
-static int64_t now_ms(void){
-    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
-    return (int64_t)ts.tv_sec*1000 + ts.tv_nsec/1000000;
-}
-
-// return 1 ok, 0 peer closed, -2 timeout, -1 error
-static int read_n_timeout(int fd, void* buf, size_t n, int64_t deadline) {
-    uint8_t* p = (uint8_t*)buf;
-    size_t got = 0;
-    while (got < n) {
-        int to;
-        if (deadline >= 0) {
-            int64_t rem = deadline - now_ms();
-            if (rem <= 0) return -2;
-            to = (rem > 60000) ? 60000 : (int)rem;
-        } else {
-            to = IO_TIMEOUT_MS;
-        }
-        struct pollfd pfd = { .fd = fd, .events = POLLIN };
-        int pr = poll(&pfd, 1, to);
-        if (pr == 0) return -2;
-        if (pr < 0) { if (errno==EINTR) continue; return -1; }
-        if (pfd.revents & (POLLERR|POLLHUP|POLLNVAL)) return 0;
-
-        ssize_t r = recv(fd, p+got, n-got, 0);
-        if (r == 0) return 0;
-        if (r < 0) {
-            if (errno==EINTR) continue;
-            if (errno==EAGAIN || errno==EWOULDBLOCK) continue;
-            return -1;
-        }
-        got += (size_t)r;
-    }
-    return 1;
-}
+typedef struct {
+    awg_reader_t rd;
+} direct_client_t;
 
 static void be32_to_host(uint32_t* w, int count){
     for (int i=0;i<count;i++) w[i]=ntohl(w[i]);
 }
 
-static void* client_thread(void* arg){
-    int fd = (int)(intptr_t)arg;
-    int one=1; setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
-    setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &(int){SOCK_RCVBUF}, sizeof(int));
+static void client_close(int fd, direct_client_t *c){
+    awg_reactor_del(fd);
+    awg_reader_free(&c->rd);
+    free(c);
+    close(fd);
+    DPRINT("client fd=%d closed\n", fd);
+}
 
-    uint8_t  hdr[2];
+// Apply every complete frame in the buffer. Return false on protocol error.
+static bool drain_frames(direct_client_t *c){
     uint32_t words[MAX_WORDS];
-
-    while (!g_stop_direct) {
-        int64_t deadline = (FRAME_TIMEOUT_MS>0)? (now_ms()+FRAME_TIMEOUT_MS) : -1;
-
-        int ok = read_n_timeout(fd, hdr, 2, deadline);
-        if (ok == 0)  break;
-        if (ok == -2) { DPRINT("timeout on count\n"); break; }
-        if (ok < 0)   { DPRINT("read count error\n"); break; }
-
-        uint16_t be_cnt; memcpy(&be_cnt, hdr, 2);
+    for (;;) {
+        size_t have = awg_reader_buffered(&c->rd);
+        if (have < 2) return true;
+        const uint8_t *p = awg_reader_peek(&c->rd);
+        uint16_t be_cnt; memcpy(&be_cnt, p, 2);
         int count = (int)ntohs(be_cnt);
-        if (count <= 0 || count > MAX_WORDS) { DPRINT("bad count=%d\n",count); break; }
+        if (count <= 0 || count > MAX_WORDS) { DPRINT("bad count=%d\n",count); return false; }
 
-        size_t need = (size_t)count * 4;
-        ok = read_n_timeout(fd, words, need, deadline);
-        if (ok == 0)  break;
-        if (ok == -2) { DPRINT("timeout during data\n"); break; }
-        if (ok < 0)   { DPRINT("read data error\n"); break; }
+        size_t need = 2 + (size_t)count * 4;
+        if (have < need) return true;       // rest of the frame not here yet
+        memcpy(words, p + 2, (size_t)count * 4);
+        awg_reader_consume(&c->rd, need);
 
         be32_to_host(words, count);
-        int r = awg_send_words32(words, count);
-        if (r != 0) DPRINT("awg_send_words32 ret=%d\n", r);
+        int r = queue_direct_frame(words, count);
+        if (r != 0) DPRINT("queue_direct_frame ret=%d\n", r);
+        __atomic_fetch_add(r == 0 ? &g_net.frames : &g_net.errors, 1, __ATOMIC_RELAXED);
     }
+}
 
-    close(fd);
-    return NULL;
+static void on_client(int fd, uint32_t events, void *ctx){
+    direct_client_t *c = (direct_client_t*)ctx;
+    for (;;) {
+        int n = awg_reader_fill_nb(&c->rd);
+        if (n == -3) break;                                   // drained the socket
+        if (n == 0 || n == -1) { client_close(fd, c); return; }
+        if (!drain_frames(c)) { client_close(fd, c); return; }
+    }
+    if (!drain_frames(c) || (events & (EPOLLERR | EPOLLHUP))) client_close(fd, c);
 }
 
-static void* accept_loop(void* arg){
-    (void)arg;
-    while (!g_stop_direct) {
-        struct sockaddr_in cli; socklen_t cl=sizeof(cli);
-        int fd = accept(g_listen, (struct sockaddr*)&cli, &cl);
+static void on_accept(int lfd, uint32_t events, void *ctx){
+    (void)events; (void)ctx;
+    for (;;) {
+        int fd = accept4(lfd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
         if (fd < 0) {
-            if (errno==EINTR) continue;
-            perror("[DIRECT] accept"); continue;
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) perror("[DIRECT] accept");
+            return;
         }
-        pthread_t th; pthread_create(&th, NULL, client_thread, (void*)(intptr_t)fd);
-        pthread_detach(th);
+        int one=1; setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &(int){SOCK_RCVBUF}, sizeof(int));
+
+        direct_client_t *c = calloc(1, sizeof(*c));
+        if (!c || awg_reader_init(&c->rd, fd, AWG_READER_DEFAULT_CAP, IO_TIMEOUT_MS) != 0 ||
+            awg_reactor_add(fd, EPOLLIN | EPOLLRDHUP, on_client, c) != 0) {
+            DPRINT("client setup failed\n");
+            if (c) { awg_reader_free(&c->rd); free(c); }
+            close(fd);
+            continue;
+        }
+        awg_reader_count(&c->rd, &g_rx);
+        __atomic_fetch_add(&g_net.connects, 1, __ATOMIC_RELAXED);
+        DPRINT("client fd=%d connected\n", fd);
     }
-    return NULL;
 }
 
 int start_direct_server(unsigned short port){
-    g_stop_direct = 0;
-    g_listen = socket(AF_INET, SOCK_STREAM, 0);
-    if (g_listen < 0) { perror("[DIRECT] socket"); return -1; }
-    int one=1;
-    setsockopt(g_listen, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    g_listen = awg_reactor_listen_tcp(port, 8);
+    if (g_listen < 0) return -1;
     setsockopt(g_listen, SOL_SOCKET, SO_RCVBUF, &(int){SOCK_RCVBUF}, sizeof(int));
-
-    struct sockaddr_in a; memset(&a,0,sizeof(a));
-    a.sin_family=AF_INET; a.sin_addr.s_addr=htonl(INADDR_ANY); a.sin_port=htons(port);
-    if (bind(g_listen,(struct sockaddr*)&a,sizeof(a))<0){ perror("[DIRECT] bind"); close(g_listen); return -2; }
-    if (listen(g_listen,8)<0){ perror("[DIRECT] listen"); close(g_listen); return -3; }
-
-    pthread_t acc; pthread_create(&acc, NULL, accept_loop, NULL);
-    pthread_detach(acc);
+    if (awg_reactor_add(g_listen, EPOLLIN, on_accept, NULL) != 0) {
+        close(g_listen); g_listen = -1; return -4;
+    }
     printf("[DIRECT] listening on %u (no-queue)\n", port);
     return 0;
 }
 
+// Reactor must be stopped already; open client sockets are released by
+// awg_reactor_close()/process exit.
 void stop_direct_server(void){
-    g_stop_direct = 1;
-    if (g_listen>=0){ close(g_listen); g_listen=-1; }
-}
\ No newline at end of file
+    if (g_listen>=0){ awg_reactor_del(g_listen); close(g_listen); g_listen=-1; }
+}
+
+void get_direct_server_stats(tcp_server_stats_t *st){
+    st->connects      = __atomic_load_n(&g_net.connects, __ATOMIC_RELAXED);
+    st->bytes_in      = __atomic_load_n(&g_rx.bytes,     __ATOMIC_RELAXED);
+    st->read_timeouts = 0;      // frames are parsed as they come, idle clients stay
+    st->frames        = __atomic_load_n(&g_net.frames,   __ATOMIC_RELAXED);
+    st->lists         = 0;
+    st->errors        = __atomic_load_n(&g_net.errors,   __ATOMIC_RELAXED);
+}
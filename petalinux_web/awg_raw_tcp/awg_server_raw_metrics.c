@@ -0,0 +1,228 @@
+// awg_server_raw_metrics.c — Live counters over HTTP (Prometheus text format).
+// GET anything on AWG_METRICS_PORT returns every counter of the servers and
+// the player as "awg_*" samples, then the connection is closed (HTTP/1.0).
+// Runs on the shared epoll reactor; the counters themselves are relaxed
+// atomics owned by their threads, so a scrape never blocks the player.
+// A client that has not sent its request headers within METRICS_IDLE_MS is
+// closed by a reactor timer, so a stuck scraper cannot hold a slot.
+//
+//   curl -s http://wavegenz7.local:9102/metrics
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "awg_core.h"
+#include "awg_reactor.h"
+#include "awg_server_raw_shared.h"
+
+#ifdef DEBUG
+  #define DPRINT(fmt, ...) printf("[METRICS] " fmt, ##__VA_ARGS__)
+#else
+  #define DPRINT(fmt, ...) do{}while(0)
+#endif
+
+#define METRICS_MAX_CLIENTS 4
+#define METRICS_REQ_MAX     2048      // request headers kept; the rest is not needed
+#define METRICS_REPLY_MAX   (16*1024)
+#define METRICS_IDLE_MS     2000      // request headers must be in by then
+#define METRICS_SWEEP_MS    500       // idle check period while a client is open
+
+typedef struct {
+    int      fd;
+    uint64_t since_ms;                // accept time (CLOCK_MONOTONIC)
+    size_t   len;
+    char     req[METRICS_REQ_MAX];
+} metrics_client_t;
+
+static int              g_listen = -1;
+static int              g_timer = -1;  // timerfd, armed while a client is open
+static metrics_client_t g_cli[METRICS_MAX_CLIENTS];
+static char             g_reply[METRICS_REPLY_MAX];   // reactor thread only
+static size_t           g_reply_len;
+
+static void put(const char *fmt, ...) {
+    if (g_reply_len >= sizeof(g_reply)) return;
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(g_reply + g_reply_len, sizeof(g_reply) - g_reply_len, fmt, ap);
+    va_end(ap);
+    if (n > 0) g_reply_len += (size_t)n;
+}
+
+// One sample; help/type only for the first sample of a metric family.
+static void metric(const char *name, const char *type, const char *help, const char *labels, uint64_t v) {
+    if (help) put("# HELP awg_%s %s\n# TYPE awg_%s %s\n", name, help, name, type);
+    put("awg_%s%s %llu\n", name, labels ? labels : "", (unsigned long long)v);
+}
+
+// One family over both TCP servers (samples of a family must stay together).
+#define PUT_TCP(name, help, field) do { \
+        metric(name, "counter", help, "{server=\"queue\"}", q.field); \
+        metric(name, "counter", NULL, "{server=\"direct\"}", d.field); \
+    } while (0)
+
+static uint64_t mono_ms(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000u + (uint64_t)t.tv_nsec / 1000000u;
+}
+
+static void build_reply(void) {
+    queue_player_stats_t p;  get_queue_player_stats(&p);
+    queue_player_hist_t  h;  get_queue_player_hist(&h);
+    tcp_server_stats_t   q;  get_queue_server_stats(&q);
+    tcp_server_stats_t   d;  get_direct_server_stats(&d);
+    udp_server_stats_t   u;  get_udp_server_stats(&u);
+    awg_burst_stats_t    b;  awg_get_burst_stats(&b);
+
+    g_reply_len = 0;
+    metric("player_ticks_total", "counter", "Player loop iterations.", NULL, p.ticks);
+    metric("player_frames_total", "counter", "Frames handed to the hardware.", NULL, p.frames);
+    metric("player_list_switches_total", "counter", "Lists taken from the ready queue.", NULL, p.list_switches);
+    metric("player_underruns_total", "counter", "Lists that ended with no next list ready.", NULL, p.underruns);
+    metric("player_overruns_total", "counter", "Late ticks by overrun policy.", "{policy=\"burst\"}", p.overrun_burst);
+    metric("player_overruns_total", "counter", NULL, "{policy=\"skip\"}", p.overrun_skip);
+    metric("player_overruns_total", "counter", NULL, "{policy=\"stretch\"}", p.overrun_stretch);
+    metric("player_skipped_frames_total", "counter", "Frames dropped by the skip policy.", NULL, p.skipped_frames);
+    metric("player_missed_ticks_total", "counter", "Ticks woken a full period or more late.", NULL, h.missed);
+    metric("player_override_frames_total", "counter", "Frames sent with port 9000 overrides merged.", NULL, p.override_frames);
+    metric("player_max_late_ns", "gauge", "Worst tick wakeup lateness.", NULL, h.max_late_ns);
+    metric("player_max_send_ns", "gauge", "Worst single frame burst duration.", NULL, h.max_send_ns);
+    metric("notify_coalesced_total", "counter", "Notify events merged because the queue was full.", NULL, p.notify_coalesced);
+    metric("queue_frames_queued_total", "counter", "Frames in lists handed to the player.", NULL, q.frames);
+    metric("queue_lists_queued_total", "counter", "Lists handed to the player.", NULL, q.lists);
+    metric("direct_frames_total", "counter", "Port 9000 frames applied or merged.", NULL, d.frames);
+    PUT_TCP("tcp_connections_total", "Accepted TCP connections.", connects);
+    PUT_TCP("tcp_received_bytes_total", "Bytes received from TCP clients.", bytes_in);
+    // Queue only: the direct port parses frames as they come and has no read timeout
+    metric("tcp_read_timeouts_total", "counter", "Command bodies that timed out (client dropped).",
+           "{server=\"queue\"}", q.read_timeouts);
+    PUT_TCP("tcp_errors_total", "Queue: clients dropped on a bad command. Direct: frames rejected.", errors);
+    metric("udp_datagrams_total", "counter", "UDP datagrams received.", NULL, u.datagrams);
+    metric("udp_dropped_total", "counter", "UDP datagrams dropped.", "{reason=\"length\"}", u.bad_len);
+    metric("udp_dropped_total", "counter", NULL, "{reason=\"hex\"}", u.bad_hex);
+    metric("udp_dropped_total", "counter", NULL, "{reason=\"kernel\"}", u.kernel_drops);
+    metric("udp_dropped_total", "counter", NULL, "{reason=\"apply\"}", u.apply_errors);
+    if (b.enabled)                                 // AWG_BURST_STATS=1 only
+        metric("burst_words_total", "counter", "Words strobed into the PL.", NULL, b.words);
+    for (int id = 0; id < g_list_count; ++id) {
+        char l[24];
+        snprintf(l, sizeof(l), "{list=\"%d\"}", id);
+        metric("list_status", "gauge", id == 0 ? "List state: 0 idle, 1 loading, 2 ready." : NULL, l,
+               (uint64_t)__atomic_load_n(&g_list_status[id], __ATOMIC_RELAXED));
+    }
+}
+
+static void timer_set(int ms) {
+    struct itimerspec it = { .it_interval = { 0, (long)ms * 1000000L },
+                             .it_value    = { 0, (long)ms * 1000000L } };
+    if (g_timer >= 0) timerfd_settime(g_timer, 0, &it, NULL);
+}
+
+static void client_close(metrics_client_t *c) {
+    awg_reactor_del(c->fd);
+    close(c->fd);
+    c->fd = -1;
+}
+
+// Close clients still without a full request after METRICS_IDLE_MS; stop
+// the timer once no client is left.
+static void on_timer(int fd, uint32_t events, void *ctx) {
+    (void)events; (void)ctx;
+    uint64_t ticks;
+    if (read(fd, &ticks, sizeof(ticks)) != sizeof(ticks)) { /* spurious */ }
+    uint64_t now = mono_ms();
+    int open = 0;
+    for (int i = 0; i < METRICS_MAX_CLIENTS; ++i) {
+        metrics_client_t *c = &g_cli[i];
+        if (c->fd < 0) continue;
+        if (now - c->since_ms >= METRICS_IDLE_MS) {
+            DPRINT("dropping idle scrape fd=%d\n", c->fd);
+            client_close(c);
+        } else {
+            open++;
+        }
+    }
+    if (!open) timer_set(0);
+}
+
+// Answer once the request headers are in (or the buffer is full). The reply
+// fits an empty socket buffer, a short send() just ends the scrape.
+static void on_client(int fd, uint32_t events, void *ctx) {
+    metrics_client_t *c = ctx;
+    while (c->len < sizeof(c->req) - 1 && !strstr(c->req, "\r\n\r\n") && !strstr(c->req, "\n\n")) {
+        ssize_t n = recv(fd, c->req + c->len, sizeof(c->req) - 1 - c->len, MSG_DONTWAIT);
+        if (n > 0) { c->len += (size_t)n; c->req[c->len] = '\0'; continue; }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) && !(events & (EPOLLHUP | EPOLLERR))) return;
+        break;                                     // closed early: answer what we got
+    }
+    if (c->len > 0) {
+        build_reply();
+        char hdr[128];
+        int hl = snprintf(hdr, sizeof(hdr), "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                                            "Content-Length: %zu\r\n\r\n", g_reply_len);
+        if (send(fd, hdr, (size_t)hl, MSG_NOSIGNAL | MSG_DONTWAIT) != hl ||
+            send(fd, g_reply, g_reply_len, MSG_NOSIGNAL | MSG_DONTWAIT) != (ssize_t)g_reply_len)
+            DPRINT("short reply to fd=%d\n", fd);
+    }
+    client_close(c);
+}
+
+static void on_accept(int lfd, uint32_t events, void *ctx) {
+    (void)events; (void)ctx;
+    for (;;) {
+        int fd = accept4(lfd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) DPRINT("accept() failed: %s\n", strerror(errno));
+            return;
+        }
+        metrics_client_t *c = NULL;
+        for (int i = 0; i < METRICS_MAX_CLIENTS && !c; ++i)
+            if (g_cli[i].fd < 0) c = &g_cli[i];
+        if (!c || awg_reactor_add(fd, EPOLLIN | EPOLLRDHUP, on_client, c) != 0) {
+            DPRINT("refusing scrape fd=%d\n", fd);
+            close(fd);
+            continue;
+        }
+        c->fd       = fd;
+        c->since_ms = mono_ms();
+        c->len      = 0;
+        c->req[0]   = '\0';
+        timer_set(METRICS_SWEEP_MS);
+    }
+}
+
+int start_metrics_server(unsigned short port) {
+    for (int i = 0; i < METRICS_MAX_CLIENTS; ++i) g_cli[i].fd = -1;
+    g_timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (g_timer < 0 || awg_reactor_add(g_timer, EPOLLIN, on_timer, NULL) != 0) {
+        DPRINT("idle timer failed: %s\n", strerror(errno));
+        if (g_timer >= 0) { close(g_timer); g_timer = -1; }
+        return -2;
+    }
+    g_listen = awg_reactor_listen_tcp(port, 4);
+    if (g_listen < 0) return -1;
+    if (awg_reactor_add(g_listen, EPOLLIN, on_accept, NULL) != 0) {
+        close(g_listen); g_listen = -1; return -4;
+    }
+    printf("[METRICS] listening on %u (GET /metrics)\n", port);
+    return 0;
+}
+
+// Reactor must be stopped already.
+void stop_metrics_server(void) {
+    for (int i = 0; i < METRICS_MAX_CLIENTS; ++i) if (g_cli[i].fd >= 0) client_close(&g_cli[i]);
+    if (g_listen >= 0) { awg_reactor_del(g_listen); close(g_listen); g_listen = -1; }
+    if (g_timer >= 0)  { awg_reactor_del(g_timer);  close(g_timer);  g_timer = -1; }
+}
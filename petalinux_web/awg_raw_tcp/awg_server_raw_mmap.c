@@ -4,15 +4,17 @@
 //   [4*COUNT] WORDS[] (each 32-bit, big-endian)
 // Server pushes exactly COUNT words to awg_send_words32(words, COUNT).
 //
-// Build (link with your mmap core):
-//   gcc -O2 -Wall -o w_server w_server.c awg_core_mmap.c
-//   // or if awg_core_mmap is a .so: gcc -O2 -Wall -o w_server w_server.c -L. -lawg_core_mmap
+// Build (link with the AWG core and its backends):
+//   gcc -O2 -pthread -Wall -o w_server awg_server_raw_mmap.c awg_sock_reader.c \
+//       awg_core.c awg_core_mmap.c awg_core_dma.c awg_core_sim.c awg_core_dt.c awg_hex_decode.c
+//   // or against the shared core (make -f Makefile.onboard lib):
+//   gcc -O2 -pthread -Wall -o w_server awg_server_raw_mmap.c awg_sock_reader.c -L. -lawg_core
+//   // libgpiod backend: add awg_core_libgpiod.c -DAWG_WITH_GPIOD -lgpiod
 //
 // Run (root needed for /dev/mem):
 //   sudo ./w_server 9000
 //
-// Debug prints on:
-//   gcc -O2 -Wall -DDEBUG -o w_server w_server.c awg_core_mmap.c
+// Debug prints on: add -DDEBUG to either line.
 
 #include <stdio.h>
 #include <stdint.h>
@@ -21,7 +23,6 @@
 #include <signal.h>
 #include <errno.h>
 #include <unistd.h>
-#include <poll.h>
 #include <time.h>
 #include <arpa/inet.h>
 #include <netinet/tcp.h>
@@ -29,6 +30,7 @@
 #include <sys/types.h>
 
 #include "awg_core.h"
+#include "awg_sock_reader.h"  // buffered reads: one large recv() feeds many frames
 
 // ---------- Debug macro ----------
 #ifdef DEBUG
@@ -52,57 +54,6 @@ static volatile int g_stop = 0;
 // Graceful stop on SIGINT/SIGTERM
 static void on_signal(int sig) { (void)sig; g_stop = 1; }
 
-// Get current time in milliseconds (monotonic)
-static int64_t now_ms(void) {
-    struct timespec ts;
-    clock_gettime(CLOCK_MONOTONIC, &ts);
-    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
-}
-
-// poll+recv until n bytes are read.
-// Return values: 1=ok, 0=peer closed, -2=timeout, -1=error (errno set).
-// If deadline_ms >= 0, use it as absolute deadline (whole-frame).
-// If deadline_ms < 0, use per-read timeout IO_TIMEOUT_MS.
-static int read_n_timeout(int fd, void *buf, size_t n, int64_t deadline_ms) {
-    uint8_t *p = (uint8_t*)buf;
-    size_t got = 0;
-
-    while (got < n) {
-        int timeout_ms;
-        if (deadline_ms >= 0) {
-            int64_t now = now_ms();
-            int64_t remain = deadline_ms - now;
-            if (remain <= 0) return -2; // frame deadline exceeded
-            timeout_ms = (remain > 1000*60) ? 1000*60 : (int)remain; // cap to 60s for safety
-        } else {
-            timeout_ms = IO_TIMEOUT_MS; // per-read timeout
-        }
-
-        struct pollfd pfd = { .fd = fd, .events = POLLIN };
-        int pr = poll(&pfd, 1, timeout_ms);
-        if (pr == 0)      return -2;          // timeout
-        if (pr < 0) {
-            if (errno == EINTR) continue;
-            return -1;                        // poll error
-        }
-        if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) {
-            return 0;                         // peer closed / error
-        }
-
-        ssize_t r = recv(fd, p + got, n - got, 0);
-        if (r == 0)     return 0;             // peer closed
-        if (r < 0) {
-            if (errno == EINTR) continue;
-            if (errno == EAGAIN || errno == EWOULDBLOCK) continue;
-            return -1;                        // recv error
-        }
-        got += (size_t)r;
-        // Note: in per-read mode, the next loop iteration has a fresh IO_TIMEOUT_MS.
-        // In frame-deadline mode, the timeout is derived from the fixed deadline.
-    }
-    return 1; // ok
-}
-
 // Convert big-endian 32-bit array in-place to host endian
 static void be32_to_host(uint32_t *w, int count) {
     for (int i = 0; i < count; ++i) w[i] = ntohl(w[i]);
@@ -156,12 +107,17 @@ int main(int argc, char **argv) {
 
         DPRINT("client connected\n");
 
+        awg_reader_t rd;
+        if (awg_reader_init(&rd, fd, AWG_READER_DEFAULT_CAP, IO_TIMEOUT_MS) != 0) {
+            perror("reader alloc"); close(fd); continue;
+        }
+
         for (;;) {
             // Establish a frame deadline if enabled
-            int64_t deadline = (FRAME_TIMEOUT_MS > 0) ? (now_ms() + FRAME_TIMEOUT_MS) : -1;
+            int64_t deadline = (FRAME_TIMEOUT_MS > 0) ? (awg_reader_now_ms() + FRAME_TIMEOUT_MS) : -1;
 
             // 1) Read 2-byte COUNT (big-endian)
-            int ok = read_n_timeout(fd, header, 2, deadline);
+            int ok = awg_reader_read(&rd, header, 2, deadline);
             if (ok == 0)  { DPRINT("peer closed\n"); break; }
             if (ok == -2) { DPRINT("timeout on count\n");    break; }
             if (ok < 0)   { perror("read count");            break; }
@@ -176,7 +132,7 @@ int main(int argc, char **argv) {
 
             // 2) Read payload: 4*COUNT bytes
             size_t need = (size_t)count * 4;
-            ok = read_n_timeout(fd, words, need, deadline);
+            ok = awg_reader_read(&rd, words, need, deadline);
             if (ok == 0)  { DPRINT("peer closed during data\n"); break; }
             if (ok == -2) { DPRINT("timeout during data\n");     break; }
             if (ok < 0)   { perror("read data");                 break; }
@@ -191,6 +147,7 @@ int main(int argc, char **argv) {
             // No ACK (lowest latency). Add a tiny ACK if you really need it.
         }
 
+        awg_reader_free(&rd);
         close(fd);
         DPRINT("client disconnected\n");
     }
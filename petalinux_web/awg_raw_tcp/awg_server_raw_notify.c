@@ -1,21 +1,30 @@
 // awg_server_raw_notify.c — MODIFIED FOR TIMESTAMP LOGGING
 // Notification server for precise, per-list AWG status updates.
+// Accept and peer-close detection run on the shared epoll reactor (awg_reactor.c).
+// [NEW] Producers (player, network thread) never send(): events go into a
+// lock-free queue and a drain thread writes them to the client, either as
+// the classic ASCII "LISTn:STATE\n" lines or, after the client sent 'B', as
+// 20-byte binary events (awg_server_raw_shared.h).
 
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <pthread.h>
+#include <poll.h>
 #include <stdbool.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <errno.h>
-#include <signal.h>
+#include <fcntl.h>
 #include <time.h>       // --- [NEW] --- For timestamp functions
 #include <sys/time.h>   // --- [NEW] --- For gettimeofday()
 
 #include "awg_server_raw_shared.h"
+#include "awg_reactor.h"
 
 // --- [MODIFIED] DPRINT macro to include a timestamp ---
 #ifdef DEBUG
@@ -37,113 +46,315 @@
   #define DPRINT(fmt, ...) do{}while(0)
 #endif
 
+#define NOTIFY_QUEUE_SIZE  256   // power of two; events are rare (list transitions)
+#define NOTIFY_SEND_MS     200   // SO_SNDTIMEO: a stuck client is dropped, not waited for
+#define NOTIFY_BATCH       64    // events per send()
+
+// --- [NEW] Bounded lock-free MPSC event queue (per-slot sequence numbers) ---
+// Producers claim a slot with a CAS on g_q_head; the drain thread is the only
+// consumer. slot.turn == pos: free for the producer of pos;
+// slot.turn == pos + 1: filled, ready for the consumer.
+typedef struct {
+    uint32_t turn;
+    uint8_t  type, list_id, status, flags;
+    uint32_t frame;
+    uint64_t t_ns;
+} notify_slot_t;
+
+static notify_slot_t g_q[NOTIFY_QUEUE_SIZE];
+static uint32_t      g_q_head = 0;     // next enqueue position (producers, CAS)
+static uint32_t      g_q_tail = 0;     // next dequeue position (drain thread only)
 
 // --- Module-specific global variables ---
-static volatile int g_stop_notify = 0;
 static int g_listen_notify = -1;
-static pthread_t g_accept_thread_notify;
-static bool g_accept_thread_running = false;
-static volatile int g_notify_fd = -1;
-static int g_last_sent_status[2] = { -1, -1 };
+static volatile int g_notify_fd = -1;        // owned by the reactor; g_notify_mutex guards swaps
+static int g_last_sent_status[AWG_MAX_LISTS]; // ASCII dedupe (drain thread)
+// [NEW] Fallback when the queue is full: latest status per list, sent by the
+// drain thread after the queue with NOTIFY_FLAG_COALESCED. While a list's bit
+// is set its later updates take this path too, so they stay in order.
+static int g_pending_status[AWG_MAX_LISTS];
+static uint32_t g_pending_mask = 0;
+
+static int        g_efd = -1;                // wakes the drain thread
+static pthread_t  g_drain_thread;
+static bool       g_drain_running = false;
+static volatile int g_drain_stop = 0;
+static int        g_binary = 0;              // client asked for binary events ('B')
+static int        g_resync = 0;              // new client / mode: send a snapshot first
+static uint32_t   g_tx_seq = 0;              // binary events sent on this connection
 
 // --- Shared global variables (defined in this file) ---
 pthread_mutex_t g_notify_mutex;
-volatile int g_list_status[2] = { LIST_IDLE, LIST_IDLE };
+volatile int g_list_status[AWG_MAX_LISTS];   // zero = LIST_IDLE
+int g_list_count = AWG_DEFAULT_LISTS;
+
+static inline uint64_t mono_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ull + (uint64_t)t.tv_nsec;
+}
+
+static inline bool valid_list_id(int list_id) {
+    return list_id >= 0 && list_id < g_list_count;
+}
+
+static inline void wake_drain(void) {
+    uint64_t one = 1;
+    if (g_efd >= 0 && write(g_efd, &one, sizeof(one)) != sizeof(one)) { /* counter full: already awake */ }
+}
+
+// Producer side, any thread. False if the queue is full.
+static bool queue_push(int type, int list_id, int status, uint32_t frame) {
+    uint32_t pos = __atomic_load_n(&g_q_head, __ATOMIC_RELAXED);
+    notify_slot_t *s;
+    for (;;) {
+        s = &g_q[pos & (NOTIFY_QUEUE_SIZE - 1)];
+        int32_t dif = (int32_t)(__atomic_load_n(&s->turn, __ATOMIC_ACQUIRE) - pos);
+        if (dif == 0) {
+            if (__atomic_compare_exchange_n(&g_q_head, &pos, pos + 1, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+        } else if (dif < 0) {
+            return false;                                        // full
+        } else {
+            pos = __atomic_load_n(&g_q_head, __ATOMIC_RELAXED);  // lost the race
+        }
+    }
+    s->type = (uint8_t)type; s->list_id = (uint8_t)list_id; s->status = (uint8_t)status;
+    s->flags = 0; s->frame = frame; s->t_ns = mono_ns();
+    __atomic_store_n(&s->turn, pos + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+// Consumer side, drain thread only.
+static bool queue_pop(notify_slot_t *out) {
+    notify_slot_t *s = &g_q[g_q_tail & (NOTIFY_QUEUE_SIZE - 1)];
+    if (__atomic_load_n(&s->turn, __ATOMIC_ACQUIRE) != g_q_tail + 1) return false;
+    *out = *s;
+    __atomic_store_n(&s->turn, g_q_tail + NOTIFY_QUEUE_SIZE, __ATOMIC_RELEASE);
+    g_q_tail++;
+    return true;
+}
+
+// --- [NEW] Public event entry point: never blocks, never sends ---
+bool post_list_event(int type, int list_id, int status, uint32_t frame) {
+    if (!valid_list_id(list_id)) return true;
+    if (type == NOTIFY_EV_STATUS) __atomic_store_n(&g_list_status[list_id], status, __ATOMIC_RELAXED);
+
+    uint32_t bit = 1u << list_id;
+    bool queued = !(__atomic_load_n(&g_pending_mask, __ATOMIC_ACQUIRE) & bit) &&
+                  queue_push(type, list_id, status, frame);
+    if (!queued && type == NOTIFY_EV_STATUS) {
+        __atomic_store_n(&g_pending_status[list_id], status, __ATOMIC_RELEASE);
+        __atomic_fetch_or(&g_pending_mask, bit, __ATOMIC_RELEASE);
+    }
+    wake_drain();
+    return queued;
+}
 
 // --- Public Function Implementation ---
 void send_status_update(int list_id) {
-    if (list_id < 0 || list_id > 1) return;
+    if (!valid_list_id(list_id)) return;
+    post_list_event(NOTIFY_EV_STATUS, list_id, g_list_status[list_id], 0);
+}
+
+// Set g_list_status[list_id] and notify (network / control threads).
+void update_list_status(int list_id, int status) {
+    post_list_event(NOTIFY_EV_STATUS, list_id, status, 0);
+}
+
+// [MODIFIED] Real-time player variant; same path, kept for the call sites.
+bool post_list_status(int list_id, int status) {
+    return post_list_event(NOTIFY_EV_STATUS, list_id, status, 0);
+}
+
+// --- [NEW] Drain thread: formats and sends, the only writer of g_notify_fd ---
+static size_t format_event(const notify_slot_t *e, bool binary, uint8_t *dst) {
+    if (binary) {
+        uint32_t seq   = htonl(g_tx_seq++);
+        uint32_t frame = htonl(e->frame);
+        uint32_t hi    = htonl((uint32_t)(e->t_ns >> 32));
+        uint32_t lo    = htonl((uint32_t)e->t_ns);
+        dst[0] = e->type; dst[1] = e->list_id; dst[2] = e->status; dst[3] = e->flags;
+        memcpy(dst + 4,  &seq,   4);
+        memcpy(dst + 8,  &frame, 4);
+        memcpy(dst + 12, &hi,    4);
+        memcpy(dst + 16, &lo,    4);
+        return NOTIFY_EVENT_BYTES;
+    }
+    // ASCII: status changes only, deduplicated like before
+    if (e->type != NOTIFY_EV_STATUS || e->status > LIST_READY) return 0;
+    if (g_last_sent_status[e->list_id] == e->status) return 0;
+    static const char *const status_strings[] = {"IDLE", "LOADING", "READY"};
+    g_last_sent_status[e->list_id] = e->status;
+    return (size_t)snprintf((char *)dst, 32, "LIST%d:%s\n", e->list_id, status_strings[e->status]);
+}
+
+// Send buf to the current client; on error/timeout hand it back to the
+// reactor (shutdown -> EPOLLHUP -> on_notify_client closes it).
+// [MODIFIED] The mutex only covers taking a dup() of g_notify_fd: send()
+// (up to NOTIFY_SEND_MS) runs unlocked, so the reactor's accept/close never
+// waits on a slow client, and the copy keeps the socket open (its number
+// cannot be reused) even if the reactor closes the client meanwhile.
+static void send_to_client(const uint8_t *buf, size_t len) {
+    if (len == 0) return;
     pthread_mutex_lock(&g_notify_mutex);
-    if (g_notify_fd >= 0) {
-        // This check remains the same
-        if (g_list_status[list_id] != g_last_sent_status[list_id]) {
-            const char* status_strings[] = {"IDLE", "LOADING", "READY"};
-            const char* status_str = status_strings[g_list_status[list_id]];
-            char buf[32];
-            // snprintf does not need timestamp, DPRINT will add it
-            snprintf(buf, sizeof(buf), "LIST%d:%s\n", list_id, status_str);
-            if (send(g_notify_fd, buf, strlen(buf), MSG_NOSIGNAL) < 0) {
-                // Manually add timestamp here for error logging if needed, or rely on perror
-                perror("send notification failed");
-                close(g_notify_fd);
-                g_notify_fd = -1;
-            } else {
-                // DPRINT will automatically add the timestamp
-                DPRINT("Sent notification: %s", buf); // buf already has a newline
-                g_last_sent_status[list_id] = g_list_status[list_id];
+    int fd = g_notify_fd >= 0 ? fcntl(g_notify_fd, F_DUPFD_CLOEXEC, 0) : -1;
+    pthread_mutex_unlock(&g_notify_mutex);
+    if (fd < 0) return;
+    if (send(fd, buf, len, MSG_NOSIGNAL) != (ssize_t)len) {
+        perror("send notification failed");
+        shutdown(fd, SHUT_RDWR);
+    } else {
+        DPRINT("Sent %zu notification bytes.\n", len);
+    }
+    close(fd);
+}
+
+static void *drain_thread(void *arg) {
+    (void)arg;
+    uint8_t buf[NOTIFY_BATCH * 32];
+    for (;;) {
+        struct pollfd pfd = { .fd = g_efd, .events = POLLIN };
+        if (poll(&pfd, 1, 100) > 0) {
+            uint64_t v;
+            if (read(g_efd, &v, sizeof(v)) != sizeof(v)) { /* spurious */ }
+        }
+        bool stop = g_drain_stop;   // one last pass after the stop request
+
+        bool binary = __atomic_load_n(&g_binary, __ATOMIC_ACQUIRE);
+        size_t len = 0;
+        notify_slot_t e;
+
+        // New client or mode switch: snapshot of every list first
+        if (__atomic_exchange_n(&g_resync, 0, __ATOMIC_ACQ_REL)) {
+            g_tx_seq = 0;
+            for (int i = 0; i < AWG_MAX_LISTS; ++i) g_last_sent_status[i] = -1;
+            for (int i = 0; i < g_list_count; ++i) {
+                e = (notify_slot_t){ .type = NOTIFY_EV_STATUS, .list_id = (uint8_t)i,
+                                     .status = (uint8_t)__atomic_load_n(&g_list_status[i], __ATOMIC_RELAXED),
+                                     .t_ns = mono_ns() };
+                len += format_event(&e, binary, buf + len);
+                if (len > sizeof(buf) - 32) { send_to_client(buf, len); len = 0; }
             }
         }
+        while (queue_pop(&e)) {
+            len += format_event(&e, binary, buf + len);
+            if (len > sizeof(buf) - 32) { send_to_client(buf, len); len = 0; }
+        }
+        // Overflow path after the queue, so older queued events go first
+        uint32_t mask = __atomic_exchange_n(&g_pending_mask, 0, __ATOMIC_ACQ_REL);
+        while (mask) {
+            int i = __builtin_ctz(mask);
+            mask &= mask - 1;
+            e = (notify_slot_t){ .type = NOTIFY_EV_STATUS, .list_id = (uint8_t)i,
+                                 .status = (uint8_t)__atomic_load_n(&g_pending_status[i], __ATOMIC_ACQUIRE),
+                                 .flags = NOTIFY_FLAG_COALESCED, .t_ns = mono_ns() };
+            len += format_event(&e, binary, buf + len);
+            if (len > sizeof(buf) - 32) { send_to_client(buf, len); len = 0; }
+        }
+        send_to_client(buf, len);
+        if (stop) break;
     }
+    return NULL;
+}
+
+// --- Internal Logic (reactor thread) ---
+// [MODIFIED] The client only ever sends 'B' (switch to binary events);
+// anything else is dropped, and readable-with-EOF means closed.
+static void on_notify_client(int fd, uint32_t events, void* ctx) {
+    (void)ctx;
+    char junk[64];
+    ssize_t r = recv(fd, junk, sizeof(junk), MSG_DONTWAIT);
+    if (r > 0 && memchr(junk, 'B', (size_t)r)) {
+        DPRINT("Notification client fd=%d switched to binary events.\n", fd);
+        __atomic_store_n(&g_binary, 1, __ATOMIC_RELEASE);
+        __atomic_store_n(&g_resync, 1, __ATOMIC_RELEASE);
+        wake_drain();
+    }
+    if (r > 0 && !(events & (EPOLLHUP | EPOLLERR | EPOLLRDHUP))) return;
+    if (r < 0 && (errno == EAGAIN || errno == EINTR) && !(events & (EPOLLHUP | EPOLLERR | EPOLLRDHUP))) return;
+
+    DPRINT("Notification client disconnected (fd=%d)\n", fd);
+    awg_reactor_del(fd);
+    pthread_mutex_lock(&g_notify_mutex);
+    if (g_notify_fd == fd) g_notify_fd = -1;
+    close(fd);
     pthread_mutex_unlock(&g_notify_mutex);
 }
 
-// --- Internal Logic ---
-static void* accept_loop_notify(void* arg) {
-    (void)arg;
-    while (!g_stop_notify) {
-        int fd = accept(g_listen_notify, NULL, NULL);
+static void on_notify_accept(int lfd, uint32_t events, void* ctx) {
+    (void)events; (void)ctx;
+    for (;;) {
+        int fd = accept4(lfd, NULL, NULL, SOCK_CLOEXEC);  // sends stay blocking
         if (fd < 0) {
-            if (g_stop_notify) break;
             if (errno == EINTR) continue;
-            perror("[NOTIFY] accept"); continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) perror("[NOTIFY] accept");
+            return;
         }
         DPRINT("Notification client connected (fd=%d)\n", fd);
+        struct timeval tv = { 0, NOTIFY_SEND_MS * 1000 };
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
         pthread_mutex_lock(&g_notify_mutex);
-        if (g_notify_fd >= 0) close(g_notify_fd);
+        if (g_notify_fd >= 0) { awg_reactor_del(g_notify_fd); close(g_notify_fd); }
         g_notify_fd = fd;
-        g_last_sent_status[0] = -1; g_last_sent_status[1] = -1;
         pthread_mutex_unlock(&g_notify_mutex);
-        // Trigger sending initial status for both lists
-        send_status_update(0);
-        send_status_update(1);
+        awg_reactor_add(fd, EPOLLIN | EPOLLRDHUP, on_notify_client, NULL);
+        // Initial status for every list in use, sent by the drain thread
+        __atomic_store_n(&g_binary, 0, __ATOMIC_RELEASE);
+        __atomic_store_n(&g_resync, 1, __ATOMIC_RELEASE);
+        wake_drain();
     }
-    DPRINT("Accept loop thread exiting.\n");
-    return NULL;
 }
 
 int start_notify_server(unsigned short port) {
-    g_stop_notify = 0;
     pthread_mutex_init(&g_notify_mutex, NULL);
-    g_listen_notify = socket(AF_INET, SOCK_STREAM, 0);
-    if (g_listen_notify < 0) { perror("[NOTIFY] socket"); return -1; }
-    int one=1;
-    setsockopt(g_listen_notify, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
-    struct sockaddr_in addr={0};
-    addr.sin_family = AF_INET; addr.sin_addr.s_addr = htonl(INADDR_ANY); addr.sin_port = htons(port);
-    if (bind(g_listen_notify, (struct sockaddr*)&addr, sizeof(addr)) < 0) { perror("[NOTIFY] bind"); close(g_listen_notify); return -2; }
-    if (listen(g_listen_notify, 1) < 0) { perror("[NOTIFY] listen"); close(g_listen_notify); return -3; }
-    if (pthread_create(&g_accept_thread_notify, NULL, accept_loop_notify, NULL) != 0) {
-        perror("[NOTIFY] pthread_create"); close(g_listen_notify); return -4;
+    for (uint32_t i = 0; i < NOTIFY_QUEUE_SIZE; ++i) g_q[i].turn = i;
+    g_q_head = g_q_tail = 0;
+
+    g_efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (g_efd < 0) { perror("[NOTIFY] eventfd"); return -2; }
+    g_drain_stop = 0;
+    if (pthread_create(&g_drain_thread, NULL, drain_thread, NULL) != 0) {
+        perror("[NOTIFY] drain thread");
+        close(g_efd); g_efd = -1;
+        return -3;
+    }
+    g_drain_running = true;
+
+    g_listen_notify = awg_reactor_listen_tcp(port, 1);
+    if (g_listen_notify < 0) return -1;
+    if (awg_reactor_add(g_listen_notify, EPOLLIN, on_notify_accept, NULL) != 0) {
+        close(g_listen_notify); g_listen_notify = -1; return -4;
     }
-    g_accept_thread_running = true;
     return 0;
 }
 
+// Reactor must be stopped already.
 void stop_notify_server(void) {
     DPRINT("Stopping notification server...\n");
-    g_stop_notify = 1;
 
-    // Use a dummy signal to interrupt the blocking accept() call
-    if (g_accept_thread_running) { 
-        pthread_kill(g_accept_thread_notify, SIGUSR1); 
+    if (g_listen_notify >= 0) {
+        awg_reactor_del(g_listen_notify);
+        close(g_listen_notify);
+        g_listen_notify = -1;
     }
 
-    if (g_listen_notify >= 0) { 
-        close(g_listen_notify); 
-        g_listen_notify = -1; 
+    // Drain what the queue server posted while stopping, then end the thread
+    if (g_drain_running) {
+        g_drain_stop = 1;
+        wake_drain();
+        pthread_join(g_drain_thread, NULL);
+        g_drain_running = false;
     }
+    if (g_efd >= 0) { close(g_efd); g_efd = -1; }
 
     pthread_mutex_lock(&g_notify_mutex);
-    if (g_notify_fd >= 0) { 
-        shutdown(g_notify_fd, SHUT_RDWR); 
-        close(g_notify_fd); 
-        g_notify_fd = -1; 
+    if (g_notify_fd >= 0) {
+        awg_reactor_del(g_notify_fd);
+        shutdown(g_notify_fd, SHUT_RDWR);
+        close(g_notify_fd);
+        g_notify_fd = -1;
     }
     pthread_mutex_unlock(&g_notify_mutex);
-
-    if (g_accept_thread_running) { 
-        pthread_join(g_accept_thread_notify, NULL); 
-        g_accept_thread_running = false; 
-    }
     DPRINT("Notification server stopped.\n");
-}
\ No newline at end of file
+}
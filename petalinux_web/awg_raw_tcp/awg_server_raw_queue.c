@@ -6,9 +6,8 @@
 #include <arpa/inet.h>
 #include <errno.h>
 #include <netinet/tcp.h>
-#include <poll.h>
 #include <pthread.h>
-#include <signal.h>
+#include <poll.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
@@ -19,8 +18,15 @@
 #include <time.h>
 #include <unistd.h>
 #include <sys/time.h> // --- [MODIFIED] --- For gettimeofday()
+#include <sys/prctl.h>
+#include <sys/eventfd.h>
 
 #include "awg_core.h"
+#include "awg_sock_reader.h"
+#include "awg_rt.h"
+#include "awg_reactor.h"
+#include "awg_list_file.h"
+#include "awg_shm_ingest.h"
 #include "awg_server_raw_shared.h"
 
 // --- [MODIFIED] DPRINT macro to include a timestamp ---
@@ -77,267 +83,1160 @@ static void print_hex_dump(const char *desc, const void *addr, int len) {
 #endif
 
 
-// --- [NEW] Word packing macros and zero-gain frame definition ---
+// --- [NEW] Word packing macros (tone bit 3 in [23], see awg_make_cfg_word) ---
 #define PACK_WORD(cmd, ch, tone, data20) \
     (((uint32_t)(cmd) & 0xF) << 28 | ((uint32_t)(ch) & 1) << 27 | \
-     ((uint32_t)(tone) & 0x7) << 24 | ((uint32_t)(data20) & 0xFFFFF))
+     ((uint32_t)(tone) & 0x7) << 24 | (((uint32_t)(tone) >> 3) & 1) << 23 | ((uint32_t)(data20) & 0xFFFFF))
 
 #define MAKE_INDEX_WORD(ch, tone, idx20) PACK_WORD(0x1, ch, tone, idx20)
 #define MAKE_GAIN_WORD(ch, tone, g20)    PACK_WORD(0x2, ch, tone, g20)
 #define MAKE_COMMIT_WORD()               PACK_WORD(0xF, 0, 0, 0)
 
-// --- [MODIFIED] A frame that sets gain to zero for ALL tones (0-7) and BOTH channels (0-1) ---
-// This is the ultimate "clear" frame that silences everything.
-static const uint32_t ZERO_GAIN_FRAME[] = {
-    // --- Channel 0 ---
-    MAKE_INDEX_WORD(0, 0, 0), MAKE_GAIN_WORD(0, 0, 0), // Tone 0
-    MAKE_INDEX_WORD(0, 1, 0), MAKE_GAIN_WORD(0, 1, 0), // Tone 1
-    MAKE_INDEX_WORD(0, 2, 0), MAKE_GAIN_WORD(0, 2, 0), // Tone 2
-    MAKE_INDEX_WORD(0, 3, 0), MAKE_GAIN_WORD(0, 3, 0), // Tone 3
-    MAKE_INDEX_WORD(0, 4, 0), MAKE_GAIN_WORD(0, 4, 0), // Tone 4
-    MAKE_INDEX_WORD(0, 5, 0), MAKE_GAIN_WORD(0, 5, 0), // Tone 5
-    MAKE_INDEX_WORD(0, 6, 0), MAKE_GAIN_WORD(0, 6, 0), // Tone 6
-    MAKE_INDEX_WORD(0, 7, 0), MAKE_GAIN_WORD(0, 7, 0), // Tone 7
-
-    // --- Channel 1 ---
-    MAKE_INDEX_WORD(1, 0, 0), MAKE_GAIN_WORD(1, 0, 0), // Tone 0
-    MAKE_INDEX_WORD(1, 1, 0), MAKE_GAIN_WORD(1, 1, 0), // Tone 1
-    MAKE_INDEX_WORD(1, 2, 0), MAKE_GAIN_WORD(1, 2, 0), // Tone 2
-    MAKE_INDEX_WORD(1, 3, 0), MAKE_GAIN_WORD(1, 3, 0), // Tone 3
-    MAKE_INDEX_WORD(1, 4, 0), MAKE_GAIN_WORD(1, 4, 0), // Tone 4
-    MAKE_INDEX_WORD(1, 5, 0), MAKE_GAIN_WORD(1, 5, 0), // Tone 5
-    MAKE_INDEX_WORD(1, 6, 0), MAKE_GAIN_WORD(1, 6, 0), // Tone 6
-    MAKE_INDEX_WORD(1, 7, 0), MAKE_GAIN_WORD(1, 7, 0), // Tone 7
-
-    // Commit all the above settings (16 tones across 2 channels) in one go
-    MAKE_COMMIT_WORD()
-};
-
-static const uint16_t ZERO_GAIN_FRAME_COUNT = sizeof(ZERO_GAIN_FRAME) / sizeof(uint32_t);
+// --- [MODIFIED] A frame that sets index and gain to zero for ALL tones of
+// BOTH channels, then commits: the "clear" frame that silences everything.
+// Built for the tone count of the PL (33 words, 65 with 16 tones).
+static uint16_t zero_gain_frame(uint32_t *w) {
+    uint16_t n = 0;
+    for (int ch = 0; ch < 2; ++ch) {
+        for (int tone = 0; tone < awg_tones(); ++tone) {
+            w[n++] = MAKE_INDEX_WORD(ch, tone, 0);
+            w[n++] = MAKE_GAIN_WORD(ch, tone, 0);
+        }
+    }
+    w[n++] = MAKE_COMMIT_WORD();
+    return n;
+}
 
 // Number of silent frames to send to ensure PL buffer is flushed
 #define SHUTDOWN_FLUSH_FRAMES 100
 #define IO_TIMEOUT_MS       5000
-#define MAX_WORDS_PER_FRAME 64
-#define GROW_WORDS_STEP     4096
+#define WAIT_SAFETY_MS      100       // [NEW] re-check period of eventfd waits (never needed normally)
+#define MAX_WORDS_PER_FRAME AWG_FRAME_WORDS_MAX // [MODIFIED] a full 16-tone frame (65)
+#define MAX_LIST_FRAMES     2000000   // BEGIN / INGEST / GENERATE frame count limit
+#define MIN_PERIOD_US       10        // [NEW] SET_PERIOD / per-list period limits
+#define MAX_PERIOD_US       10000000
+#define SHM_DEFAULT_SLOT_WORDS (1u << 20) // [NEW] 4 MiB ingest slots (AWG_SHM_SLOT_WORDS)
+#define QUEUE_WAKEUP_BYTES  (256*1024) // [NEW] socket bytes one client may feed per wakeup
+#define DIRECT_SPIN_LIMIT   1000      // [NEW] busy-polls of a direct burst before sleeping
+#define DIRECT_WAIT_NS      20000     // [NEW] then re-check this often
+#define DMA_HDR_WORDS       2         // [NEW] TRIG + DWELL words ahead of each DMA slice
+#define DMA_SIDE_WORDS      (1 + AWG_RESET_WORDS_MAX) // [NEW] DWELL + one side write, end of the CMA buffer
+#define SIDE_RING_SIZE      16        // [NEW] queued side writes (power of two)
+
+// [NEW] Armed start ('A'): the next list the player starts waits for a
+// CLOCK_REALTIME instant (PTP-disciplined via phc2sys on multi-board rigs)
+#define START_TRIG          0x1u      // PL gate holds frame 0's COMMIT for the shared trigger
+#define START_LEAD          0x2u      // this board drives the trigger line at the start time
+#define START_MAX_AHEAD_S   3600      // start times further ahead are rejected
+#define START_EARLY_US      1000      // followers arm this long before the start time
+#define START_TRIG_WINDOW_US 10000    // gate timeout after the start time (trigger never came)
+#define START_TRIG_FIFO_FRAMES 2      // GPIO path: frames the PL command FIFO holds behind a held frame 0
+
+// [NEW] What the GPIO player does when it wakes a full period (or more) late
+enum overrun_policy {
+    OVERRUN_BURST,    // send the missed frames back-to-back until on time again
+    OVERRUN_SKIP,     // drop the missed frames, stay on the original time grid
+    OVERRUN_STRETCH   // play every frame, shift the time grid to now
+};
+// [NEW] Arena sizing when BEGIN carries no words total: one full frame
+// (INDEX+GAIN per tone, both channels + COMMIT). Underestimates grow by doubling.
+#define ARENA_WORDS_PER_FRAME_HINT ((uint32_t)(4 * awg_tones() + 1))
+// The hint is only reserved (and prefaulted) up front to this many words
+// (16 MiB); a longer list grows on demand like an under-sized one.
+#define ARENA_UPFRONT_WORDS_MAX (1u << 22)
 
 // --- Data models & Types ---
+// List ownership (one writer per transition, no mutex):
+//   LIST_IDLE / LIST_LOADING : the network thread owns the list data
+//   LIST_READY               : published through G.ready ring; the player owns
+//                              the list until it stores LIST_IDLE again
+// "state" is only accessed with __atomic builtins (release on hand-over,
+// acquire on take-over), so the list contents travel with the ownership.
+// --- [NEW] Delta frame expansion state (network thread, while LOADING) ---
+// [MODIFIED] Tone slot t = ch*AWG_MAX_TONES + tone (bits 0..15 channel A,
+// 16..31 channel B; 'D' masks are widened to this on read). The PL keeps two banks (cfg_pingpong_idx_gain_2x8)
+// and writes always land in the shadow bank, which still holds the frame
+// before the previous one. A delta frame therefore re-writes every slot that
+// changed in this frame or in the previous one; the first two frames of a
+// list (and the two after any raw frame) are written in full, one per bank.
+#define DELTA_SLOTS (2 * AWG_MAX_TONES)
+
+// Slot an INDEX/GAIN word addresses (tone bit 3 at [23], see awg_core.h)
+static inline uint32_t word_slot(uint32_t w) {
+    return ((w >> 27) & 1u) * AWG_MAX_TONES + (((w >> 24) & 7u) | ((w >> 20) & 8u));
+}
+
+typedef struct {
+  uint32_t  idx[DELTA_SLOTS];   // current value per slot (20-bit data)
+  uint32_t  gain[DELTA_SLOTS];
+  uint32_t  prev_idx_mask;      // slots changed by the previous frame
+  uint32_t  prev_gain_mask;
+  uint8_t   full_left;          // frames still to be written in full
+} delta_state_t;
+
+// --- [NEW] Generated lists ('F'): one ramp per slot for INDEX and GAIN ---
+// value(i) = start + i*step (step in 1/65536 LSB per frame), held at stop.
+// Slots without a ramp play 0, so every frame writes every tone (both banks
+// stay consistent, as with full 33-word frames).
+#define GEN_STEP_SHIFT 16
+
+typedef struct {
+  uint32_t  start;
+  uint32_t  stop;
+  int32_t   step;
+} gen_ramp_t;
+
+typedef struct {
+  gen_ramp_t idx[DELTA_SLOTS];
+  gen_ramp_t gain[DELTA_SLOTS];
+} gen_desc_t;
+
+// The starts/words buffers form a per-list arena: sized at BEGIN, kept
+// across list cycles and only freed when the server stops.
+// [MODIFIED] Compact frame index: while every frame has the same number of
+// words (the usual 33-word frame) frame i is simply words[i*frame_words ..]
+// and there is no per-frame metadata at all. The first frame of a different
+// size switches the list to a prefix-sum table starts[0..frames], frame i =
+// words[starts[i] .. starts[i+1]) — 4 bytes per frame in one array instead
+// of separate offsets[]/counts[].
 typedef struct {
-  uint32_t *offsets;
-  uint16_t *counts;
+  uint16_t  frame_words;    // [NEW] >0: fixed frame size, starts[] unused
+  uint32_t *starts;         // [NEW] prefix sums, frames+1 entries (variable frames only)
+  uint32_t  starts_cap;     // [NEW] arena capacity of starts[] (entries)
   uint32_t  total_frames;
   uint32_t  loaded_frames;
-  bool      ready;
+  int       state;
   uint32_t *words;
-  uint32_t  words_cap;
+  uint32_t  words_cap;      // arena capacity of words[]
   uint32_t  words_used;
+  bool      words_external; // words[] is a fixed slice of the DMA CMA buffer (never freed)
+  uint32_t  repeat;         // [NEW] passes to play: 1 = once, 0 = loop until changed ('R')
+  delta_state_t delta;      // [NEW] 'D' frame expansion
+  bool      has_delta;      // [NEW] list holds delta frames: never skip frames
+  uint32_t  period_us;      // [NEW] frame period for this list, 0 = global G.period_us
+  awg_list_file_t file;     // [NEW] 'L' LOAD: starts (and words, GPIO) map this file
+  uint32_t *arena_starts;   // [NEW] arena parked while a file is attached
+  uint32_t *arena_words;    //       (words: also while an ingest slot is attached)
+  bool      shm_attached;   // [NEW] 'I' ingest: words[] is shm slot shm_slot
+  uint32_t  shm_slot;
+  bool      has_gen;        // [NEW] 'F': frames come from gen, synthesized by the GPIO player
+  gen_desc_t gen;
 } awg_list_t;
 
+// --- [NEW] Direct-port overrides (port 9000 while the GPIO player is busy) ---
+// Sticky INDEX/GAIN values per delta slot (ch*AWG_MAX_TONES + tone), merged
+// into every frame the player emits, ahead of its COMMIT, so they hold in
+// both banks. Written by the reactor thread only, published to the player
+// with a sequence lock (odd = being written); the player keeps its own copy
+// and picks up a new set with its next frame, or keeps the old one for a
+// frame if it caught the writer mid-update.
+typedef struct {
+  uint32_t  idx[DELTA_SLOTS];
+  uint32_t  gain[DELTA_SLOTS];
+  uint32_t  idx_mask;
+  uint32_t  gain_mask;
+} override_set_t;
+
+// --- [NEW] Single-producer/single-consumer ring of READY list ids ---
+// Producer: network thread (publish). Consumer: player thread (take).
+#define READY_RING_SIZE 64  // power of two, >= AWG_MAX_LISTS (each list queued at most once)
+
+typedef struct {
+  uint8_t  ids[READY_RING_SIZE];
+  uint32_t head;            // next slot to write, stored by the producer only
+  uint32_t tail;            // next slot to read,  stored by the consumer only
+} spsc_ring_t;
+
+// [NEW] DMA backend: a write that is not a list (RESET's zero burst) still
+// has to reach the PL through the DMA, the only input of the waveform core
+// in that block design. Queued under g_direct_mu, sent by the DMA player
+// between lists from the CMA buffer's last DMA_SIDE_WORDS.
+typedef struct {
+  uint16_t count;
+  uint32_t words[AWG_RESET_WORDS_MAX];
+} side_write_t;
+
 typedef struct {
-  pthread_mutex_t mtx;
   pthread_t       player_thread_h;
   bool            player_thread_running;
-  awg_list_t      list[2];
-  bool            playing;
-  int             cur_list;
-  uint32_t        cur_frame;
-  int             next_list;
-  uint32_t        period_us;
+  awg_list_t      list[AWG_MAX_LISTS];
+  int             n_lists;        // [NEW] queue depth in use (AWG_QUEUE_DEPTH)
+  spsc_ring_t     ready;          // [NEW] network -> player hand-off
+  uint32_t        flush_req;      // [NEW] bumped by control side: drop everything
+  uint32_t        flush_ack;      // [NEW] player copies flush_req once done
+  int             cur_list;       // player-owned: list on air, -1 = none
+  int             prev_list;      // [NEW] player-owned: list handed back at the last tick, -1 = none
+  uint32_t        cur_frame;      // player-owned
+  uint32_t        cur_pass;       // [NEW] player-owned: completed passes of cur_list
+  uint32_t        period_us;      // atomic load in the player ('T')
+  int             overrun;        // [NEW] enum overrun_policy, atomic load in the player ('O')
+  bool            reset_flush;    // [NEW] AWG_RESET=flush: zero the PL by playing 2x SHUTDOWN_FLUSH_FRAMES
+  bool            use_dma;        // [NEW] lists are streamed by AXI DMA (awg_core_dma.c)
+  uint32_t       *dma_words;      // [NEW] CMA buffer, split in n_lists equal slices
+  uint32_t        dma_slice_words;
+  uint32_t       *dma_side;       // [NEW] DMA_SIDE_WORDS after the last slice
+  side_write_t    side[SIDE_RING_SIZE]; // [NEW] side writes for the DMA player
+  uint32_t        side_head;      // [NEW] next to queue (g_direct_mu)
+  uint32_t        side_tail;      // [NEW] next to send; stored by the player once sent
+  bool            use_seq;        // [NEW] PL frame sequencer fires COMMITs (frame_sequencer_axis.v)
+  uint32_t        seq_frame_base; // [NEW] sequencer frame_cnt when the current list was armed
+  queue_player_stats_t stats;     // [NEW] written by the player only (relaxed atomics)
+  queue_player_hist_t  hist;      // [NEW] same, tick timing histograms
+  uint32_t        hist_reset_req; // [NEW] bumped by 'Q' with reset flag, applied by the player
+  uint32_t        hist_reset_ack;
+  uint64_t        last_send_ns;   // [NEW] player-owned: start of the previous frame burst
+  int             done_efd;       // [NEW] player -> control: a list went IDLE / flush acknowledged
+  int             wake_efd;       // [NEW] control -> DMA player: flush, new list or stop
+  uint64_t        start_rt_ns;    // [NEW] 'A': CLOCK_REALTIME start of the next list, 0 = none
+  uint32_t        start_mode;     // [NEW] 'A': START_* flags, stored before start_rt_ns
+  int             playing;        // [NEW] player has a list: port 9000 goes through ovr (DMA: rejected)
+  int             direct_busy;    // [NEW] reactor is bursting a port-9000 frame itself
+  uint32_t        ovr_epoch;      // [NEW] bumped by the player when it goes idle (drops overrides)
+  uint32_t        ovr_seq;        // [NEW] sequence lock of ovr
+  override_set_t  ovr;            // [NEW] published override set
+  override_set_t  ovr_cur;        // [NEW] player-owned copy
+  uint32_t        ovr_seen;       // [NEW] player-owned: ovr_seq of ovr_cur
+  uint32_t        own_idx[DELTA_SLOTS];  // [NEW] player-owned: last INDEX/GAIN the lists
+  uint32_t        own_gain[DELTA_SLOTS]; //       themselves wrote per slot since playing began
+  uint32_t        own_idx_mask, own_gain_mask;
+  uint32_t        rel_idx_mask, rel_gain_mask; // [NEW] released overrides: rewrite own values
+  uint8_t         rel_left;       // [NEW] frames left to do so (one per bank)
+  uint32_t        gen_buf[MAX_WORDS_PER_FRAME]; // [NEW] player-owned: frame of a generated list
 } awg_srv_t;
 
 // --- Global state for this module ---
 static awg_srv_t G;
-static volatile int g_stop_queue = 0;
+static override_set_t g_ovr_master;      // [NEW] working set, under g_direct_mu
+static uint32_t       g_ovr_epoch;       // [NEW] G.ovr_epoch g_ovr_master belongs to
+static pthread_mutex_t g_direct_mu = PTHREAD_MUTEX_INITIALIZER; // [NEW] port 9000 (reactor) vs UDP thread
+static volatile int g_stop_player = 0;   // player outlives the network side for the final flush
 static int g_listen_queue = -1;
-static pthread_t g_accept_thread_queue;
-static bool g_accept_thread_running = false;
-static volatile int g_active_client_fd = -1;
-static volatile bool g_loading_in_progress[2] = { false, false };
+
+// [MODIFIED] Several clients at once (reactor thread only). One OWNER drives
+// the lists; OBSERVERs may only query ('Q' 'G' 'l' 'C') and are served
+// complete commands only, so they cannot delay the owner or the player.
+// [MODIFIED] No reply waits for socket space: what the socket does not take
+// is queued in the session (QUEUE_OUT_MAX) and sent on EPOLLOUT. A new client is unassigned until it sends 'C' or an
+// owner command; the latter makes it the owner and, as a single client always
+// did, replaces an existing owner (a restarted uploader wins).
+#define QUEUE_MAX_CLIENTS 8
+#define LIBRARY_LIST_MAX  64      // 'l' reply entries
+#define QUEUE_OUT_MAX     (16*1024) // [NEW] unsent reply bytes a session may hold
+
+enum queue_role { ROLE_NONE, ROLE_OBSERVER, ROLE_OWNER };
+
+// [NEW] Body of an 'M' / 'D' / 'd' still arriving (see bulk_step()).
+typedef struct {
+    uint8_t  op;                  // 0 = none
+    uint8_t  list_id;
+    uint32_t frames;              // frames in the command
+    uint32_t done;                // M: counts indexed; D/d: frames pushed
+    uint32_t pos;                 // M: words_used once the indexed frames are in
+    size_t   bytes;               // M: payload bytes in the arena so far
+    uint32_t swapped;             // M: payload words byte-swapped so far
+} bulk_state_t;
+
+typedef struct {
+    int          fd;              // -1 = free slot
+    int          role;
+    bool         paused;          // [NEW] not read while control work runs (ctl_must_wait())
+    bool         lib_wait;        // [NEW] 'l' sent, listing not read yet (library_finish())
+    uint32_t     events;          // [NEW] epoll mask registered for fd
+    awg_reader_t rd;
+    bulk_state_t bulk;
+    size_t       out_len;         // [NEW] replies not taken by the socket yet
+    uint8_t      out[QUEUE_OUT_MAX];
+} queue_session_t;
+
+static queue_session_t  g_sess[QUEUE_MAX_CLIENTS];
+static tcp_server_stats_t    g_net;    // [NEW] connects/frames/lists/errors (reactor thread)
+static awg_reader_counters_t g_rx;     // [NEW] bytes and read timeouts of every session
+static queue_session_t *g_owner = NULL;
 
 // --- Forward declarations for static functions ---
-static bool prepare_list_for_preload(awg_list_t *L, uint32_t total_frames);
+static bool prepare_list_for_preload(awg_list_t *L, uint32_t total_frames, uint32_t total_words);
 static void start_player_if_needed();
 
 // --- Implementation ---
-static void dummy_signal_handler(int sig) { (void)sig; }
-
-static int read_n_timeout(int fd, void *buf, size_t n, int timeout_ms){
-  uint8_t *p = (uint8_t*)buf;
-  size_t got = 0;
-  while(got < n){
-    struct pollfd pfd = {.fd=fd,.events=POLLIN};
-    int pr = poll(&pfd,1,timeout_ms);
-    if (pr==0) { 
-        DPRINT("read_n_timeout: timed out after %d ms\n", timeout_ms);
-        return -2; // Timeout
-    }
-    if (pr<0){ if(errno==EINTR) continue; return -1; }
-    if (pfd.revents & (POLLERR|POLLHUP|POLLNVAL)) return 0;
-    ssize_t r = recv(fd, p+got, n-got, 0);
-    if (r==0) return 0;
-    if (r<0){ if(errno==EINTR || errno==EAGAIN || errno==EWOULDBLOCK) continue; return -1; }
-    got += (size_t)r;
-  }
-  return 1;
-}
 
 static inline uint32_t be32_to_host(uint32_t x){ return ntohl(x); }
 static inline uint16_t be16_to_host(uint16_t x){ return ntohs(x); }
 static inline uint32_t host_to_be32(uint32_t x){ return htonl(x); }
 static inline uint16_t host_to_be16(uint16_t x){ return htons(x); }
 
-static void clear_list_fully(awg_list_t *L) {
-    DPRINT("Fully clearing list (freeing all buffers).\n");
-    free(L->offsets);
-    L->offsets = NULL;
-    free(L->counts);
-    L->counts = NULL;
-    free(L->words);
-    L->words = NULL;
-    memset(L, 0, sizeof(awg_list_t));
+// --- [NEW] List state & ready ring (lock-free) ---
+static inline int list_state(const awg_list_t *L) {
+    return __atomic_load_n(&L->state, __ATOMIC_ACQUIRE);
+}
+static inline void list_set_state(awg_list_t *L, int st) {
+    __atomic_store_n(&L->state, st, __ATOMIC_RELEASE);
 }
 
-static bool prepare_list_for_preload(awg_list_t *L, uint32_t total_frames) {
-    DPRINT("Preparing list for preload with %u frames.\n", total_frames);
-    clear_list_fully(L);
-    L->offsets = calloc(total_frames, sizeof(uint32_t));
-    L->counts  = calloc(total_frames, sizeof(uint16_t));
+// Producer side (network thread only)
+static bool ring_push(spsc_ring_t *r, uint8_t id) {
+    uint32_t head = r->head;                                   // own index
+    uint32_t tail = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+    if (head - tail >= READY_RING_SIZE) return false;          // full
+    r->ids[head & (READY_RING_SIZE - 1)] = id;
+    __atomic_store_n(&r->head, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
 
-    if (!L->offsets || !L->counts) {
-        DPRINT("ERROR: Failed to allocate metadata for list.\n");
-        clear_list_fully(L);
-        return false;
-    }
-    L->total_frames = total_frames;
+// Consumer side (player thread only): constant time, never waits
+static bool ring_pop(spsc_ring_t *r, uint8_t *id) {
+    uint32_t tail = r->tail;                                   // own index
+    uint32_t head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+    if (tail == head) return false;                            // empty
+    *id = r->ids[tail & (READY_RING_SIZE - 1)];
+    __atomic_store_n(&r->tail, tail + 1, __ATOMIC_RELEASE);
     return true;
 }
 
-static bool ensure_words_cap(awg_list_t *L, uint32_t need_more){
-    if (L->words_used + need_more <= L->words_cap) return true;
-    uint32_t want = L->words_used + need_more;
-    uint32_t cap  = L->words_cap ? L->words_cap : GROW_WORDS_STEP;
-    while (cap < want) cap += GROW_WORDS_STEP;
-    uint32_t *nw = (uint32_t*)realloc(L->words, cap * sizeof(uint32_t));
+// --- [NEW] Completion signaling (eventfd, write never blocks) ---
+// The player writes done_efd whenever it hands a list back or acknowledges a
+// flush; the control side sleeps in poll() on it instead of usleep() polling,
+// so RESET/startup/shutdown continue the moment the player is done.
+static inline void efd_signal(int fd) {
+    uint64_t one = 1;
+    if (fd >= 0 && write(fd, &one, sizeof(one)) != sizeof(one)) { /* counter full: already signaled */ }
+}
+
+static inline void efd_drain(int fd) {
+    uint64_t v;
+    if (read(fd, &v, sizeof(v)) != sizeof(v)) { /* EAGAIN: nothing pending */ }
+}
+
+static inline void signal_done(void) { efd_signal(G.done_efd); }
+static inline void wake_player(void) { efd_signal(G.wake_efd); }
+
+// Sleep until the player signals (or WAIT_SAFETY_MS); callers re-check their condition.
+static void wait_player_signal(void) {
+    struct pollfd pfd = { .fd = G.done_efd, .events = POLLIN };
+    if (poll(&pfd, 1, WAIT_SAFETY_MS) > 0) efd_drain(G.done_efd);
+}
+
+static inline void stat_inc(uint64_t *c, uint64_t n) {
+    __atomic_store_n(c, __atomic_load_n(c, __ATOMIC_RELAXED) + n, __ATOMIC_RELAXED); // single writer
+}
+
+// --- [NEW] Tick histograms (written by the player only, read anywhere) ---
+static inline uint64_t mono_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ull + (uint64_t)t.tv_nsec;
+}
+
+// [NEW] System time, for 'A' START_AT
+static inline uint64_t rt_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_REALTIME, &t);
+    return (uint64_t)t.tv_sec * 1000000000ull + (uint64_t)t.tv_nsec;
+}
+
+static inline int hist_bucket(uint64_t ns) {
+    uint64_t us = ns / 1000;
+    if (us == 0) return 0;
+    int b = 64 - __builtin_clzll(us);
+    return b < AWG_HIST_BUCKETS ? b : AWG_HIST_BUCKETS - 1;
+}
+
+static inline void hist_add(uint64_t *h, uint64_t *max, uint64_t ns) {
+    stat_inc(&h[hist_bucket(ns)], 1);
+    if (ns > __atomic_load_n(max, __ATOMIC_RELAXED)) __atomic_store_n(max, ns, __ATOMIC_RELAXED);
+}
+
+// Honour a reset request from 'Q' (player thread only).
+static void player_service_hist_reset(void) {
+    uint32_t req = __atomic_load_n(&G.hist_reset_req, __ATOMIC_ACQUIRE);
+    if (req == G.hist_reset_ack) return;
+    uint64_t *p = (uint64_t*)&G.hist;
+    for (size_t i = 0; i < sizeof(G.hist) / sizeof(uint64_t); ++i) __atomic_store_n(&p[i], 0, __ATOMIC_RELAXED);
+    G.hist_reset_ack = req;
+}
+
+void get_queue_player_hist(queue_player_hist_t *h) {
+    if (!h) return;
+    const uint64_t *src = (const uint64_t*)&G.hist;
+    uint64_t *dst = (uint64_t*)h;
+    for (size_t i = 0; i < sizeof(*h) / sizeof(uint64_t); ++i) dst[i] = __atomic_load_n(&src[i], __ATOMIC_RELAXED);
+}
+
+void get_queue_player_stats(queue_player_stats_t *st) {
+    if (!st) return;
+    st->ticks         = __atomic_load_n(&G.stats.ticks,         __ATOMIC_RELAXED);
+    st->frames        = __atomic_load_n(&G.stats.frames,        __ATOMIC_RELAXED);
+    st->list_switches = __atomic_load_n(&G.stats.list_switches, __ATOMIC_RELAXED);
+    st->notify_coalesced = __atomic_load_n(&G.stats.notify_coalesced, __ATOMIC_RELAXED);
+    st->overrun_burst   = __atomic_load_n(&G.stats.overrun_burst,   __ATOMIC_RELAXED);
+    st->overrun_skip    = __atomic_load_n(&G.stats.overrun_skip,    __ATOMIC_RELAXED);
+    st->overrun_stretch = __atomic_load_n(&G.stats.overrun_stretch, __ATOMIC_RELAXED);
+    st->skipped_frames  = __atomic_load_n(&G.stats.skipped_frames,  __ATOMIC_RELAXED);
+    st->override_frames = __atomic_load_n(&G.stats.override_frames, __ATOMIC_RELAXED);
+    st->underruns       = __atomic_load_n(&G.stats.underruns,       __ATOMIC_RELAXED);
+}
+
+void get_queue_server_stats(tcp_server_stats_t *st) {
+    st->connects      = __atomic_load_n(&g_net.connects, __ATOMIC_RELAXED);
+    st->bytes_in      = __atomic_load_n(&g_rx.bytes,     __ATOMIC_RELAXED);
+    st->read_timeouts = __atomic_load_n(&g_rx.timeouts,  __ATOMIC_RELAXED);
+    st->frames        = __atomic_load_n(&g_net.frames,   __ATOMIC_RELAXED);
+    st->lists         = __atomic_load_n(&g_net.lists,    __ATOMIC_RELAXED);
+    st->errors        = __atomic_load_n(&g_net.errors,   __ATOMIC_RELAXED);
+}
+
+// Forget the list contents but keep the arena (network side only).
+static void reset_list(awg_list_t *L) {
+    L->total_frames  = 0;
+    L->loaded_frames = 0;
+    L->frame_words   = 0;
+    L->words_used    = 0;
+    L->repeat        = 1;
+    L->has_delta     = false;
+    L->has_gen       = false;
+    L->period_us     = 0;
+    memset(&L->delta, 0, sizeof(L->delta));
+    L->delta.full_left = 2;
+    list_set_state(L, LIST_IDLE);
+}
+
+// [NEW] Detach a LOADed file or an ingest slot and bring the parked arena
+// back (network side, list IDLE).
+static void release_list_file(awg_list_t *L) {
+    if (L->shm_attached) {
+        L->words = L->arena_words;
+        L->arena_words = NULL;
+        L->shm_attached = false;
+        awg_shm_release(L->shm_slot);
+    }
+    if (!L->file.map) return;
+    L->starts = L->arena_starts;
+    if (!L->words_external) L->words = L->arena_words;
+    L->arena_starts = NULL; L->arena_words = NULL;
+    awg_list_file_unmap(&L->file);
+}
+
+// Release the arena; only when the player is gone (server stop).
+static void free_list_arena(awg_list_t *L) {
+    release_list_file(L);
+    DPRINT("Freeing list arena (%u index entries, %u words).\n", L->starts_cap, L->words_cap);
+    free(L->starts);
+    if (!L->words_external) free(L->words);
+    memset(L, 0, sizeof(awg_list_t));
+}
+
+// Grow words[] to at least 'cap' words. Contents are kept (realloc); only
+// the new part is prefaulted, the kept part was touched by the copy.
+static bool reserve_words(awg_list_t *L, uint32_t cap) {
+    if (cap <= L->words_cap) return true;
+    if (L->words_external) {
+        DPRINT("ERROR: CMA slice full (%u words).\n", L->words_cap);
+        return false;
+    }
+    uint32_t *nw = (uint32_t*)realloc(L->words, (size_t)cap * sizeof(uint32_t));
     if (!nw) {
-        DPRINT("ERROR: Failed to realloc words buffer.\n");
+        DPRINT("ERROR: Failed to reserve %u words for list.\n", cap);
         return false;
     }
+    uint32_t old = L->words_cap;
     L->words = nw;
     L->words_cap = cap;
+    awg_rt_prefault(L->words + old, (size_t)(cap - old) * sizeof(uint32_t)); // no faults once the player reads it
     return true;
 }
 
+// DMA backend: the list's words live in its slice of the CMA buffer.
+// [MODIFIED] Slots 0..1 of the slice are reserved for the list's TRIG and
+// DWELL header words.
+static void attach_dma_slice(awg_list_t *L) {
+    L->words          = G.dma_words + (size_t)(L - G.list) * G.dma_slice_words + DMA_HDR_WORDS;
+    L->words_cap      = G.dma_slice_words - DMA_HDR_WORDS;
+    L->words_external = true;
+}
+
+// total_words = 0: unknown, size from ARENA_WORDS_PER_FRAME_HINT, at most
+// ARENA_UPFRONT_WORDS_MAX up front.
+static bool prepare_list_for_preload(awg_list_t *L, uint32_t total_frames, uint32_t total_words) {
+    DPRINT("Preparing list for preload with %u frames, %u words.\n", total_frames, total_words);
+    reset_list(L);
+    release_list_file(L);
+    // No frame index yet: starts[] is only allocated if the frame sizes differ
+    L->total_frames = total_frames;
+
+    // [NEW] DMA backend: words go straight into this list's slice of the CMA buffer.
+    if (G.use_dma) {
+        attach_dma_slice(L);
+        if (total_words > L->words_cap) {
+            DPRINT("ERROR: %u words do not fit the CMA slice (%u).\n", total_words, L->words_cap);
+            return false;
+        }
+        return true;
+    }
+
+    uint64_t want = total_words ? total_words
+                                : (uint64_t)total_frames * ARENA_WORDS_PER_FRAME_HINT;
+    if (!total_words && want > ARENA_UPFRONT_WORDS_MAX) want = ARENA_UPFRONT_WORDS_MAX;
+    if (L->words_cap >= want) return true;   // reuse the arena as is
+    free(L->words);                          // nothing to keep, skip the copy
+    L->words = NULL;
+    L->words_cap = 0;
+    return reserve_words(L, (uint32_t)want);
+}
+
+static bool ensure_words_cap(awg_list_t *L, uint32_t need_more){
+    uint32_t want = L->words_used + need_more;
+    if (want <= L->words_cap) return true;
+    // BEGIN under-sized the arena: double it so preload stays linear
+    uint32_t cap = L->words_cap ? L->words_cap : ARENA_WORDS_PER_FRAME_HINT;
+    while (cap < want) cap *= 2;
+    // never past what BEGIN's frame count allows (the last doubling can overshoot)
+    uint64_t limit = (uint64_t)L->total_frames * MAX_WORDS_PER_FRAME;
+    if (cap > limit && limit >= want) cap = (uint32_t)limit;
+    DPRINT("Growing list arena %u -> %u words.\n", L->words_cap, cap);
+    return reserve_words(L, cap);
+}
+
+// [NEW] starts[] with room for 'need' entries; old contents are dropped.
+static bool reserve_starts(awg_list_t *L, uint32_t need) {
+    if (need > L->starts_cap) {
+        // Old contents are not needed, so free+malloc instead of realloc (no copy)
+        free(L->starts);
+        L->starts = malloc((size_t)need * sizeof(uint32_t));
+        if (!L->starts) {
+            DPRINT("ERROR: Failed to allocate frame index for list.\n");
+            L->starts_cap = 0;
+            return false;
+        }
+        L->starts_cap = need;
+        awg_rt_prefault(L->starts, (size_t)need * sizeof(uint32_t));
+    }
+    return true;
+}
+
+// [NEW] Leave fixed-size mode: build starts[] for frames 0..i (all frame_words long).
+static bool make_index_variable(awg_list_t *L, uint32_t i) {
+    if (!reserve_starts(L, L->total_frames + 1)) return false;
+    DPRINT("List switches to a frame index after %u frames of %u words.\n", i, (unsigned)L->frame_words);
+    for (uint32_t k = 0; k <= i; ++k) L->starts[k] = k * L->frame_words;
+    L->frame_words = 0;
+    return true;
+}
+
+// [NEW] Record that frame i holds 'count' words right after frame i-1.
+static bool index_frame(awg_list_t *L, uint32_t i, uint16_t count) {
+    if (i == 0) { L->frame_words = count; return true; }
+    if (L->frame_words) {
+        if (count == L->frame_words) return true;
+        if (!make_index_variable(L, i)) return false;
+    }
+    L->starts[i + 1] = L->starts[i] + count;
+    return true;
+}
+
+// [NEW] Frame i of a generated list: INDEX+GAIN of every tone, then COMMIT.
+static inline uint32_t gen_value(const gen_ramp_t *r, uint32_t i) {
+    int64_t v  = (int64_t)r->start + (((int64_t)i * r->step) >> GEN_STEP_SHIFT);
+    int64_t lo = r->start < r->stop ? r->start : r->stop;
+    int64_t hi = r->start < r->stop ? r->stop : r->start;
+    return (uint32_t)(v < lo ? lo : v > hi ? hi : v);
+}
+
+static uint16_t gen_frame(const gen_desc_t *g, uint32_t i, uint32_t *w) {
+    uint16_t n = 0;
+    for (int ch = 0; ch < 2; ++ch)
+        for (int tone = 0; tone < awg_tones(); ++tone) {
+            int t = ch * AWG_MAX_TONES + tone;
+            w[n++] = MAKE_INDEX_WORD(ch, tone, gen_value(&g->idx[t], i));
+            w[n++] = MAKE_GAIN_WORD(ch, tone, gen_value(&g->gain[t], i));
+        }
+    w[n++] = MAKE_COMMIT_WORD();
+    return n;
+}
+
+// [NEW] Words of frame i (player side).
+static inline const uint32_t *list_frame(const awg_list_t *L, uint32_t i, uint16_t *cnt) {
+    if (L->has_gen) {
+        *cnt = gen_frame(&L->gen, i, G.gen_buf);
+        return G.gen_buf;
+    }
+    if (L->frame_words) {
+        *cnt = L->frame_words;
+        return &L->words[(size_t)i * L->frame_words];
+    }
+    uint32_t s = L->starts[i];
+    *cnt = (uint16_t)(L->starts[i + 1] - s);
+    return &L->words[s];
+}
+
 static bool push_frame(awg_list_t *L, const uint32_t *w, uint16_t count){
-    if (!L || !L->offsets || !L->counts) return false;
+    if (!L) return false;
+    L->delta.full_left = 2;   // raw words: the PL banks no longer match the delta mirror
     if (L->loaded_frames >= L->total_frames) {
         DPRINT("ERROR: Attempt to push frame when list is already full (%u/%u).\n", L->loaded_frames, L->total_frames);
         return false;
     }
     if (count == 0 || count > MAX_WORDS_PER_FRAME) return false;
     if (!ensure_words_cap(L, count)) return false;
-    uint32_t off = L->words_used;
-    memcpy(&L->words[off], w, count * sizeof(uint32_t));
+    memcpy(&L->words[L->words_used], w, count * sizeof(uint32_t));
+    if (!index_frame(L, L->loaded_frames, count)) return false;
     L->words_used += count;
-    L->offsets[L->loaded_frames] = off;
-    L->counts[L->loaded_frames] = count;
     L->loaded_frames++;
     return true;
 }
 
+// [NEW] Append one delta frame: apply the changed slots to the mirror, then
+// emit INDEX/GAIN words for the slots the shadow bank needs, plus COMMIT.
+// Slots of the tones the PL has, both channels
+static inline uint32_t delta_tone_mask(void) {
+    uint32_t ch = (1u << awg_tones()) - 1u;
+    return ch | (ch << AWG_MAX_TONES);
+}
+
+static bool push_delta_frame(awg_list_t *L, uint32_t idx_mask, const uint32_t *idx_val,
+                             uint32_t gain_mask, const uint32_t *gain_val) {
+    if (L->loaded_frames >= L->total_frames) return false;
+    L->has_delta = true;
+    delta_state_t *D = &L->delta;
+    for (int t = 0, k = 0; t < DELTA_SLOTS; ++t) if (idx_mask  & (1u << t)) D->idx[t]  = idx_val[k++];
+    for (int t = 0, k = 0; t < DELTA_SLOTS; ++t) if (gain_mask & (1u << t)) D->gain[t] = gain_val[k++];
+
+    uint32_t wi = idx_mask  | D->prev_idx_mask;
+    uint32_t wg = gain_mask | D->prev_gain_mask;
+    if (D->full_left) { wi = wg = delta_tone_mask(); D->full_left--; }
+    D->prev_idx_mask  = idx_mask;
+    D->prev_gain_mask = gain_mask;
+
+    if (!ensure_words_cap(L, 2 * DELTA_SLOTS + 1)) return false;
+    uint32_t off = L->words_used;
+    uint32_t *w = &L->words[off];
+    uint16_t n = 0;
+    for (int t = 0; t < DELTA_SLOTS; ++t) {
+        if (wi & (1u << t)) w[n++] = MAKE_INDEX_WORD(t / AWG_MAX_TONES, t % AWG_MAX_TONES, D->idx[t]);
+        if (wg & (1u << t)) w[n++] = MAKE_GAIN_WORD(t / AWG_MAX_TONES, t % AWG_MAX_TONES, D->gain[t]);
+    }
+    w[n++] = MAKE_COMMIT_WORD();
+    if (!index_frame(L, L->loaded_frames, n)) return false;
+    L->words_used += n;
+    L->loaded_frames++;
+    return true;
+}
+
+// Hand a fully loaded list to the player (network/control side only).
+static bool publish_list(int list_id) {
+    list_set_state(&G.list[list_id], LIST_READY);
+    if (!ring_push(&G.ready, (uint8_t)list_id)) {
+        // Cannot happen while every list is in the ring at most once
+        DPRINT("ERROR: ready ring full, list %d not queued.\n", list_id);
+        list_set_state(&G.list[list_id], LIST_LOADING);
+        return false;
+    }
+    stat_inc(&g_net.lists, 1);
+    stat_inc(&g_net.frames, G.list[list_id].loaded_frames);
+    wake_player();
+    return true;
+}
+
 static bool load_zero_gain_list(awg_list_t *L, uint32_t num_frames) {
-    if (!prepare_list_for_preload(L, num_frames)) {
+    uint32_t zero[MAX_WORDS_PER_FRAME];
+    uint16_t count = zero_gain_frame(zero);
+    if (!prepare_list_for_preload(L, num_frames, num_frames * count)) {
         return false;
     }
     for (uint32_t i = 0; i < num_frames; ++i) {
-        if (!push_frame(L, ZERO_GAIN_FRAME, ZERO_GAIN_FRAME_COUNT)) {
-            clear_list_fully(L);
+        if (!push_frame(L, zero, count)) {
+            reset_list(L);
             return false;
         }
     }
-    L->ready = true;
     return true;
 }
 
 static void init_lists(){
   memset(&G, 0, sizeof(G));
-  pthread_mutex_init(&G.mtx, NULL);
   G.period_us = 1000;
-  G.cur_list = 0; G.next_list = 1;
+  G.cur_list = -1;
+  G.prev_list = -1;
+  G.done_efd = G.wake_efd = -1;
+
+  // [NEW] Overrun policy: AWG_OVERRUN = burst (default) | skip | stretch
+  G.overrun = OVERRUN_BURST;
+  const char *ov = getenv("AWG_OVERRUN");
+  if (ov) {
+      if      (strcmp(ov, "skip") == 0)    G.overrun = OVERRUN_SKIP;
+      else if (strcmp(ov, "stretch") == 0) G.overrun = OVERRUN_STRETCH;
+      else if (strcmp(ov, "burst") != 0)   printf("[QSRV] Ignoring AWG_OVERRUN=%s (burst|skip|stretch).\n", ov);
+  }
+
+  // [NEW] Reset path: AWG_RESET = fast (default, awg_reset_banks) | flush (zero lists)
+  const char *rm = getenv("AWG_RESET");
+  if (rm) {
+      if      (strcmp(rm, "flush") == 0) G.reset_flush = true;
+      else if (strcmp(rm, "fast") != 0)  printf("[QSRV] Ignoring AWG_RESET=%s (fast|flush).\n", rm);
+  }
+
+  // [NEW] Queue depth: AWG_QUEUE_DEPTH lists (2 = classic ping-pong)
+  G.n_lists = AWG_DEFAULT_LISTS;
+  const char *depth = getenv("AWG_QUEUE_DEPTH");
+  if (depth) {
+      int n = atoi(depth);
+      if (n >= 2 && n <= AWG_MAX_LISTS) G.n_lists = n;
+      else printf("[QSRV] Ignoring AWG_QUEUE_DEPTH=%s (valid: 2..%d).\n", depth, AWG_MAX_LISTS);
+  }
+  g_list_count = G.n_lists;
+  DPRINT("List queue depth: %d.\n", G.n_lists);
+
+  // [NEW] Use the DMA backend if main() brought it up (unless the core itself
+  // writes through the DMA: frames then go through awg_send_words32_burst)
+  if (awg_dma_ready() && strcmp(awg_core_backend_name(), "dma") != 0) {
+      size_t cap = 0;
+      G.dma_words       = awg_dma_buffer(&cap);
+      cap               = cap > DMA_SIDE_WORDS ? cap - DMA_SIDE_WORDS : 0;
+      G.dma_slice_words = (uint32_t)(cap / (size_t)G.n_lists);
+      G.dma_side        = G.dma_words ? G.dma_words + cap : NULL;
+      G.use_dma         = (G.dma_words != NULL && G.dma_slice_words > DMA_HDR_WORDS);
+      G.use_seq         = G.use_dma && awg_seq_ready();
+      DPRINT("DMA backend active: %u words per list%s.\n", G.dma_slice_words,
+             G.use_seq ? ", PL sequencer" : "");
+  }
+}
+
+// --- [NEW] Player-side helpers (player thread only, never block) ---
+// [MODIFIED] Lock-free event queue to the notify drain thread, never send()s
+static void player_notify(int type, int list_id, int status, uint32_t frame) {
+    if (!post_list_event(type, list_id, status, frame)) stat_inc(&G.stats.notify_coalesced, 1);
+}
+
+// Give a finished (or dropped) list back to the network side. Its buffers
+// are released by the network thread at the next BEGIN, not here.
+// frames = frames of it played in the last pass (binary notify event).
+static void player_release(int list_id, uint32_t frames) {
+    list_set_state(&G.list[list_id], LIST_IDLE);
+    player_notify(NOTIFY_EV_STATUS, list_id, LIST_IDLE, frames);
+    signal_done();
+}
+
+// Take the next READY list from the ring; -1 if none.
+static int player_take_next(void) {
+    uint8_t id;
+    while (ring_pop(&G.ready, &id)) {
+        if (list_state(&G.list[id]) == LIST_READY && G.list[id].loaded_frames > 0) {
+            stat_inc(&G.stats.list_switches, 1);
+            return id;
+        }
+        player_release(id, 0); // empty list, nothing to play
+    }
+    return -1;
+}
+
+// [NEW] End of one pass over cur_list: true = play it again from RAM.
+// repeat is re-read at every boundary, so 'R' can extend or break a loop.
+static bool player_replay_list(const awg_list_t *L) {
+    G.cur_pass++;
+    uint32_t rep = __atomic_load_n(&L->repeat, __ATOMIC_RELAXED);
+    if (rep != 0 && G.cur_pass >= rep) return false;
+    if (__atomic_load_n(&G.flush_req, __ATOMIC_ACQUIRE) != G.flush_ack) return false;
+    return true;
+}
+
+// [NEW] Nothing left to play: overrides belonged to that run, port 9000
+// writes directly again.
+static void player_end_playing(void) {
+    if (!G.playing) return;
+    __atomic_store_n(&G.ovr_epoch, G.ovr_epoch + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&G.playing, 0, __ATOMIC_SEQ_CST);
+}
+
+// Honour a flush request: drop the list on air and everything queued.
+static bool player_service_flush(void) {
+    uint32_t req = __atomic_load_n(&G.flush_req, __ATOMIC_ACQUIRE);
+    if (req == G.flush_ack) return false;
+    if (G.cur_list >= 0) { player_release(G.cur_list, G.cur_frame); G.cur_list = -1; }
+    int id;
+    while ((id = player_take_next()) >= 0) player_release(id, 0);
+    G.cur_frame = 0;
+    G.prev_list = -1;
+    if (!G.use_dma) player_end_playing();
+    __atomic_store_n(&G.flush_ack, req, __ATOMIC_RELEASE);
+    signal_done();
+    return true;
+}
+
+// [NEW] cur_list has no frames left: replay it, or hand it back right away,
+// so a waiter (RESET, priming, shutdown) sees IDLE as soon as the last frame
+// is on air instead of one period later. The next list starts on the next tick.
+static bool player_finish_pass(void) {
+    if (player_replay_list(&G.list[G.cur_list])) {
+        G.cur_frame = 0;        // loop: next pass starts at the next tick
+        return true;
+    }
+    G.prev_list = G.cur_list;
+    G.cur_list  = -1;
+    player_release(G.prev_list, G.cur_frame);
+    G.cur_frame = 0;
+    return false;
+}
+
+// --- [MODIFIED] player_thread: lock-free hand-off, no gap during list switching ---
+// [NEW] Period of the frame on air: the list's own period, else the global one
+static inline uint32_t player_period_us(void) {
+    uint32_t us = G.cur_list >= 0 ? G.list[G.cur_list].period_us : 0;
+    return us ? us : __atomic_load_n(&G.period_us, __ATOMIC_RELAXED);
+}
+
+static inline void ts_add_ns(struct timespec *t, uint64_t ns) {
+    ns += (uint64_t)t->tv_nsec;
+    t->tv_sec  += (time_t)(ns / 1000000000ull);
+    t->tv_nsec  = (long)(ns % 1000000000ull);
+}
+
+// [NEW] Woke late_ns after the deadline in ts, period_ns >= 1 slot behind.
+static void player_handle_overrun(struct timespec *ts, uint64_t late_ns, uint64_t period_ns) {
+    uint64_t slots = late_ns / period_ns;   // whole periods already gone
+    int policy = __atomic_load_n(&G.overrun, __ATOMIC_RELAXED);
+
+    // Dropping delta frames would desync the PL banks: burst instead
+    if (policy == OVERRUN_SKIP && G.cur_list >= 0 && G.list[G.cur_list].has_delta)
+        policy = OVERRUN_BURST;
+
+    switch (policy) {
+    case OVERRUN_SKIP:
+        ts_add_ns(ts, slots * period_ns);
+        if (G.cur_list >= 0) {
+            uint32_t left = G.list[G.cur_list].loaded_frames - G.cur_frame;
+            uint32_t drop = slots < left ? (uint32_t)slots : left;
+            G.cur_frame += drop;
+            stat_inc(&G.stats.skipped_frames, drop);
+        }
+        stat_inc(&G.stats.overrun_skip, 1);
+        break;
+    case OVERRUN_STRETCH:
+        ts_add_ns(ts, late_ns);                // new grid starts at this wakeup
+        stat_inc(&G.stats.overrun_stretch, 1);
+        break;
+    default:                                   // OVERRUN_BURST: next ticks return at once
+        stat_inc(&G.stats.overrun_burst, 1);
+        break;
+    }
+}
+
+// [NEW] Pick up a newly published override set (GPIO player only). Slots
+// it no longer overrides still hold the override in both PL banks, and a
+// delta list may not write them again for a long time: for the next two
+// frames, put back what the list itself last wrote there.
+static void player_refresh_override(void) {
+    uint32_t s = __atomic_load_n(&G.ovr_seq, __ATOMIC_ACQUIRE);
+    if (s == G.ovr_seen || (s & 1u)) return;      // unchanged, or being written
+    override_set_t tmp;
+    memcpy(&tmp, &G.ovr, sizeof(tmp));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&G.ovr_seq, __ATOMIC_RELAXED) != s) return;  // torn: next tick
+    uint32_t ri = G.ovr_cur.idx_mask & ~tmp.idx_mask, rg = G.ovr_cur.gain_mask & ~tmp.gain_mask;
+    if (ri | rg) { G.rel_idx_mask |= ri; G.rel_gain_mask |= rg; G.rel_left = 2; }
+    G.rel_idx_mask  &= ~tmp.idx_mask;             // overridden again
+    G.rel_gain_mask &= ~tmp.gain_mask;
+    G.ovr_cur  = tmp;
+    G.ovr_seen = s;
+}
+
+// [NEW] Remember the INDEX/GAIN values a list frame writes (for the above).
+static inline void player_track_frame(const uint32_t *fw, uint16_t cnt) {
+    for (uint16_t i = 0; i < cnt; ++i) {
+        uint32_t w = fw[i], cmd = w >> 28;
+        if (cmd != 0x1 && cmd != 0x2) continue;
+        uint32_t t = word_slot(w);
+        if (cmd == 0x1) { G.own_idx[t]  = w & 0xFFFFFu; G.own_idx_mask  |= 1u << t; }
+        else            { G.own_gain[t] = w & 0xFFFFFu; G.own_gain_mask |= 1u << t; }
+    }
+}
+
+// [NEW] First list after idle: from here on port 9000 is merged into our
+// frames. Wait out a direct burst that began before it saw the flag
+// (one frame of words at most). Spin briefly, then sleep: sched_yield()
+// would not let the SCHED_OTHER network thread run if it shares our core.
+static void player_begin_playing(void) {
+    if (G.playing) return;
+    __atomic_store_n(&G.playing, 1, __ATOMIC_SEQ_CST);
+    for (int spins = 0; __atomic_load_n(&G.direct_busy, __ATOMIC_SEQ_CST) && !g_stop_player; ) {
+        if (++spins < DIRECT_SPIN_LIMIT) continue;
+        struct timespec d = { 0, DIRECT_WAIT_NS };
+        clock_nanosleep(CLOCK_MONOTONIC, 0, &d, NULL);
+    }
+    memset(&G.ovr_cur, 0, sizeof(G.ovr_cur));
+    G.ovr_seen = __atomic_load_n(&G.ovr_seq, __ATOMIC_ACQUIRE) & ~1u; // sets of the last run are stale
+    G.own_idx_mask = G.own_gain_mask = 0;
+    G.rel_idx_mask = G.rel_gain_mask = 0;
+    G.rel_left = 0;
+}
+
+// [NEW] One frame to the PL with the override words (and released slots'
+// own values) merged ahead of its COMMIT (appended when the frame has
+// none). Unchanged fast path without.
+static void player_send_frame(const uint32_t *fw, uint16_t cnt) {
+    player_refresh_override();
+    player_track_frame(fw, cnt);
+    uint32_t ri = 0, rg = 0;
+    if (G.rel_left) {
+        ri = G.rel_idx_mask  & G.own_idx_mask;     // a slot the lists never wrote keeps the override
+        rg = G.rel_gain_mask & G.own_gain_mask;
+        if (--G.rel_left == 0) G.rel_idx_mask = G.rel_gain_mask = 0;
+    }
+    const override_set_t *o = &G.ovr_cur;
+    if (!(o->idx_mask | o->gain_mask | ri | rg)) { awg_send_words32_burst(fw, cnt); return; }
+
+    uint32_t buf[MAX_WORDS_PER_FRAME + 2 * DELTA_SLOTS];
+    bool commit = (fw[cnt - 1] >> 28) == 0xF;
+    uint16_t n = commit ? cnt - 1 : cnt;
+    memcpy(buf, fw, (size_t)n * sizeof(uint32_t));
+    for (int t = 0; t < DELTA_SLOTS; ++t) {                    // ri/rg never overlap the masks
+        if (o->idx_mask  & (1u << t)) buf[n++] = MAKE_INDEX_WORD(t / AWG_MAX_TONES, t % AWG_MAX_TONES, o->idx[t]);
+        if (o->gain_mask & (1u << t)) buf[n++] = MAKE_GAIN_WORD(t / AWG_MAX_TONES, t % AWG_MAX_TONES, o->gain[t]);
+        if (ri & (1u << t)) buf[n++] = MAKE_INDEX_WORD(t / AWG_MAX_TONES, t % AWG_MAX_TONES, G.own_idx[t]);
+        if (rg & (1u << t)) buf[n++] = MAKE_GAIN_WORD(t / AWG_MAX_TONES, t % AWG_MAX_TONES, G.own_gain[t]);
+    }
+    if (commit) buf[n++] = fw[cnt - 1];
+    awg_send_words32_burst(buf, n);
+    stat_inc(&G.stats.override_frames, 1);
+}
+
+// [NEW] Armed start ('A'), called with the list just taken. Sleeps on
+// CLOCK_REALTIME until the start time, in WAIT_SAFETY_MS slices so RESET and
+// shutdown still get through; trigger followers wake START_EARLY_US earlier,
+// so frame 0 already waits in the PL gate when the leader's edge comes.
+// *start_mono = start time on CLOCK_MONOTONIC (0 = no start armed), *trig =
+// TRIG word to send ahead of frame 0 (0 = none). fifo: the words go through
+// the GPIO command FIFO, which has no backpressure. Frames keep arriving
+// while the gate holds, so the timeout is cut to START_TRIG_FIFO_FRAMES
+// periods: the gate lets the COMMIT through before the FIFO can overflow.
+// false = flushed or stopping.
+static bool player_wait_start(uint64_t *start_mono, uint32_t *trig, bool fifo) {
+    *start_mono = 0;
+    *trig = 0;
+    uint64_t at = __atomic_exchange_n(&G.start_rt_ns, 0, __ATOMIC_ACQ_REL);
+    if (!at) return true;
+    uint32_t mode  = __atomic_load_n(&G.start_mode, __ATOMIC_RELAXED);
+    bool   follow  = (mode & START_TRIG) && !(mode & START_LEAD);
+    uint64_t wake  = follow ? at - (uint64_t)START_EARLY_US * 1000u : at;
+    uint64_t slice = (uint64_t)WAIT_SAFETY_MS * 1000000u;
+    for (;;) {
+        if (g_stop_player || __atomic_load_n(&G.flush_req, __ATOMIC_ACQUIRE) != G.flush_ack) return false;
+        uint64_t now = rt_ns();
+        if (now >= wake) break;
+        uint64_t until = wake - now > slice ? now + slice : wake;
+        struct timespec t = { .tv_sec = (time_t)(until / 1000000000ull), .tv_nsec = (long)(until % 1000000000ull) };
+        clock_nanosleep(CLOCK_REALTIME, TIMER_ABSTIME, &t, NULL);
+    }
+
+    // Re-anchor on the monotonic clock the frame grid runs on
+    uint64_t now_rt = rt_ns(), now_mono = mono_ns();
+    uint64_t period_ns = (uint64_t)player_period_us() * 1000u;
+    if (now_rt < at) {
+        *start_mono = now_mono + (at - now_rt);
+    } else if (now_rt - at < period_ns) {
+        *start_mono = now_mono - (now_rt - at);
+    } else {                                   // list taken after its start time
+        DPRINT("START_AT passed %llu us ago, starting now.\n", (unsigned long long)((now_rt - at) / 1000u));
+        *start_mono = now_mono;
+    }
+    if (mode & START_TRIG) {
+        uint32_t window = START_TRIG_WINDOW_US;
+        if (fifo && (uint64_t)START_TRIG_FIFO_FRAMES * (period_ns / 1000u) < window)
+            window = START_TRIG_FIFO_FRAMES * (uint32_t)(period_ns / 1000u);
+        *trig = awg_make_trig_word(AWG_TRIG_ARM | ((mode & START_LEAD) ? AWG_TRIG_LEAD : 0u),
+                                   (follow ? START_EARLY_US : 0u) + window);
+    }
+    DPRINT("START_AT reached (mode %u), list %d.\n", (unsigned)mode, G.cur_list);
+    return true;
 }
 
-// --- [MODIFIED] player_thread to eliminate the 1ms gap during list switching ---
 static void *player_thread(void *arg){
     (void)arg;
+    prctl(PR_SET_TIMERSLACK, 1UL);  // [NEW] 1 ns slack so short periods wake on time
     struct timespec ts;
     clock_gettime(CLOCK_MONOTONIC, &ts);
-    while (!g_stop_queue){
-        uint32_t us;
-        pthread_mutex_lock(&G.mtx);
-        us = G.period_us;
-        pthread_mutex_unlock(&G.mtx);
-        ts.tv_nsec += (long)us * 1000L;
-        while (ts.tv_nsec >= 1000000000L){ ts.tv_nsec -= 1000000000L; ts.tv_sec++; }
+    while (!g_stop_player){
+        uint32_t us = player_period_us();
+        ts_add_ns(&ts, (uint64_t)us * 1000u);
         clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
 
-        pthread_mutex_lock(&G.mtx);
+        // [NEW] Wakeup lateness against the absolute deadline
+        uint64_t wake_ns = mono_ns();
+        uint64_t dl_ns   = (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+        uint64_t late_ns = wake_ns > dl_ns ? wake_ns - dl_ns : 0;
+        hist_add(G.hist.late, &G.hist.max_late_ns, late_ns);
+        if (late_ns >= (uint64_t)us * 1000u) {
+            stat_inc(&G.hist.missed, 1);
+            player_handle_overrun(&ts, late_ns, (uint64_t)us * 1000u);
+        }
+
+        stat_inc(&G.stats.ticks, 1);
+        player_service_hist_reset();
+        player_service_flush();
+
+        bool switched = false;
+        if (G.cur_list < 0) {
+            G.cur_list = player_take_next();
+            G.cur_frame = 0;
+            G.cur_pass = 0;
+            if (G.cur_list < 0) {                                  // nothing to play
+                if (G.prev_list >= 0) {                            // [NEW] counted as an underrun
+                    DPRINT("End of list %d, no next ready -> stopping.\n", G.prev_list);
+                    stat_inc(&G.stats.underruns, 1);
+                }
+                G.prev_list = -1;
+                G.last_send_ns = 0;
+                player_end_playing();
+                continue;
+            }
+            // [NEW] Armed start: frame 0 goes out now (followers: into the
+            // PL gate), the grid continues from the start time
+            uint64_t start_mono;
+            uint32_t trig;
+            if (!player_wait_start(&start_mono, &trig, true)) { player_service_flush(); continue; }
+            player_begin_playing();
+            if (start_mono) {
+                ts.tv_sec  = (time_t)(start_mono / 1000000000ull);
+                ts.tv_nsec = (long)(start_mono % 1000000000ull);
+                G.prev_list    = -1;                               // not a gapless switch
+                G.last_send_ns = 0;
+                if (trig) awg_send_words32(&trig, 1);
+            }
+            player_notify(NOTIFY_EV_START, G.cur_list, LIST_READY, G.list[G.cur_list].loaded_frames);
+            switched = G.prev_list >= 0;
+            if (switched) DPRINT("Switching from list %d to %d\n", G.prev_list, G.cur_list);
+            else          DPRINT("Starting playback on list %d\n", G.cur_list);
+            G.prev_list = -1;
+        }
+
+        awg_list_t *L = &G.list[G.cur_list];
+        if (G.cur_frame >= L->loaded_frames && !player_finish_pass()) continue; // overrun skip ate the tail
+
+        // The first frame of the next list goes out one period after the last one.
+        uint16_t cnt;
+        const uint32_t *fw = list_frame(L, G.cur_frame, &cnt);
+        G.cur_frame++;
+        uint64_t t0 = mono_ns();
+        player_send_frame(fw, cnt);
+        uint64_t t1 = mono_ns();
+        stat_inc(&G.stats.frames, 1);
+
+        hist_add(G.hist.send, &G.hist.max_send_ns, t1 - t0);
+        if (switched && G.last_send_ns)
+            hist_add(G.hist.switch_gap, &G.hist.max_switch_gap_ns, t0 - G.last_send_ns);
+        G.last_send_ns = t0;
+
+        if (G.cur_frame >= L->loaded_frames) player_finish_pass();
+    }
+    DPRINT("Player thread exiting.\n");
+    return NULL;
+}
+
+// [NEW] DMA player, between lists: send the queued side writes, one transfer
+// each. Unpaced (pacer period 0, a DWELL 0 word first for the sequencer),
+// so RESET's two COMMITs go out at once; a flush request or stop aborts.
+static void player_dma_side(bool *armed) {
+    uint32_t t = G.side_tail;
+    if (t == __atomic_load_n(&G.side_head, __ATOMIC_ACQUIRE)) return;
+    awg_dma_set_period_us(0);
+    if (G.use_seq && !*armed) { awg_seq_arm(1); *armed = true; }
+    while (t != __atomic_load_n(&G.side_head, __ATOMIC_ACQUIRE)) {
+        const side_write_t *e = &G.side[t & (SIDE_RING_SIZE - 1)];
+        G.dma_side[0] = awg_make_dwell_word(0);
+        memcpy(G.dma_side + 1, e->words, (size_t)e->count * sizeof(uint32_t));
+        int rc = awg_dma_send(G.dma_side, (size_t)e->count + 1u);
+        if (rc == 0) {
+            do {
+                rc = awg_dma_wait_fd(WAIT_SAFETY_MS, G.wake_efd);
+                if (rc == -3) { efd_drain(G.wake_efd); rc = -2; }
+            } while (rc == -2 && !g_stop_player &&
+                     __atomic_load_n(&G.flush_req, __ATOMIC_ACQUIRE) == G.flush_ack);
+            if (rc == -2) awg_dma_abort();
+        }
+        if (rc != 0) DPRINT("ERROR: DMA side write of %u words failed (%d).\n", (unsigned)e->count, rc);
+        __atomic_store_n(&G.side_tail, ++t, __ATOMIC_RELEASE);
+        signal_done();
+    }
+}
 
-        if (!G.playing) {
-            pthread_mutex_unlock(&G.mtx);
+// --- [NEW] DMA player: one transfer per list, frame timing done in the PL ---
+// The pacer (or the sequencer) holds every COMMIT until its slot opens, so
+// the DMA completes right after the last frame of the list is committed.
+// Re-arming for the next list only has to beat one frame period to stay
+// gapless. Each transfer starts with the list's TRIG and DWELL header words, so the
+// sequencer switches dwell exactly at the list boundary. Dwell is per list
+// (its period); the server emits no per-frame DWELL words. A client that
+// needs per-frame dwell puts DWELL words into its 'M' frames: the sequencer
+// takes them, the GPIO path ignores them.
+static void *player_thread_dma(void *arg){
+    (void)arg;
+    bool armed = false;
+    while (!g_stop_player){
+        stat_inc(&G.stats.ticks, 1);
+        player_service_flush();
+        player_dma_side(&armed);
+
+        G.cur_list = player_take_next();
+        if (G.cur_list < 0) {
+            if (armed) { awg_seq_arm(0); armed = false; }
+            player_end_playing();                         // port 9000 queues side writes again
+            struct pollfd pfd = { .fd = G.wake_efd, .events = POLLIN }; // publish/flush/stop
+            if (poll(&pfd, 1, WAIT_SAFETY_MS) > 0) efd_drain(G.wake_efd);
             continue;
         }
 
-        awg_list_t *current_list = &G.list[G.cur_list];
-        if (!current_list->ready || G.cur_frame >= current_list->total_frames) {
-            int finished_list_idx = G.cur_list;
-            awg_list_t *next_list = &G.list[G.next_list];
-
-            if (next_list->ready && next_list->total_frames > 0) {
-                DPRINT("Switching from list %d to %d\n", G.cur_list, G.next_list);
-                // Perform the switch
-                G.cur_list = G.next_list; 
-                G.next_list = finished_list_idx; 
-                G.cur_frame = 0;
-                // The list to be cleared is the *old* one
-                current_list = &G.list[G.cur_list]; // IMPORTANT: Update current_list pointer
-            } else {
-                DPRINT("End of list %d, no next ready -> stopping.\n", finished_list_idx);
-                G.playing = false;
-                clear_list_fully(&G.list[finished_list_idx]);
-                pthread_mutex_unlock(&G.mtx);
-
-                pthread_mutex_lock(&g_notify_mutex);
-                g_list_status[finished_list_idx] = LIST_IDLE;
-                pthread_mutex_unlock(&g_notify_mutex);
-                send_status_update(finished_list_idx);
-                continue; // Stop playing
+        // [NEW] From here port 9000 is rejected until the player is idle
+        // again; frames it queued before that go out first
+        player_begin_playing();
+        player_dma_side(&armed);
+
+        awg_list_t *L = &G.list[G.cur_list];
+        G.cur_pass = 0;
+        // [NEW] Armed start: the transfer starts at the start time; a TRIG
+        // word in the header makes the gate hold the first COMMIT (the DMA
+        // just stalls behind it), later passes carry a no-op TRIG word
+        uint64_t start_mono;
+        uint32_t trig;
+        if (!player_wait_start(&start_mono, &trig, false)) { player_service_flush(); continue; }
+        player_notify(NOTIFY_EV_START, G.cur_list, LIST_READY, L->loaded_frames);
+        int rc;
+        do { // one DMA transfer per pass; looping replays the same CMA slice
+            uint32_t us = player_period_us();
+            awg_dma_set_period_us(us);
+            L->words[-2] = trig ? trig : awg_make_trig_word(0, 0);
+            L->words[-1] = awg_make_dwell_word(awg_dma_us_to_cycles(us));
+            trig = 0;
+            rc = awg_dma_send(L->words - DMA_HDR_WORDS, L->words_used + DMA_HDR_WORDS);
+            if (rc == 0 && G.use_seq) {
+                awg_seq_status_t st;
+                if (awg_seq_get_status(&st) == 0) G.seq_frame_base = st.frame_cnt;
+                // The transfer has only started: disarmed, the sequencer
+                // holds frame 0's COMMIT and the DMA stalls behind it, so
+                // waiting for MM2S idle here would never return. Arming
+                // fires that COMMIT at once, later ones on the dwell grid.
+                if (!armed) { awg_seq_arm(1); armed = true; }
             }
+            G.cur_frame = L->loaded_frames; // whole list handed to the DMA engine
 
-            // Clean up the OLD list and send notification AFTER the switch
-            clear_list_fully(&G.list[G.next_list]); // G.next_list now holds the old list index
-            pthread_mutex_unlock(&G.mtx); // Unlock before notify
-
-            pthread_mutex_lock(&g_notify_mutex);
-            g_list_status[finished_list_idx] = LIST_IDLE;
-            pthread_mutex_unlock(&g_notify_mutex);
-            send_status_update(finished_list_idx);
-
-            pthread_mutex_lock(&G.mtx); // Re-lock to continue to the send logic below
-        } 
-
-        // This logic will now be executed for the first frame of the new list
-        // in the same timeslice as the switch.
-        if (G.playing && current_list->loaded_frames > G.cur_frame) {
-            uint32_t off = current_list->offsets[G.cur_frame];
-            uint16_t cnt = current_list->counts[G.cur_frame];
-            uint32_t *w  = &current_list->words[off];
-            G.cur_frame++;
-            pthread_mutex_unlock(&G.mtx);
-            if(w) awg_send_words32(w, cnt);
-        } else {
-            pthread_mutex_unlock(&G.mtx);
-        }
+            if (rc != 0) {
+                DPRINT("ERROR: awg_dma_send failed (%d).\n", rc);
+                break;
+            }
+            // [MODIFIED] Sleep on the DMA interrupt (UIO) and wake_efd together,
+            // so a flush request (RESET) aborts a long list at once
+            do {
+                rc = awg_dma_wait_fd(WAIT_SAFETY_MS, G.wake_efd);
+                if (rc == -3) { efd_drain(G.wake_efd); rc = -2; }
+                if (rc == -2 && __atomic_load_n(&G.flush_req, __ATOMIC_ACQUIRE) != G.flush_ack) {
+                    awg_dma_abort();
+                    rc = 0;
+                }
+            } while (rc == -2 && !g_stop_player);
+            if (rc != 0) DPRINT("awg_dma_wait returned %d.\n", rc);
+            stat_inc(&G.stats.frames, L->loaded_frames);
+        } while (rc == 0 && !g_stop_player && player_replay_list(L));
+
+        player_release(G.cur_list, G.cur_frame);
+        G.cur_list = -1;
     }
-    DPRINT("Player thread exiting.\n");
+    DPRINT("DMA player thread exiting.\n");
     return NULL;
 }
 
@@ -345,11 +1244,17 @@ static void *player_thread(void *arg){
 static void start_player_if_needed(){
   if (!G.player_thread_running){
     DPRINT("Starting player thread...\n");
-    if (pthread_create(&G.player_thread_h, NULL, player_thread, NULL) != 0) {
+    if (pthread_create(&G.player_thread_h, NULL,
+                       G.use_dma ? player_thread_dma : player_thread, NULL) != 0) {
         DPRINT("ERROR: Failed to create player thread: %s\n", strerror(errno));
         return;
     }
 
+    // [NEW] Dedicated core (AWG_RT_PLAYER_CPU); the other threads stay on the network core
+    if (awg_rt_pin_thread(G.player_thread_h, awg_rt_player_cpu()) == 0 && awg_rt_player_cpu() >= 0) {
+        DPRINT("Player thread pinned to CPU %d.\n", awg_rt_player_cpu());
+    }
+
     // --- [NEW] Set thread to real-time priority ---
     struct sched_param params;
     
@@ -368,158 +1273,212 @@ static void start_player_if_needed(){
   }
 }
 
-static void cancel_preload_and_mark_idle(int list_id) {
-    if (list_id < 0 || list_id > 1) return;
-    
-    if (!g_loading_in_progress[list_id]) return;
+// [NEW] Control work that does not fit one reactor callback. While a job
+// runs, owner commands wait in their sessions (see ctl_must_wait()); the
+// job's session gets the reply unless it was dropped meanwhile (s = NULL).
+enum ctl_job { JOB_NONE, JOB_STORE, JOB_RESET };
+
+static struct {
+    int              job;
+    queue_session_t *s;
+    uint8_t          list_id;     // JOB_STORE
+} g_job;
+
+// --- [NEW] Control-side helpers ---
+// [MODIFIED] Ask the player to drop everything: flush_begin() returns the
+// request, flush_done() is true once the player has (about one period).
+static uint32_t flush_begin(void) {
+    uint32_t req = __atomic_add_fetch(&G.flush_req, 1, __ATOMIC_ACQ_REL);
+    wake_player();
+    return req;
+}
 
-    DPRINT("CANCEL preload on list %d -> IDLE (client disconnected)\n", list_id);
-    g_loading_in_progress[list_id] = false;
+static bool flush_done(uint32_t req) {
+    return !G.player_thread_running || g_stop_player ||
+           __atomic_load_n(&G.flush_ack, __ATOMIC_ACQUIRE) == req;
+}
 
-    pthread_mutex_lock(&G.mtx);
-    clear_list_fully(&G.list[list_id]);
-    pthread_mutex_unlock(&G.mtx);
+// Synchronous form for shutdown (no reactor running).
+static void request_player_flush(void) {
+    if (!G.player_thread_running) return;
+    uint32_t req = flush_begin();
+    while (!flush_done(req)) wait_player_signal();
+}
 
-    pthread_mutex_lock(&g_notify_mutex);
-    g_list_status[list_id] = LIST_IDLE;
-    pthread_mutex_unlock(&g_notify_mutex);
+// [NEW] Queue a side write for the DMA player (caller holds g_direct_mu).
+// *ticket: side_tail reaches it once the words are out. False if full.
+static bool side_push(const uint32_t *words, int count, uint32_t *ticket) {
+    uint32_t h = G.side_head;
+    if (count <= 0 || count > AWG_RESET_WORDS_MAX ||
+        h - __atomic_load_n(&G.side_tail, __ATOMIC_ACQUIRE) >= SIDE_RING_SIZE) return false;
+    side_write_t *e = &G.side[h & (SIDE_RING_SIZE - 1)];
+    memcpy(e->words, words, (size_t)count * sizeof(uint32_t));
+    e->count = (uint16_t)count;
+    __atomic_store_n(&G.side_head, h + 1, __ATOMIC_RELEASE);
+    if (ticket) *ticket = h + 1;
+    wake_player();
+    return true;
+}
 
-    send_status_update(list_id);
+// [MODIFIED] Silence the PL in steps, so RESET can run from the reactor:
+// zero_begin() starts, zero_poll() advances on every player signal and is
+// true once done. The fast path writes SAFE + a zero frame into both banks
+// in one burst (silent from its first COMMIT); AWG_RESET=flush keeps the
+// long zero-list playback (list 0, then list 1). With the DMA backend the
+// burst is a side write through the DMA player, never the GPIO feed.
+// Caller owns all lists (player flushed or idle), so the player is not
+// writing while the burst goes out.
+enum zero_step { ZERO_DONE, ZERO_LIST, ZERO_SIDE };
+
+static struct {
+    int      step;
+    int      list;                // ZERO_LIST: zero list playing
+    uint32_t ticket;              // ZERO_SIDE: side_tail reaches it once sent
+    bool     ok;
+} g_zero;
+
+// AWG_RESET=flush: play SHUTDOWN_FLUSH_FRAMES zero-gain frames from the next list.
+static void zero_next_list(void) {
+    int id = ++g_zero.list;
+    if (id >= 2) { g_zero.step = ZERO_DONE; return; }
+    DPRINT("  -> Loading zero-gain frames into List %d.\n", id);
+    if (!load_zero_gain_list(&G.list[id], SHUTDOWN_FLUSH_FRAMES) || !publish_list(id)) {
+        DPRINT("ERROR: Failed to load zero-gain list %d. Aborting.\n", id);
+        reset_list(&G.list[id]);
+        g_zero.ok = false;
+        g_zero.step = ZERO_DONE;
+    }
 }
 
-static void do_reset(){
-    DPRINT("RESET command received. Initiating synchronized zero-gain flush for both lists (silent until complete).\n");
+static void zero_begin(void) {
+    g_zero.ok = true;
+    g_zero.step = ZERO_DONE;
+    if ((G.reset_flush || G.use_dma) && !G.player_thread_running) {
+        DPRINT("ERROR: no player thread, PL banks not zeroed.\n");
+        g_zero.ok = false;
+    } else if (G.reset_flush) {
+        g_zero.step = ZERO_LIST;
+        g_zero.list = -1;
+        zero_next_list();
+    } else if (G.use_dma) {
+        uint32_t w[AWG_RESET_WORDS_MAX];
+        int n = awg_make_reset_words(w);
+        pthread_mutex_lock(&g_direct_mu);
+        bool ok = side_push(w, n, &g_zero.ticket);
+        pthread_mutex_unlock(&g_direct_mu);
+        if (ok) g_zero.step = ZERO_SIDE;
+        else { DPRINT("ERROR: DMA side writes full, RESET burst not sent.\n"); g_zero.ok = false; }
+    } else {
+        int rc = awg_reset_banks();
+        if (rc != 0) { DPRINT("ERROR: awg_reset_banks failed (%d).\n", rc); g_zero.ok = false; }
+    }
+}
 
-    pthread_mutex_lock(&G.mtx);
-    // 1. Stop current playback and fully clear all list data
-    G.playing = false; 
-    G.cur_frame = 0;
+static bool zero_poll(void) {
+    while (g_zero.step == ZERO_LIST && list_state(&G.list[g_zero.list]) == LIST_IDLE) {
+        DPRINT("  -> List %d zero-gain flush complete.\n", g_zero.list);
+        zero_next_list();
+    }
+    if (g_zero.step == ZERO_SIDE &&
+        (int32_t)(__atomic_load_n(&G.side_tail, __ATOMIC_ACQUIRE) - g_zero.ticket) >= 0)
+        g_zero.step = ZERO_DONE;
+    return g_zero.step == ZERO_DONE || g_stop_player;
+}
 
-    // Clear data and state for both lists, preparing to load zero-gain frames
-    clear_list_fully(&G.list[0]);
-    clear_list_fully(&G.list[1]);
-    g_loading_in_progress[0] = false; // Ensure preload status is reset
-    g_loading_in_progress[1] = false;
-    pthread_mutex_unlock(&G.mtx); // Unlock because load_zero_gain_list will also use the mutex, and we need to wait for notifications
+// Synchronous form for startup and shutdown (no reactor running).
+static bool zero_pl_banks(void) {
+    zero_begin();
+    while (!zero_poll()) wait_player_signal();
+    return g_zero.ok;
+}
+
+static void cancel_preload_and_mark_idle(int list_id) {
+    if (list_id < 0 || list_id >= G.n_lists) return;
+    
+    if (list_state(&G.list[list_id]) != LIST_LOADING) return;
+
+    DPRINT("CANCEL preload on list %d -> IDLE (client disconnected)\n", list_id);
+    reset_list(&G.list[list_id]);   // state back to LIST_IDLE, arena kept
+    update_list_status(list_id, LIST_IDLE);
+}
+
+// [MODIFIED] 'Z' / 'X' run as a job that player signals drive forward
+// (on_player_done()), so the reactor never waits for the flush or the
+// zeroing: RESET_FLUSH until the player has dropped everything, then
+// RESET_ZERO until zero_poll() is done, then reset_finish().
+enum reset_step { RESET_FLUSH, RESET_ZERO };
+
+static struct {
+    int      step;
+    uint32_t flush;               // flush request to wait for
+    bool     poweroff;            // 'X': power the board off once silent
+} g_reset;
+
+static void do_reset(queue_session_t *s, bool poweroff){
+    DPRINT("RESET command received. Zeroing both PL banks (%s) for all lists (silent until complete).\n",
+           G.reset_flush ? "zero-list flush" : "fast");
 
     // Ensure the player_thread is running so it can process the subsequent zero-gain playback
     start_player_if_needed(); 
 
-    // --- Phase 1: Flush List 0 with zero-gain frames ---
-    DPRINT("  -> Loading zero-gain frames into List 0.\n");
-    pthread_mutex_lock(&G.mtx); // Re-lock to operate on G.list
-    if (load_zero_gain_list(&G.list[0], SHUTDOWN_FLUSH_FRAMES)) {
-        G.cur_list = 0; // Start playback from List 0
-        G.next_list = 1; // List 1 is ready as the next
-        G.cur_frame = 0; // Start from the first frame of List 0
-        G.playing = true; // Start the player
-
-        // Update internal status, but do NOT send notifications to the client
-        pthread_mutex_lock(&g_notify_mutex);
-        g_list_status[0] = LIST_READY; // Internal status set to READY/PLAYING
-        g_list_status[1] = LIST_IDLE;  // Internal List 1 remains IDLE (waiting to be processed)
-        pthread_mutex_unlock(&g_notify_mutex);
-    } else {
-        DPRINT("ERROR: Failed to load zero-gain list 0 during RESET. Aborting.\n");
-        pthread_mutex_unlock(&G.mtx);
-        // If failed at this point, mark both as IDLE in the final step and return
-        pthread_mutex_lock(&g_notify_mutex);
-        g_list_status[0] = LIST_IDLE; g_list_status[1] = LIST_IDLE;
-        pthread_mutex_unlock(&g_notify_mutex);
-        // Do not call send_status_update here, will be handled at the end
-        return; 
-    }
-    pthread_mutex_unlock(&G.mtx); // Unlock, preparing to wait for notification
-
-    // Wait for List 0 to finish playback and become IDLE
-    DPRINT("  -> Waiting for List 0 to become IDLE (zero-gain flush).\n");
-    while (g_list_status[0] != LIST_IDLE && !g_stop_queue) {
-        usleep(10000); 
-    }
-    DPRINT("  -> List 0 zero-gain flush complete.\n");
-
-    // --- Phase 2: Flush List 1 with zero-gain frames ---
-    DPRINT("  -> Loading zero-gain frames into List 1.\n");
-    pthread_mutex_lock(&G.mtx); // Re-lock to operate on G.list
-    G.playing = false; // Ensure player_thread doesn't suddenly read from old List 1 before configuration
-    if (load_zero_gain_list(&G.list[1], SHUTDOWN_FLUSH_FRAMES)) {
-        G.cur_list = 1; // Set player to start from List 1
-        G.next_list = 0; // List 0 is now idle, serving as the next
-        G.cur_frame = 0; 
-        G.playing = true; // Restart the player
-        
-        // Update internal status, but do NOT send notifications to the client
-        pthread_mutex_lock(&g_notify_mutex);
-        g_list_status[0] = LIST_IDLE;   // Internal List 0 is now IDLE
-        g_list_status[1] = LIST_READY; // Internal List 1 status
-        pthread_mutex_unlock(&g_notify_mutex);
-    } else {
-        DPRINT("ERROR: Failed to load zero-gain list 1 during RESET. Aborting.\n");
-        pthread_mutex_unlock(&G.mtx);
-        // If failed at this point, mark both as IDLE in the final step and return
-        pthread_mutex_lock(&g_notify_mutex);
-        g_list_status[0] = LIST_IDLE; g_list_status[1] = LIST_IDLE;
-        pthread_mutex_unlock(&g_notify_mutex);
-        // Do not call send_status_update here, will be handled at the end
-        return;
-    }
-    pthread_mutex_unlock(&G.mtx); // Unlock, preparing to wait for notification
+    // 1. Stop current playback and drop every queued list; afterwards the network side owns all lists
+    __atomic_store_n(&G.start_rt_ns, 0, __ATOMIC_RELEASE);   // [NEW] and cancel an armed start
+    g_reset.flush    = flush_begin();                          // (drops direct-port overrides too)
+    g_reset.step     = RESET_FLUSH;
+    g_reset.poweroff = poweroff;
+    g_job.job = JOB_RESET;
+    g_job.s = s;
+    signal_done();                // first reset_poll() from the reactor, even without a player
+}
 
-    // Wait for List 1 to finish playback and become IDLE
-    DPRINT("  -> Waiting for List 1 to become IDLE (zero-gain flush).\n");
-    while (g_list_status[1] != LIST_IDLE && !g_stop_queue) {
-        usleep(10000);
+// 2. [MODIFIED] Zero both PL banks (fast single burst, or AWG_RESET=flush)
+static bool reset_poll(void) {
+    if (g_reset.step == RESET_FLUSH) {
+        if (!flush_done(g_reset.flush)) return false;
+        zero_begin();
+        g_reset.step = RESET_ZERO;
     }
-    DPRINT("  -> List 1 zero-gain flush complete.\n");
-
-    // --- Final internal state cleanup after both lists are flushed ---
-    pthread_mutex_lock(&G.mtx);
-    G.playing = false; // Ensure player stops after zero-gain frames are played
-    clear_list_fully(&G.list[0]); // Clear zero-gain List 0 (now it's IDLE)
-    clear_list_fully(&G.list[1]); // Clear zero-gain List 1 (now it's IDLE)
-    g_loading_in_progress[0] = false;
-    g_loading_in_progress[1] = false;
-    pthread_mutex_unlock(&G.mtx);
-
-    // --- ONLY NOW send the final IDLE notifications to the client ---
-    // This ensures the client receives IDLE status only after all zeroing operations are complete
-    pthread_mutex_lock(&g_notify_mutex);
-    g_list_status[0] = LIST_IDLE; 
-    g_list_status[1] = LIST_IDLE;
-    pthread_mutex_unlock(&g_notify_mutex);
-    
-    send_status_update(0);
-    send_status_update(1);
-    DPRINT("RESET command fully processed: both lists flushed and now truly IDLE. Notifications sent.\n");
+    return zero_poll();
 }
 
-static bool do_preload_begin(uint8_t list_id, uint32_t total_frames){
-    if (list_id > 1) return false;
-    if (total_frames == 0 || total_frames > 2000000) { 
+// total_words: words the client will push in total (0 = unknown, 'B' command)
+// period_us:   frame period of this list (0 = global period, 'N' command)
+static bool do_preload_begin(uint8_t list_id, uint32_t total_frames, uint32_t total_words,
+                             uint32_t period_us){
+    if (list_id >= G.n_lists) return false;
+    if (total_frames == 0 || total_frames > MAX_LIST_FRAMES) {
         DPRINT("ERROR: Invalid total_frames (%u) in BEGIN command for list %u.\n", total_frames, (unsigned)list_id);
         return false;
     }
+    if (total_words > (uint64_t)total_frames * MAX_WORDS_PER_FRAME) {
+        DPRINT("ERROR: Invalid total_words (%u) in BEGIN command for list %u.\n", total_words, (unsigned)list_id);
+        return false;
+    }
+    if (period_us && (period_us < MIN_PERIOD_US || period_us > MAX_PERIOD_US)) {
+        DPRINT("ERROR: Invalid period_us (%u) in BEGIN command for list %u.\n", period_us, (unsigned)list_id);
+        return false;
+    }
+    if (list_state(&G.list[list_id]) == LIST_READY) {
+        DPRINT("ERROR: BEGIN for list %u while it is queued/playing.\n", (unsigned)list_id);
+        return false;
+    }
 
     DPRINT("BEGIN for list %u with %u frames.\n", (unsigned)list_id, total_frames);
     
-    pthread_mutex_lock(&G.mtx);
-    bool ok = prepare_list_for_preload(&G.list[list_id], total_frames);
-    pthread_mutex_unlock(&G.mtx);
+    bool ok = prepare_list_for_preload(&G.list[list_id], total_frames, total_words);
     
     if (ok) {
-        g_loading_in_progress[list_id] = true;
-        pthread_mutex_lock(&g_notify_mutex);
-        g_list_status[list_id] = LIST_LOADING;
-        pthread_mutex_unlock(&g_notify_mutex);
-        send_status_update(list_id);
+        G.list[list_id].period_us = period_us;
+        list_set_state(&G.list[list_id], LIST_LOADING);
+        update_list_status(list_id, LIST_LOADING);
     }
     return ok;
 }
 
 // --- [MODIFIED] do_preload_push function with conditional logging ---
-static bool do_preload_push(int fd) {
+static bool do_preload_push(awg_reader_t *rd) {
     uint8_t hdr[3];
-    int rc = read_n_timeout(fd, hdr, 3, IO_TIMEOUT_MS);
+    int rc = awg_reader_read(rd, hdr, 3, -1);
     if (rc <= 0) {
         if (rc == -2) DPRINT("Timeout while reading PUSH header.\n");
         return false;
@@ -536,13 +1495,13 @@ static bool do_preload_push(int fd) {
     DPRINT("PUSH Hdr Decoded -> list_id: %u, be_count: 0x%04X, host_count: %u\n", 
            (unsigned)list_id, be_count, count);
 
-    if (list_id > 1 || count == 0 || count > MAX_WORDS_PER_FRAME) {
+    if (list_id >= G.n_lists || count == 0 || count > MAX_WORDS_PER_FRAME) {
         DPRINT("ERROR: Invalid header in PUSH command.\n");
         return false;
     }
     
     uint32_t network_order_tmp[MAX_WORDS_PER_FRAME];
-    rc = read_n_timeout(fd, network_order_tmp, count * 4, IO_TIMEOUT_MS);
+    rc = awg_reader_read(rd, network_order_tmp, count * 4, -1);
     if (rc <= 0) {
         if (rc == -2) DPRINT("Timeout while reading PUSH payload.\n");
         return false;
@@ -561,8 +1520,11 @@ static bool do_preload_push(int fd) {
     }
 #endif
 
-    pthread_mutex_lock(&G.mtx);
     awg_list_t *L = &G.list[list_id];
+    if (list_state(L) != LIST_LOADING) {
+        DPRINT("ERROR: PUSH to list %u which is not LOADING.\n", (unsigned)list_id);
+        return false;
+    }
     
     DPRINT("List %u status before push: %u/%u frames loaded.\n", (unsigned)list_id, L->loaded_frames, L->total_frames);
 
@@ -570,187 +1532,1188 @@ static bool do_preload_push(int fd) {
 
     if (ok && L->loaded_frames == L->total_frames) {
         DPRINT("List %u is now fully loaded. Marking as READY.\n", (unsigned)list_id);
-        L->ready = true;
-        g_loading_in_progress[list_id] = false; 
-        
-        pthread_mutex_lock(&g_notify_mutex);
-        g_list_status[list_id] = LIST_READY;
-        pthread_mutex_unlock(&g_notify_mutex);
-        send_status_update(list_id);
-        
-        if (!G.playing) {
-            DPRINT("This is the first ready list. Auto-starting player...\n");
-            G.playing = true; 
-            G.cur_list = list_id; 
-            G.next_list = 1 - list_id; 
-            G.cur_frame = 0;
-            start_player_if_needed();
-        }
+        update_list_status(list_id, LIST_READY);
+        ok = publish_list(list_id);   // the player picks it up on its next tick
     }
-    pthread_mutex_unlock(&G.mtx);
     return ok;
 }
 
 
+// --- [NEW] Bulk PUSH: many frames in one command ---
+// 'M' list_id(1) n_frames(4) counts(n_frames*2) words(sum(counts)*4), all big-endian.
+// [MODIFIED] 'M' and 'D'/'d' bodies have no size limit, so they are parsed
+// as they arrive (bulk_state_t) instead of with blocking reads: an upload
+// never holds the reactor while its client is slow. The count table is
+// indexed as it comes; the payload is received straight into the list arena
+// and byte-swapped in place; the frames become visible only once complete.
+// Common to 'M' 'D' 'd': header bytes are buffered (session_need).
+static bool bulk_begin(queue_session_t *s, uint8_t op) {
+    uint8_t hdr[5];
+    if (awg_reader_read(&s->rd, hdr, 5, -1) <= 0) return false;
+    uint8_t  list_id = hdr[0];
+    uint32_t be_n; memcpy(&be_n, &hdr[1], sizeof(be_n));
+    uint32_t n = be32_to_host(be_n);
+    const char *what = op == 'M' ? "bulk" : "delta";
+    (void)what;                                   // DPRINT only
+
+    if (list_id >= G.n_lists) {
+        DPRINT("ERROR: Invalid list_id %u in %s PUSH.\n", (unsigned)list_id, what);
+        return false;
+    }
+    awg_list_t *L = &G.list[list_id];
+    if (list_state(L) != LIST_LOADING) {
+        DPRINT("ERROR: %s PUSH to list %u which is not LOADING.\n", what, (unsigned)list_id);
+        return false;
+    }
+    if (n == 0 || n > L->total_frames - L->loaded_frames) {
+        DPRINT("ERROR: %s PUSH of %u frames does not fit list %u (%u/%u).\n",
+               what, n, (unsigned)list_id, L->loaded_frames, L->total_frames);
+        return false;
+    }
+    memset(&s->bulk, 0, sizeof(s->bulk));
+    s->bulk.op      = op;
+    s->bulk.list_id = list_id;
+    s->bulk.frames  = n;
+    s->bulk.pos     = L->words_used;
+    return true;
+}
+
+static bool bulk_finish(awg_list_t *L, uint8_t list_id) {
+    if (L->loaded_frames == L->total_frames) {
+        DPRINT("List %u is now fully loaded. Marking as READY.\n", (unsigned)list_id);
+        update_list_status(list_id, LIST_READY);
+        return publish_list(list_id);
+    }
+    return true;
+}
+
+// 1 = command complete, 0 = needs more bytes, -1 = bad command. Socket reads
+// into the arena are charged to *budget.
+static int bulk_push_step(queue_session_t *s, size_t *budget) {
+    awg_reader_t *rd = &s->rd;
+    bulk_state_t *b = &s->bulk;
+    awg_list_t *L = &G.list[b->list_id];
+
+    // Count table -> frame index of the new frames
+    if (b->done < b->frames) {
+        uint32_t avail = (uint32_t)(awg_reader_buffered(rd) / sizeof(uint16_t));
+        uint32_t take  = b->frames - b->done < avail ? b->frames - b->done : avail;
+        const uint8_t *p = awg_reader_peek(rd);
+        for (uint32_t k = 0; k < take; ++k, ++b->done) {
+            uint16_t be; memcpy(&be, p + 2 * k, sizeof(be));
+            uint16_t c = be16_to_host(be);
+            if (c == 0 || c > MAX_WORDS_PER_FRAME) {
+                DPRINT("ERROR: bulk PUSH frame %u has invalid count %u.\n", b->done, (unsigned)c);
+                return -1;
+            }
+            if (!index_frame(L, L->loaded_frames + b->done, c)) return -1;
+            b->pos += c;
+        }
+        awg_reader_consume(rd, (size_t)take * sizeof(uint16_t));
+        if (b->done < b->frames) return 0;
+        if (!ensure_words_cap(L, b->pos - L->words_used)) return -1;
+    }
+
+    // Words -> words[] arena
+    uint32_t total = b->pos - L->words_used;
+    uint32_t *w = &L->words[L->words_used];
+    size_t bytes = (size_t)total * sizeof(uint32_t);
+    while (b->bytes < bytes) {
+        size_t left = bytes - b->bytes, have = awg_reader_buffered(rd);
+        if (have) {
+            size_t take = have < left ? have : left;
+            memcpy((uint8_t *)w + b->bytes, awg_reader_peek(rd), take);
+            awg_reader_consume(rd, take);
+            b->bytes += take;
+        } else {
+            if (*budget == 0) return 0;
+            int got = awg_reader_recv_nb(rd, (uint8_t *)w + b->bytes, left < *budget ? left : *budget);
+            if (got == -3) return 0;
+            if (got <= 0) return -1;
+            b->bytes += (size_t)got;
+            *budget  -= (size_t)got;
+        }
+        uint32_t whole = (uint32_t)(b->bytes / sizeof(uint32_t));
+        for (; b->swapped < whole; ++b->swapped) w[b->swapped] = be32_to_host(w[b->swapped]);
+    }
+
+    L->words_used     = b->pos;
+    L->loaded_frames += b->frames;
+    L->delta.full_left = 2;   // as push_frame: raw words desync the delta mirror
+    DPRINT("Bulk PUSH: %u frames / %u words into list %u (%u/%u).\n",
+           b->frames, total, (unsigned)b->list_id, L->loaded_frames, L->total_frames);
+    return bulk_finish(L, b->list_id) ? 1 : -1;
+}
+
+// --- [NEW] Delta PUSH ---
+// 'D' list_id(1) n_frames(4), then per frame:
+//   idx_mask(2) gain_mask(2) idx[popcount(idx_mask)](4 each) gain[popcount(gain_mask)](4 each)
+// Mask bit t = ch*8 + tone; values are the 20-bit INDEX/GAIN data. Only
+// changed slots travel; the server expands them (see delta_state_t).
+// [NEW] 'd' (wide): same with idx_mask(4) gain_mask(4), bit t = ch*16 + tone,
+// for tones 8..15 of a 16-tone build.
+// [MODIFIED] Frames are taken as soon as each one is buffered (see 'M').
+static inline uint32_t delta_mask_widen(uint16_t m) {
+    return (m & 0xFFu) | ((uint32_t)(m >> 8) << AWG_MAX_TONES);
+}
+
+static int delta_push_step(queue_session_t *s) {
+    awg_reader_t *rd = &s->rd;
+    bulk_state_t *b = &s->bulk;
+    awg_list_t *L = &G.list[b->list_id];
+    bool wide = b->op == 'd';
+    size_t mask_bytes = wide ? 8 : 4;
+
+    for (; b->done < b->frames; ++b->done) {
+        size_t have = awg_reader_buffered(rd);
+        if (have < mask_bytes) return 0;
+        const uint8_t *p = awg_reader_peek(rd);
+        uint32_t im, gm;
+        if (wide) {
+            uint32_t masks[2];
+            memcpy(masks, p, sizeof(masks));
+            im = be32_to_host(masks[0]);
+            gm = be32_to_host(masks[1]);
+            if ((im | gm) & ~delta_tone_mask()) {
+                DPRINT("ERROR: delta PUSH masks 0x%08X/0x%08X address tones this PL lacks.\n", im, gm);
+                return -1;
+            }
+        } else {
+            uint16_t masks[2];
+            memcpy(masks, p, sizeof(masks));
+            im = delta_mask_widen(be16_to_host(masks[0]));
+            gm = delta_mask_widen(be16_to_host(masks[1]));
+        }
+        int ni = __builtin_popcount(im), ng = __builtin_popcount(gm);
+        size_t len = mask_bytes + (size_t)(ni + ng) * sizeof(uint32_t);
+        if (have < len) return 0;                 // at most 264 bytes: fits the reader buffer
+
+        uint32_t val[2 * DELTA_SLOTS];
+        memcpy(val, p + mask_bytes, len - mask_bytes);
+        for (int i = 0; i < ni + ng; ++i) val[i] = be32_to_host(val[i]);
+        awg_reader_consume(rd, len);
+        if (!push_delta_frame(L, im, val, gm, val + ni)) return -1;
+    }
+    DPRINT("Delta PUSH: %u frames into list %u (%u/%u, %u words).\n",
+           b->frames, (unsigned)b->list_id, L->loaded_frames, L->total_frames, L->words_used);
+    return bulk_finish(L, b->list_id) ? 1 : -1;
+}
+
+// Continue the body of the session's 'M' / 'D' / 'd'; clears it when done.
+static int bulk_step(queue_session_t *s, size_t *budget) {
+    int r = s->bulk.op == 'M' ? bulk_push_step(s, budget) : delta_push_step(s);
+    if (r != 0) s->bulk.op = 0;
+    return r;
+}
+
 static bool do_preload_end(uint8_t list_id) {
-    if (list_id > 1) return false;
+    if (list_id >= G.n_lists) return false;
     DPRINT("END received for list %u.\n", (unsigned)list_id);
     
-    g_loading_in_progress[list_id] = false;
-
-    pthread_mutex_lock(&G.mtx);
     awg_list_t *L = &G.list[list_id];
-    if (L->loaded_frames == 0){ 
+    int st = list_state(L);
+    if (st == LIST_READY) {
+        DPRINT("List %u already READY (auto-published on last PUSH).\n", (unsigned)list_id);
+        return true;
+    }
+    if (st != LIST_LOADING || L->loaded_frames == 0){ 
         DPRINT("ERROR: END received for an empty list %u.\n", (unsigned)list_id);
-        pthread_mutex_unlock(&G.mtx); 
         return false; 
     }
-    if (!L->ready){ 
-        DPRINT("List %u marked as READY by END command.\n", (unsigned)list_id);
-        L->ready = true; 
+
+    DPRINT("List %u marked as READY by END command.\n", (unsigned)list_id);
+    update_list_status(list_id, LIST_READY);
+    return publish_list(list_id);
+}
+
+// [NEW] Worker thread for the blocking part of a job (file writes) and for
+// the library scan of 'l': the reactor posts them under mu, the worker
+// answers through efd.
+static struct {
+    pthread_t       th;
+    bool            running;
+    pthread_mutex_t mu;
+    pthread_cond_t  cv;
+    int             efd;          // worker -> reactor: posted job finished
+    bool            posted;       // under mu
+    bool            stop;         // under mu
+    char            name[AWG_LIST_NAME_MAX + 1];
+    awg_list_file_t src;
+    int             rc;
+    bool            scan_posted;  // [NEW] 'l': read the library headers (under mu)
+    int             scan_found;
+    awg_list_file_info_t scan_info[LIBRARY_LIST_MAX];
+} g_worker = { .mu = PTHREAD_MUTEX_INITIALIZER, .cv = PTHREAD_COND_INITIALIZER, .efd = -1 };
+
+static void *worker_thread(void *arg) {
+    (void)arg;
+    prctl(PR_SET_NAME, "awg_worker", 0, 0, 0);
+    pthread_mutex_lock(&g_worker.mu);
+    for (;;) {
+        while (!g_worker.posted && !g_worker.scan_posted && !g_worker.stop)
+            pthread_cond_wait(&g_worker.cv, &g_worker.mu);
+        if (g_worker.posted) {
+            pthread_mutex_unlock(&g_worker.mu);
+            int rc = awg_list_file_store(g_worker.name, &g_worker.src);
+            pthread_mutex_lock(&g_worker.mu);
+            g_worker.rc = rc;
+            g_worker.posted = false;
+        } else if (g_worker.scan_posted) {
+            pthread_mutex_unlock(&g_worker.mu);
+            int found = awg_list_file_scan(g_worker.scan_info, LIBRARY_LIST_MAX);
+            pthread_mutex_lock(&g_worker.mu);
+            g_worker.scan_found = found;
+            g_worker.scan_posted = false;
+        } else {
+            break;                                // stop, nothing left to do
+        }
+        efd_signal(g_worker.efd);
+    }
+    pthread_mutex_unlock(&g_worker.mu);
+    return NULL;
+}
+
+// --- [NEW] 'S' STORE list_id(1) name_len(1) name: save a complete list ---
+// Allowed once every frame is loaded (READY, or IDLE after playing) and
+// until the list is reset or re-BEGUN; the player only reads it meanwhile.
+// [MODIFIED] The file is written by the worker thread; once it is on disk
+// the client gets status(1): 0 stored, 1 bad name, 2 I/O error (see
+// store_finish()). Until then owner commands wait, so nothing rewrites the list.
+static bool do_store(queue_session_t *s, uint8_t list_id, const char *name) {
+    if (list_id >= G.n_lists) return false;
+    awg_list_t *L = &G.list[list_id];
+    if (list_state(L) == LIST_LOADING || L->loaded_frames == 0 || L->loaded_frames != L->total_frames) {
+        DPRINT("ERROR: STORE for list %u which is not fully loaded.\n", (unsigned)list_id);
+        return false;
+    }
+    if (L->has_gen) {         // [NEW] nothing to store: re-send its 'F' descriptor instead
+        DPRINT("ERROR: STORE for generated list %u.\n", (unsigned)list_id);
+        return false;
     }
+    if (!g_worker.running) { DPRINT("ERROR: STORE without a worker thread.\n"); return false; }
+    awg_list_file_t f = {
+        .frames      = L->loaded_frames,
+        .words       = L->words_used,
+        .period_us   = L->period_us,
+        .repeat      = __atomic_load_n(&L->repeat, __ATOMIC_RELAXED),
+        .flags       = L->has_delta ? AWG_LIST_FILE_DELTA : 0,
+        .frame_words = L->frame_words,
+        .starts      = L->frame_words ? NULL : L->starts,
+        .wordv       = L->words,
+    };
+    pthread_mutex_lock(&g_worker.mu);
+    snprintf(g_worker.name, sizeof(g_worker.name), "%s", name);
+    g_worker.src    = f;
+    g_worker.posted = true;
+    pthread_cond_signal(&g_worker.cv);
+    pthread_mutex_unlock(&g_worker.mu);
+    g_job.job = JOB_STORE;
+    g_job.s = s;
+    g_job.list_id = list_id;
+    DPRINT("STORE list %u -> '%s' (%u frames) started.\n", (unsigned)list_id, name, f.frames);
+    return true;
+}
 
-    pthread_mutex_lock(&g_notify_mutex);
-    g_list_status[list_id] = LIST_READY;
-    pthread_mutex_unlock(&g_notify_mutex);
-    send_status_update(list_id);
+// --- [NEW] 'L' LOAD list_id(1) name_len(1) name: map a stored list and queue it ---
+// GPIO player: the frame index and words are used straight from the mapping.
+// DMA player: the words are copied once into the list's CMA slice.
+static bool do_load(uint8_t list_id, const char *name) {
+    if (list_id >= G.n_lists) return false;
+    awg_list_t *L = &G.list[list_id];
+    if (list_state(L) != LIST_IDLE) {
+        DPRINT("ERROR: LOAD into list %u while it is loading/queued/playing.\n", (unsigned)list_id);
+        return false;
+    }
+    awg_list_file_t f;
+    int rc = awg_list_file_load(name, MAX_WORDS_PER_FRAME, &f);
+    if (rc == 0 && f.period_us && (f.period_us < MIN_PERIOD_US || f.period_us > MAX_PERIOD_US)) rc = -3;
+    if (rc == 0 && G.use_dma && f.words > G.dma_slice_words - DMA_HDR_WORDS) rc = -4;
+    if (rc != 0) {
+        DPRINT("ERROR: LOAD '%s' into list %u failed (%d).\n", name, (unsigned)list_id, rc);
+        awg_list_file_unmap(&f);
+        return false;
+    }
 
-    if (!G.playing) {
-        DPRINT("This is the first ready list. Auto-starting player after END.\n");
-        G.playing = true; 
-        G.cur_list = list_id; 
-        G.next_list = 1 - list_id; 
-        G.cur_frame = 0;
-        start_player_if_needed();
+    reset_list(L);
+    release_list_file(L);
+    L->arena_starts = L->starts;
+    L->starts = (uint32_t *)f.starts;        // read-only mapping: never pushed to (IDLE/READY)
+    if (G.use_dma) {
+        attach_dma_slice(L);
+        memcpy(L->words, f.wordv, (size_t)f.words * sizeof(uint32_t));
+    } else {
+        L->arena_words = L->words;
+        L->words = (uint32_t *)f.wordv;
     }
-    pthread_mutex_unlock(&G.mtx);
+    L->file          = f;
+    L->total_frames  = f.frames;
+    L->loaded_frames = f.frames;
+    L->frame_words   = (uint16_t)f.frame_words;
+    L->words_used    = f.words;
+    L->period_us     = f.period_us;
+    L->repeat        = f.repeat;
+    L->has_delta     = (f.flags & AWG_LIST_FILE_DELTA) != 0;
+
+    DPRINT("LOAD '%s' -> list %u (%u frames, %u words), READY.\n", name, (unsigned)list_id, f.frames, f.words);
+    update_list_status(list_id, LIST_READY);
+    return publish_list(list_id);
+}
+
+static bool read_list_name(awg_reader_t *rd, uint8_t *list_id, char *name) {
+    uint8_t b[2];
+    if (awg_reader_read(rd, b, 2, -1) <= 0) return false;
+    if (b[1] == 0 || b[1] > AWG_LIST_NAME_MAX) { DPRINT("ERROR: Invalid list name length %u.\n", (unsigned)b[1]); return false; }
+    if (awg_reader_read(rd, name, b[1], -1) <= 0) return false;
+    name[b[1]] = '\0';
+    *list_id = b[0];
     return true;
 }
 
-static void serve_client(int fd){
-    DPRINT("client connected (fd=%d)\n", fd);
-    g_loading_in_progress[0] = false;
-    g_loading_in_progress[1] = false;
+// --- [NEW] 'I': take every descriptor queued in the shm ingest region ---
+// GPIO player: words[] stays in the slot (only a variable frame index is
+// copied). DMA player: the words are copied once into the list's CMA slice
+// and the slot goes straight back. MAX_FRAMES-like bounds as for BEGIN.
+static bool ingest_one(const awg_shm_desc_t *d) {
+    int rc = awg_shm_check(d, MAX_WORDS_PER_FRAME, MAX_LIST_FRAMES);
+    if (rc == 0 && d->list_id >= (uint32_t)G.n_lists) rc = -1;
+    if (rc == 0 && d->period_us && (d->period_us < MIN_PERIOD_US || d->period_us > MAX_PERIOD_US)) rc = -3;
+    if (rc == 0 && G.use_dma && d->words > G.dma_slice_words - DMA_HDR_WORDS) rc = -4;
+    bool held = false;                     // a slot we play from was queued again
+    for (int id = 0; rc == 0 && id < G.n_lists; ++id)
+        held |= G.list[id].shm_attached && G.list[id].shm_slot == d->slot;
+    if (held) rc = -1;
+    awg_list_t *L = rc == 0 ? &G.list[d->list_id] : NULL;
+    if (L && list_state(L) != LIST_IDLE) rc = -5;
+    if (rc != 0) {
+        DPRINT("ERROR: ingest of slot %u into list %u rejected (%d).\n", d->slot, d->list_id, rc);
+        if (!held) awg_shm_release(d->slot);
+        return false;
+    }
+
+    reset_list(L);
+    release_list_file(L);
+    L->total_frames = d->frames;
+    if (!d->frame_words && (!reserve_starts(L, d->frames + 1) ||
+                            !awg_shm_copy_index(d, L->starts, MAX_WORDS_PER_FRAME))) {
+        DPRINT("ERROR: ingest slot %u: frame index does not tile its %u words.\n", d->slot, d->words);
+        reset_list(L);
+        awg_shm_release(d->slot);
+        return false;
+    }
+    if (G.use_dma) {
+        attach_dma_slice(L);
+        memcpy(L->words, awg_shm_words(d->slot), (size_t)d->words * sizeof(uint32_t));
+        awg_shm_release(d->slot);
+    } else {
+        L->arena_words  = L->words;
+        L->words        = (uint32_t *)awg_shm_words(d->slot);   // read-only for us (IDLE/READY)
+        L->shm_attached = true;
+        L->shm_slot     = d->slot;
+    }
+    L->loaded_frames = d->frames;
+    L->frame_words   = (uint16_t)d->frame_words;
+    L->words_used    = d->words;
+    L->period_us     = d->period_us;
+    L->repeat        = d->repeat;
+    L->has_delta     = (d->flags & AWG_LIST_FILE_DELTA) != 0;
+
+    DPRINT("INGEST slot %u -> list %u (%u frames, %u words), READY.\n", d->slot, d->list_id, d->frames, d->words);
+    update_list_status((int)d->list_id, LIST_READY);
+    return publish_list((int)d->list_id);
+}
 
-    for(;;){
-        uint8_t op;
-        int rc = read_n_timeout(fd, &op, 1, IO_TIMEOUT_MS);
-        if (rc <= 0) { 
-            if (rc == -2) DPRINT("Timeout waiting for command from client.\n");
-            else DPRINT("read_n_timeout returned %d, client likely disconnected.\n", rc);
-            break; 
+static bool do_ingest(void) {
+    if (!awg_shm_active()) { DPRINT("ERROR: INGEST without a shm region (AWG_SHM_SLOTS=0).\n"); return false; }
+    awg_shm_desc_t d;
+    bool ok = true;
+    while (awg_shm_pop(&d) == 1) ok = ingest_one(&d) && ok;   // keep the ring drained
+    return ok;
+}
+
+// --- [NEW] 'F' GENERATE: list_id(1) frames(4) repeat(4) period_us(4) n(1),
+// then n ramps: slot(1) idx_start(4) idx_stop(4) idx_step(4) gain_start(4)
+// gain_stop(4) gain_step(4), steps signed in 1/65536 LSB per frame, slot =
+// ch*16 + tone as for 'd'. The list is READY at once; the GPIO player
+// synthesizes each frame at its tick (no arena), the DMA player needs the
+// words in memory, so there they are expanded once into the CMA slice.
+#define GEN_RAMP_BYTES 25
+
+static bool do_generate(awg_reader_t *rd) {
+    uint8_t h[14];
+    if (awg_reader_read(rd, h, sizeof(h), -1) <= 0) return false;
+    uint8_t list_id = h[0];
+    uint32_t frames, repeat, period_us;
+    memcpy(&frames, &h[1], 4);    frames    = be32_to_host(frames);
+    memcpy(&repeat, &h[5], 4);    repeat    = be32_to_host(repeat);
+    memcpy(&period_us, &h[9], 4); period_us = be32_to_host(period_us);
+    uint8_t n = h[13];
+    if (n > DELTA_SLOTS) { DPRINT("ERROR: GENERATE with %u ramps.\n", (unsigned)n); return false; }
+
+    gen_desc_t g;
+    memset(&g, 0, sizeof(g));
+    for (int k = 0; k < n; ++k) {
+        uint8_t b[GEN_RAMP_BYTES];
+        if (awg_reader_read(rd, b, sizeof(b), -1) <= 0) return false;
+        uint32_t v[6];
+        memcpy(v, &b[1], sizeof(v));
+        for (int j = 0; j < 6; ++j) v[j] = be32_to_host(v[j]);
+        if (b[0] >= DELTA_SLOTS || !(delta_tone_mask() & (1u << b[0])) ||
+            v[0] > 0xFFFFFu || v[1] > 0xFFFFFu || v[3] > 0xFFFFFu || v[4] > 0xFFFFFu) {
+            DPRINT("ERROR: GENERATE ramp for slot %u out of range.\n", (unsigned)b[0]);
+            return false;
         }
-        switch(op){
-            case 'B': {
-                uint8_t b[5]; 
-                rc = read_n_timeout(fd,b,5,IO_TIMEOUT_MS);
-                if(rc <= 0) goto drop;
-                uint32_t tf; memcpy(&tf, &b[1], sizeof(tf));
-                if (!do_preload_begin(b[0], be32_to_host(tf))) goto drop;
-            } break;
-            case 'P': {
-                if (!do_preload_push(fd)) goto drop; 
-            } break;
-            case 'E': {
-                uint8_t id; 
-                rc = read_n_timeout(fd,&id,1,IO_TIMEOUT_MS);
-                if(rc <= 0) goto drop;
-                if (!do_preload_end(id)) goto drop;
-            } break;
-            case 'Z': do_reset(); break;
-            case 'X': {
-                DPRINT("SHUTDOWN command received. Initiating system poweroff.\n");
-                do_reset(); 
-                system("poweroff");
-                goto drop;
-            } break;
-            default: 
-                DPRINT("ERROR: Unknown command received: 0x%02X\n", op);
-                goto drop;
+        g.idx[b[0]]  = (gen_ramp_t){ v[0], v[1], (int32_t)v[2] };
+        g.gain[b[0]] = (gen_ramp_t){ v[3], v[4], (int32_t)v[5] };
+    }
+
+    if (list_id >= G.n_lists) return false;
+    if (frames == 0 || frames > MAX_LIST_FRAMES) {
+        DPRINT("ERROR: Invalid frames (%u) in GENERATE for list %u.\n", frames, (unsigned)list_id);
+        return false;
+    }
+    if (period_us && (period_us < MIN_PERIOD_US || period_us > MAX_PERIOD_US)) return false;
+    awg_list_t *L = &G.list[list_id];
+    if (list_state(L) != LIST_IDLE) {
+        DPRINT("ERROR: GENERATE into list %u while it is loading/queued/playing.\n", (unsigned)list_id);
+        return false;
+    }
+    uint16_t fw = (uint16_t)(4 * awg_tones() + 1);
+    if (G.use_dma) {
+        if (!prepare_list_for_preload(L, frames, 0) || (uint64_t)frames * fw > L->words_cap) {
+            DPRINT("ERROR: GENERATE: %u frames do not fit the CMA slice.\n", frames);
+            reset_list(L);
+            return false;
         }
+        for (uint32_t i = 0; i < frames; ++i) gen_frame(&g, i, &L->words[(size_t)i * fw]);
+        L->words_used = frames * fw;
+    } else {
+        reset_list(L);
+        release_list_file(L);
+        L->total_frames = frames;
+        L->gen          = g;
+        L->has_gen      = true;
     }
-drop:
-    if (g_loading_in_progress[0]) cancel_preload_and_mark_idle(0);
-    if (g_loading_in_progress[1]) cancel_preload_and_mark_idle(1);
+    L->loaded_frames = frames;
+    L->frame_words   = fw;
+    L->period_us     = period_us;
+    L->repeat        = repeat;
+
+    DPRINT("GENERATE list %u: %u frames from %u ramps%s, READY.\n", (unsigned)list_id, frames, (unsigned)n,
+           G.use_dma ? " (expanded into CMA)" : "");
+    update_list_status(list_id, LIST_READY);
+    return publish_list(list_id);
+}
 
-    DPRINT("client disconnected (fd=%d)\n", fd);
-    close(fd);
+// --- [NEW] SET_PERIOD: global frame period, picked up at the next tick ---
+static bool do_set_period(uint32_t period_us) {
+    if (period_us < MIN_PERIOD_US || period_us > MAX_PERIOD_US) {
+        DPRINT("ERROR: SET_PERIOD %u us out of range (%u..%u).\n", period_us, MIN_PERIOD_US, MAX_PERIOD_US);
+        return false;
+    }
+    DPRINT("SET_PERIOD -> %u us.\n", period_us);
+    __atomic_store_n(&G.period_us, period_us, __ATOMIC_RELAXED);
+    return true;
 }
 
-// --- [MODIFIED] Make the accept loop more robust on error ---
-static void* accept_loop_queue(void *arg) {
-    (void)arg;
-    while(!g_stop_queue){
-        int fd = accept(g_listen_queue, NULL, NULL);
-        if (fd < 0){
+// --- [NEW] Port 9000 and UDP frames (reactor and UDP threads, see awg_server_raw_shared.h) ---
+static void override_publish(void) {
+    uint32_t s = G.ovr_seq;
+    __atomic_store_n(&G.ovr_seq, s + 1, __ATOMIC_RELAXED);     // odd: writing
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(&G.ovr, &g_ovr_master, sizeof(G.ovr));
+    __atomic_store_n(&G.ovr_seq, s + 2, __ATOMIC_RELEASE);
+}
+
+// Merge one frame into the override set, all or nothing.
+static int override_merge(const uint32_t *words, int count) {
+    for (int i = 0; i < count; ++i) {
+        uint32_t cmd = words[i] >> 28, tone = ((words[i] >> 24) & 7u) | ((words[i] >> 20) & 8u);
+        bool slot_cmd = cmd == 0x1 || cmd == 0x2 || cmd == AWG_CMD_RELEASE;
+        if (!(slot_cmd || cmd == 0xF) || (slot_cmd && (int)tone >= awg_tones())) return -5;
+    }
+    uint32_t epoch = __atomic_load_n(&G.ovr_epoch, __ATOMIC_ACQUIRE);
+    if (epoch != g_ovr_epoch) { memset(&g_ovr_master, 0, sizeof(g_ovr_master)); g_ovr_epoch = epoch; }
+
+    override_set_t *o = &g_ovr_master;
+    for (int i = 0; i < count; ++i) {
+        uint32_t w = words[i], cmd = w >> 28, t = word_slot(w);
+        if (cmd == 0x1) { o->idx[t]  = w & 0xFFFFFu; o->idx_mask  |= 1u << t; }
+        if (cmd == 0x2) { o->gain[t] = w & 0xFFFFFu; o->gain_mask |= 1u << t; }
+        if (cmd == AWG_CMD_RELEASE) {
+            if (w & AWG_RELEASE_ALL)   { o->idx_mask = o->gain_mask = 0; continue; }
+            if (w & AWG_RELEASE_INDEX) o->idx_mask  &= ~(1u << t);
+            if (w & AWG_RELEASE_GAIN)  o->gain_mask &= ~(1u << t);
+        }
+    }
+    override_publish();
+    return 0;
+}
+
+// [MODIFIED] DMA backend: never the GPIO feed. An idle DMA player sends the
+// frame as a side write (-7 if that ring is full); while it streams a list
+// the frame is rejected (-6), there is no way into a running transfer.
+static int direct_frame_locked(const uint32_t *words, int count) {
+    if (!G.player_thread_running) return G.use_dma ? -6 : awg_send_words32_burst(words, count);
+    __atomic_store_n(&G.direct_busy, 1, __ATOMIC_SEQ_CST);
+    if (!__atomic_load_n(&G.playing, __ATOMIC_SEQ_CST)) {      // idle player: write it ourselves
+        int rc = !G.use_dma ? awg_send_words32_burst(words, count)
+                            : side_push(words, count, NULL) ? 0 : -7;
+        __atomic_store_n(&G.direct_busy, 0, __ATOMIC_RELEASE);
+        return rc;
+    }
+    __atomic_store_n(&G.direct_busy, 0, __ATOMIC_RELEASE);
+    return G.use_dma ? -6 : override_merge(words, count);
+}
+
+// [NEW] main(): with the DMA backend stop_queue_server() already zeroed the
+// banks through the DMA, and the GPIO feed does not reach the PL.
+bool queue_server_uses_dma(void) {
+    return G.use_dma;
+}
+
+// Serialized: one direct burst (or merge) at a time across both callers
+int queue_direct_frame(const uint32_t *words, int count) {
+    pthread_mutex_lock(&g_direct_mu);
+    int rc = direct_frame_locked(words, count);
+    pthread_mutex_unlock(&g_direct_mu);
+    return rc;
+}
+
+// --- [NEW] 'A' START_AT: mode(1) start_ns(8), CLOCK_REALTIME ns since the epoch ---
+// The next list the player starts (from idle, or at the next list switch) goes
+// on air at start_ns; 0 cancels. Boards with PTP-disciplined system clocks
+// start within the clock error; with START_TRIG the PL gate also holds frame
+// 0's COMMIT for the shared trigger line, which the START_LEAD board drives
+// with its own COMMIT, so all boards commit on the same edge. On the GPIO
+// path a follower keeps writing frames 1, 2 at the period grid behind the
+// held COMMIT; the command FIFO (DEPTH 256) holds it plus 3 frames of 65
+// words, and the gate times out after START_TRIG_FIFO_FRAMES periods, so a
+// late trigger costs a miss (miss_cnt), never dropped words. The trigger must
+// come within 2 periods of start_ns: keep the period above the clock error.
+static bool do_start_at(uint8_t mode, uint64_t start_ns) {
+    if ((mode & ~(START_TRIG | START_LEAD)) || ((mode & START_LEAD) && !(mode & START_TRIG))) {
+        DPRINT("ERROR: Invalid START_AT mode 0x%02X.\n", (unsigned)mode);
+        return false;
+    }
+    uint64_t now = rt_ns();
+    if (start_ns && (start_ns <= now || start_ns - now > (uint64_t)START_MAX_AHEAD_S * 1000000000ull)) {
+        DPRINT("ERROR: START_AT %lld us from now is out of range.\n", (long long)((int64_t)(start_ns - now) / 1000));
+        return false;
+    }
+    DPRINT("START_AT -> %s (mode %u).\n", start_ns ? "armed" : "cancelled", (unsigned)mode);
+    __atomic_store_n(&G.start_mode, (uint32_t)mode, __ATOMIC_RELAXED);
+    __atomic_store_n(&G.start_rt_ns, start_ns, __ATOMIC_RELEASE);
+    return true;
+}
+
+// --- [NEW] 'R' list_id(1) repeat(4): passes to play (0 = loop forever) ---
+// Valid from BEGIN until the list is released, so it can also be sent while
+// the list is playing: repeat=1 breaks a loop at the end of the current pass.
+static bool do_set_repeat(uint8_t list_id, uint32_t repeat) {
+    if (list_id >= G.n_lists) return false;
+    awg_list_t *L = &G.list[list_id];
+    if (list_state(L) == LIST_IDLE) {
+        DPRINT("ERROR: REPEAT for list %u which is IDLE (send it after BEGIN).\n", (unsigned)list_id);
+        return false;
+    }
+    DPRINT("REPEAT list %u -> %u%s.\n", (unsigned)list_id, repeat, repeat ? "" : " (loop)");
+    __atomic_store_n(&L->repeat, repeat, __ATOMIC_RELAXED);
+    return true;
+}
+
+// [NEW] Register the epoll events s needs now: input unless paused, output
+// while replies are queued.
+static void session_watch(queue_session_t *s) {
+    uint32_t ev = (s->paused ? 0 : EPOLLIN | EPOLLRDHUP) | (s->out_len ? EPOLLOUT : 0);
+    if (ev == s->events) return;
+    if (awg_reactor_mod(s->fd, ev) == 0) s->events = ev;
+}
+
+// [NEW] Hand queued replies to the socket as far as it takes them, never waiting.
+static bool session_flush(queue_session_t *s) {
+    size_t sent = 0;
+    while (sent < s->out_len) {
+        ssize_t r = send(s->fd, s->out + sent, s->out_len - sent, MSG_NOSIGNAL);
+        if (r < 0) {
             if (errno == EINTR) continue;
-            if (g_stop_queue) break;
-            DPRINT("accept() failed with error %d (%s), exiting accept loop.\n", errno, strerror(errno));
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            DPRINT("ERROR: reply to fd=%d failed: %s\n", s->fd, strerror(errno));
+            return false;
+        }
+        sent += (size_t)r;
+    }
+    memmove(s->out, s->out + sent, s->out_len - sent);
+    s->out_len -= sent;
+    session_watch(s);
+    return true;
+}
+
+// [MODIFIED] Queue a reply and send what the socket takes; the rest goes
+// out on EPOLLOUT. A client that lets QUEUE_OUT_MAX bytes pile up is dropped.
+static bool send_reply(queue_session_t *s, const void *buf, size_t len) {
+    if (len > QUEUE_OUT_MAX - s->out_len) {
+        DPRINT("ERROR: fd=%d does not read its replies (%zu bytes queued).\n", s->fd, s->out_len);
+        return false;
+    }
+    memcpy(s->out + s->out_len, buf, len);
+    s->out_len += len;
+    return session_flush(s);
+}
+
+// --- [NEW] 'Q' flags(1): reply with player counters and histograms ---
+// flags bit0: clear the histograms after this snapshot (owner only).
+// Reply (big-endian): "AWGH" u16 buckets, then u64 ticks, frames, list_switches,
+// notify_coalesced, missed, max_late_ns, max_send_ns, max_switch_gap_ns,
+// late[buckets], send[buckets], switch_gap[buckets],
+// overrun_burst, overrun_skip, overrun_stretch, skipped_frames.
+static bool do_query_stats(queue_session_t *s, uint8_t flags) {
+    queue_player_stats_t st;
+    queue_player_hist_t  h;
+    get_queue_player_stats(&st);
+    get_queue_player_hist(&h);
+
+    uint8_t  buf[6 + 8 * (12 + 3 * AWG_HIST_BUCKETS)];
+    uint8_t *p = buf;
+    memcpy(p, "AWGH", 4); p += 4;
+    uint16_t nb = host_to_be16(AWG_HIST_BUCKETS); memcpy(p, &nb, 2); p += 2;
+#define PUT64(v) do { uint64_t x_ = (v); \
+        uint32_t hi_ = host_to_be32((uint32_t)(x_ >> 32)), lo_ = host_to_be32((uint32_t)x_); \
+        memcpy(p, &hi_, 4); memcpy(p + 4, &lo_, 4); p += 8; } while (0)
+    PUT64(st.ticks); PUT64(st.frames); PUT64(st.list_switches); PUT64(st.notify_coalesced);
+    PUT64(h.missed); PUT64(h.max_late_ns); PUT64(h.max_send_ns); PUT64(h.max_switch_gap_ns);
+    for (int i = 0; i < AWG_HIST_BUCKETS; ++i) PUT64(h.late[i]);
+    for (int i = 0; i < AWG_HIST_BUCKETS; ++i) PUT64(h.send[i]);
+    for (int i = 0; i < AWG_HIST_BUCKETS; ++i) PUT64(h.switch_gap[i]);
+    PUT64(st.overrun_burst); PUT64(st.overrun_skip); PUT64(st.overrun_stretch); PUT64(st.skipped_frames);
+#undef PUT64
+
+    if ((flags & 1) && s->role == ROLE_OWNER) __atomic_add_fetch(&G.hist_reset_req, 1, __ATOMIC_RELEASE);
+    return send_reply(s, buf, (size_t)(p - buf));
+}
+
+static inline uint8_t *put_be32(uint8_t *p, uint32_t v) {
+    v = host_to_be32(v);
+    memcpy(p, &v, 4);
+    return p + 4;
+}
+
+// --- [NEW] 'G': list status snapshot ---
+// Reply (big-endian): "AWGS" n_lists(1) your_role(1) owner_connected(1)
+// global_period_us(4), then per list: state(1) loaded_frames(4)
+// total_frames(4) repeat(4) period_us(4). Roles: 0 none, 1 observer, 2 owner.
+static bool do_get_status(queue_session_t *s) {
+    uint8_t  buf[11 + 17 * AWG_MAX_LISTS];
+    uint8_t *p = buf;
+    memcpy(p, "AWGS", 4); p += 4;
+    *p++ = (uint8_t)G.n_lists;
+    *p++ = (uint8_t)s->role;
+    *p++ = g_owner != NULL;
+    p = put_be32(p, __atomic_load_n(&G.period_us, __ATOMIC_RELAXED));
+    for (int id = 0; id < G.n_lists; ++id) {
+        awg_list_t *L = &G.list[id];              // counts are written by this thread only
+        *p++ = (uint8_t)list_state(L);
+        p = put_be32(p, L->loaded_frames);
+        p = put_be32(p, L->total_frames);
+        p = put_be32(p, __atomic_load_n(&L->repeat, __ATOMIC_RELAXED));
+        p = put_be32(p, L->period_us);
+    }
+    return send_reply(s, buf, (size_t)(p - buf));
+}
+
+// --- [NEW] 'l': list the on-board waveform library (headers only) ---
+// Reply (big-endian): "AWGD" found(2) count(2), then count entries of
+// name_len(1) name frames(4) words(4) period_us(4). found > count when the
+// library holds more than LIBRARY_LIST_MAX files.
+// [MODIFIED] The worker thread reads the directory; s waits for the listing
+// (paused), and every session asking meanwhile gets the same one.
+static bool do_list_library(queue_session_t *s) {
+    if (!g_worker.running) { DPRINT("ERROR: 'l' without a worker thread.\n"); return false; }
+    s->lib_wait = true;
+    pthread_mutex_lock(&g_worker.mu);
+    if (!g_worker.scan_posted) {
+        g_worker.scan_posted = true;
+        pthread_cond_signal(&g_worker.cv);
+    }
+    pthread_mutex_unlock(&g_worker.mu);
+    return true;
+}
+
+static void drop_session(queue_session_t *s);
+
+static void become_owner(queue_session_t *s) {
+    if (g_owner && g_owner != s) {
+        DPRINT("Client fd=%d takes over from owner fd=%d.\n", s->fd, g_owner->fd);
+        drop_session(g_owner);
+    }
+    g_owner = s;
+    s->role = ROLE_OWNER;
+}
+
+// --- [NEW] 'C' mode(1): choose the role; reply role(1) ---
+// mode 0: owner if there is none (else observer), 1: owner, replacing the
+// current one, 2: observer (an owner gives up its role; lists it was
+// loading are cancelled, queued/playing lists keep going).
+static bool do_claim(queue_session_t *s, uint8_t mode) {
+    if (mode > 2) { DPRINT("ERROR: Invalid CLAIM mode %u.\n", (unsigned)mode); return false; }
+    if (mode == 2) {
+        if (s == g_owner) {
+            for (int id = 0; id < G.n_lists; ++id) cancel_preload_and_mark_idle(id);
+            g_owner = NULL;
+        }
+        s->role = ROLE_OBSERVER;
+    } else if (mode == 1 || !g_owner || g_owner == s) {
+        become_owner(s);
+    } else {
+        s->role = ROLE_OBSERVER;
+    }
+    DPRINT("CLAIM mode %u: fd=%d is now %s.\n", (unsigned)mode, s->fd, s->role == ROLE_OWNER ? "owner" : "observer");
+    uint8_t r = (uint8_t)s->role;
+    return send_reply(s, &r, 1);
+}
+
+// [NEW] Size of an observer command including the opcode; 0 = owner only.
+static size_t observer_cmd_len(uint8_t op) {
+    switch (op) {
+        case 'G': case 'l': return 1;
+        case 'Q': case 'C': return 2;
+        default:            return 0;
+    }
+}
+
+// [NEW] Bytes a command takes, opcode included, judged from the 'have'
+// bytes buffered so far (a larger answer once its length fields are in).
+// 'M' 'D' 'd': header only. A bad length field asks for the header only,
+// so the handler sees and rejects it.
+static size_t cmd_len(const uint8_t *p, size_t have) {
+    switch (p[0]) {
+        case 'Q': case 'C': case 'O': case 'E': return 2;
+        case 'T':                               return 5;
+        case 'B': case 'R': case 'M': case 'D': case 'd': return 6;
+        case 'b': case 'A':                     return 10;
+        case 'N':                               return 14;
+        case 'P': {
+            if (have < 4) return 4;
+            uint16_t c = (uint16_t)(p[2] << 8 | p[3]);
+            return c <= MAX_WORDS_PER_FRAME ? 4 + (size_t)c * 4 : 4;
+        }
+        case 'S': case 'L':
+            if (have < 3) return 3;
+            return p[2] <= AWG_LIST_NAME_MAX ? 3 + (size_t)p[2] : 3;
+        case 'F':
+            if (have < 15) return 15;
+            return p[14] <= DELTA_SLOTS ? 15 + (size_t)p[14] * GEN_RAMP_BYTES : 15;
+        default:                                return 1;   // no body, or unknown
+    }
+}
+
+// Run one command whose opcode is 'op'. [MODIFIED] The whole command is
+// buffered already (session_need), so the reader never waits here; 'M' 'D'
+// 'd' only take their header and go on in bulk_step(). Returns false = drop client.
+static bool handle_command(queue_session_t *s, uint8_t op){
+    awg_reader_t *rd = &s->rd;
+    int rc;
+    if (s->role != ROLE_OWNER && observer_cmd_len(op) == 0) {
+        if (s->role == ROLE_OBSERVER) {
+            DPRINT("ERROR: observer fd=%d sent owner command 0x%02X.\n", s->fd, op);
+            return false;
+        }
+        become_owner(s);                          // unassigned client starts uploading
+    }
+    switch(op){
+        case 'B': {
+            uint8_t b[5]; 
+            rc = awg_reader_read(rd, b, 5, -1);
+            if(rc <= 0) return false;
+            uint32_t tf; memcpy(&tf, &b[1], sizeof(tf));
+            if (!do_preload_begin(b[0], be32_to_host(tf), 0, 0)) return false;
+        } break;
+        case 'b': { // [NEW] BEGIN with words total: list_id(1) total_frames(4) total_words(4)
+            uint8_t b[9];
+            rc = awg_reader_read(rd, b, 9, -1);
+            if(rc <= 0) return false;
+            uint32_t tf; memcpy(&tf, &b[1], sizeof(tf));
+            uint32_t tw; memcpy(&tw, &b[5], sizeof(tw));
+            if (!do_preload_begin(b[0], be32_to_host(tf), be32_to_host(tw), 0)) return false;
+        } break;
+        case 'N': { // [NEW] BEGIN with words total and period: list_id(1) total_frames(4) total_words(4) period_us(4)
+            uint8_t b[13];
+            rc = awg_reader_read(rd, b, 13, -1);
+            if(rc <= 0) return false;
+            uint32_t tf; memcpy(&tf, &b[1], sizeof(tf));
+            uint32_t tw; memcpy(&tw, &b[5], sizeof(tw));
+            uint32_t pu; memcpy(&pu, &b[9], sizeof(pu));
+            if (!do_preload_begin(b[0], be32_to_host(tf), be32_to_host(tw), be32_to_host(pu))) return false;
+        } break;
+        case 'T': { // [NEW] SET_PERIOD: period_us(4), global frame period
+            uint32_t pu;
+            rc = awg_reader_read(rd, &pu, 4, -1);
+            if(rc <= 0) return false;
+            if (!do_set_period(be32_to_host(pu))) return false;
+        } break;
+        case 'O': { // [NEW] overrun policy(1): 0 burst, 1 skip, 2 stretch
+            uint8_t pol;
+            rc = awg_reader_read(rd, &pol, 1, -1);
+            if(rc <= 0) return false;
+            if (pol > OVERRUN_STRETCH) { DPRINT("ERROR: Invalid overrun policy %u.\n", (unsigned)pol); return false; }
+            __atomic_store_n(&G.overrun, (int)pol, __ATOMIC_RELAXED);
+            DPRINT("Overrun policy -> %u.\n", (unsigned)pol);
+        } break;
+        case 'P': {
+            if (!do_preload_push(rd)) return false; 
+        } break;
+        case 'M':
+        case 'D':
+        case 'd': { // [NEW] wide delta PUSH: 32-bit masks, ch*16 + tone
+            if (!bulk_begin(s, op)) return false;   // body: bulk_step()
+        } break;
+        case 'E': {
+            uint8_t id; 
+            rc = awg_reader_read(rd, &id, 1, -1);
+            if(rc <= 0) return false;
+            if (!do_preload_end(id)) return false;
+        } break;
+        case 'R': {
+            uint8_t b[5];
+            rc = awg_reader_read(rd, b, 5, -1);
+            if(rc <= 0) return false;
+            uint32_t rep; memcpy(&rep, &b[1], sizeof(rep));
+            if (!do_set_repeat(b[0], be32_to_host(rep))) return false;
+        } break;
+        case 'A': { // [NEW] START_AT: mode(1) start_ns(8)
+            uint8_t b[9];
+            rc = awg_reader_read(rd, b, 9, -1);
+            if(rc <= 0) return false;
+            uint32_t hi; memcpy(&hi, &b[1], sizeof(hi));
+            uint32_t lo; memcpy(&lo, &b[5], sizeof(lo));
+            if (!do_start_at(b[0], ((uint64_t)be32_to_host(hi) << 32) | be32_to_host(lo))) return false;
+        } break;
+        case 'Q': {
+            uint8_t flags;
+            rc = awg_reader_read(rd, &flags, 1, -1);
+            if(rc <= 0) return false;
+            if (!do_query_stats(s, flags)) return false;
+        } break;
+        case 'G': if (!do_get_status(s)) return false; break;    // [NEW] status snapshot
+        case 'l': if (!do_list_library(s)) return false; break;  // [NEW] library listing
+        case 'C': { // [NEW] CLAIM: mode(1)
+            uint8_t mode;
+            rc = awg_reader_read(rd, &mode, 1, -1);
+            if(rc <= 0) return false;
+            if (!do_claim(s, mode)) return false;
+        } break;
+        case 'S': { // [NEW] STORE: list_id(1) name_len(1) name
+            uint8_t id; char name[AWG_LIST_NAME_MAX + 1];
+            if (!read_list_name(rd, &id, name) || !do_store(s, id, name)) return false;
+        } break;
+        case 'F': if (!do_generate(rd)) return false; break;   // [NEW] GENERATE
+        case 'L': { // [NEW] LOAD: list_id(1) name_len(1) name
+            uint8_t id; char name[AWG_LIST_NAME_MAX + 1];
+            if (!read_list_name(rd, &id, name) || !do_load(id, name)) return false;
+        } break;
+        case 'I': if (!do_ingest()) return false; break;   // [NEW] shm ingest doorbell
+        case 'Z': do_reset(s, false); break;
+        case 'X': {   // [MODIFIED] poweroff and drop once the reset is through (reset_finish())
+            DPRINT("SHUTDOWN command received. Resetting, then powering off.\n");
+            do_reset(s, true);
+        } break;
+        default: 
+            DPRINT("ERROR: Unknown command received: 0x%02X\n", op);
+            return false;
+    }
+    return true;
+}
+
+static void drop_session(queue_session_t *s){
+    if (s->fd < 0) return;
+    if (g_job.s == s) g_job.s = NULL;             // [NEW] the job goes on, without a reply
+    if (s == g_owner) {
+        for (int id = 0; id < G.n_lists; ++id) cancel_preload_and_mark_idle(id);
+        g_owner = NULL;
+    }
+    DPRINT("client disconnected (fd=%d, %s)\n", s->fd,
+           s->role == ROLE_OWNER ? "owner" : s->role == ROLE_OBSERVER ? "observer" : "unassigned");
+    awg_reactor_del(s->fd);
+    awg_reader_free(&s->rd);
+    close(s->fd);
+    s->fd = -1;
+}
+
+// [MODIFIED] Bytes needed before the next command may run: every role
+// only runs complete commands (bulk bodies excepted, see bulk_step()).
+// 0 = an observer sent an owner command.
+static size_t session_need(const queue_session_t *s) {
+    size_t have = awg_reader_buffered(&s->rd);
+    if (have == 0) return 1;
+    const uint8_t *p = awg_reader_peek(&s->rd);
+    if (s->role == ROLE_OBSERVER && observer_cmd_len(p[0]) == 0) return 0;
+    return cmd_len(p, have);                      // unassigned: an owner command makes it the owner
+}
+
+// [NEW] A command of s must wait for the running job: every owner command
+// (and so every command of the owner, keeping its replies in order).
+static bool ctl_must_wait(const queue_session_t *s, uint8_t op) {
+    return g_job.job != JOB_NONE && (s->role == ROLE_OWNER || observer_cmd_len(op) == 0);
+}
+
+// [NEW] Stop reading s until it is resumed; epoll still reports HUP/ERR
+// (and EPOLLOUT while replies are queued).
+static void session_pause(queue_session_t *s) {
+    s->paused = true;
+    session_watch(s);
+}
+
+static void on_queue_client(int fd, uint32_t events, void *ctx);
+
+// [NEW] Read s again and run what it has buffered meanwhile.
+static void session_resume(queue_session_t *s) {
+    s->paused = false;
+    session_watch(s);
+    on_queue_client(s->fd, 0, s);
+}
+
+// [NEW] The job is over: resume the paused sessions (a command among them
+// may start the next job and pause the rest again).
+static void ctl_finish(void) {
+    g_job.job = JOB_NONE;
+    g_job.s = NULL;
+    for (int i = 0; i < QUEUE_MAX_CLIENTS; ++i) {
+        queue_session_t *s = &g_sess[i];
+        if (s->fd >= 0 && s->paused && !s->lib_wait) session_resume(s);
+    }
+}
+
+// [NEW] The worker has read the library: every session waiting in 'l' gets
+// the listing, then goes on.
+static void library_finish(int found) {
+    static uint8_t buf[8 + LIBRARY_LIST_MAX * (1 + AWG_LIST_NAME_MAX + 12)];
+    bool waiting = false;
+    for (int i = 0; i < QUEUE_MAX_CLIENTS; ++i) waiting |= g_sess[i].fd >= 0 && g_sess[i].lib_wait;
+    if (!waiting) return;
+    const awg_list_file_info_t *info = g_worker.scan_info;   // worker idle until the next 'l'
+    if (found < 0) found = 0;                     // no library directory yet
+    int count = found < LIBRARY_LIST_MAX ? found : LIBRARY_LIST_MAX;
+
+    uint8_t *p = buf;
+    memcpy(p, "AWGD", 4); p += 4;
+    uint16_t v = host_to_be16((uint16_t)(found > 0xFFFF ? 0xFFFF : found)); memcpy(p, &v, 2); p += 2;
+    v = host_to_be16((uint16_t)count); memcpy(p, &v, 2); p += 2;
+    for (int i = 0; i < count; ++i) {
+        size_t n = strlen(info[i].name);
+        *p++ = (uint8_t)n;
+        memcpy(p, info[i].name, n); p += n;
+        p = put_be32(p, info[i].frames);
+        p = put_be32(p, info[i].words);
+        p = put_be32(p, info[i].period_us);
+    }
+    for (int i = 0; i < QUEUE_MAX_CLIENTS; ++i) {
+        queue_session_t *s = &g_sess[i];
+        if (s->fd < 0 || !s->lib_wait) continue;
+        s->lib_wait = false;
+        if (!send_reply(s, buf, (size_t)(p - buf))) { stat_inc(&g_net.errors, 1); drop_session(s); }
+        else if (s->paused) session_resume(s);
+    }
+}
+
+static void store_finish(int rc) {
+    if (rc != 0) DPRINT("ERROR: STORE from list %u failed (%d).\n", (unsigned)g_job.list_id, rc);
+    else         DPRINT("STORE from list %u complete.\n", (unsigned)g_job.list_id);
+    uint8_t r = (uint8_t)(rc < 0 ? -rc : 0);
+    if (g_job.s && !send_reply(g_job.s, &r, 1)) drop_session(g_job.s);
+    ctl_finish();
+}
+
+static void reset_finish(void) {
+    // --- Final internal state cleanup after the PL banks are flushed ---
+    for (int id = 0; id < G.n_lists; ++id) { reset_list(&G.list[id]); release_list_file(&G.list[id]); }
+
+    // --- ONLY NOW send the final IDLE notifications to the client ---
+    // This ensures the client receives IDLE status only after all zeroing operations are complete
+    for (int id = 0; id < G.n_lists; ++id) update_list_status(id, LIST_IDLE);
+    DPRINT("RESET command fully processed: all lists flushed and now truly IDLE. Notifications sent.\n");
+
+    if (g_reset.poweroff) {
+        DPRINT("Initiating system poweroff.\n");
+        system("poweroff");
+        if (g_job.s) drop_session(g_job.s);
+    }
+    ctl_finish();
+}
+
+// [NEW] Player -> reactor (done_efd): a list came back, a flush or a side
+// write is through. Drain first, then look, so no signal is lost.
+static void on_player_done(int fd, uint32_t events, void *ctx) {
+    (void)events; (void)ctx;
+    efd_drain(fd);
+    if (g_job.job == JOB_RESET && reset_poll()) reset_finish();
+}
+
+// [NEW] Worker -> reactor: the posted job has finished.
+static void on_worker_done(int fd, uint32_t events, void *ctx) {
+    (void)events; (void)ctx;
+    efd_drain(fd);
+    pthread_mutex_lock(&g_worker.mu);
+    bool done = !g_worker.posted;
+    int  rc   = g_worker.rc;
+    bool scanned = !g_worker.scan_posted;
+    int  found   = g_worker.scan_found;
+    pthread_mutex_unlock(&g_worker.mu);
+    if (done && g_job.job == JOB_STORE) store_finish(rc);
+    if (scanned) library_finish(found);
+}
+
+// --- [MODIFIED] Reactor handlers replace accept_loop_queue/serve_client ---
+// Commands are parsed while bytes are buffered and never wait for the
+// socket. [MODIFIED] A wakeup takes at most QUEUE_WAKEUP_BYTES from the
+// socket, then the loop goes back to epoll (level-triggered: the rest of a
+// large upload wakes it again), so one client cannot starve the other
+// ports, the notify channel or the metrics endpoint. [NEW] A command that
+// must wait for a job pauses the session instead (see ctl_finish()).
+static void on_queue_client(int fd, uint32_t events, void *ctx){
+    queue_session_t *s = ctx;
+    awg_reader_t *rd = &s->rd;
+    size_t budget = QUEUE_WAKEUP_BYTES;
+    if ((events & EPOLLOUT) && !session_flush(s)) { drop_session(s); return; }
+    if (s->paused) {
+        if (events & (EPOLLHUP | EPOLLERR)) drop_session(s);
+        return;
+    }
+    if (events == EPOLLOUT) return;               // only replies went out
+    for (;;) {
+        if (s->lib_wait) { session_pause(s); return; }
+        if (s->bulk.op) {
+            int r = bulk_step(s, &budget);
+            if (r < 0) { stat_inc(&g_net.errors, 1); break; }
+            if (r > 0) continue;
+        } else {
+            size_t need = session_need(s);
+            if (need == 0) {
+                DPRINT("ERROR: observer fd=%d sent owner command 0x%02X.\n", fd, awg_reader_peek(rd)[0]);
+                break;
+            }
+            if (awg_reader_buffered(rd) >= need) {
+                if (ctl_must_wait(s, awg_reader_peek(rd)[0])) { session_pause(s); return; }
+                uint8_t op;
+                if (awg_reader_read(rd, &op, 1, -1) <= 0) break;
+                if (!handle_command(s, op)) { stat_inc(&g_net.errors, 1); break; }
+                continue;
+            }
+        }
+        if (budget == 0) return;                           // the socket has more: next wakeup
+        int n = awg_reader_fill_nb(rd);
+        if (n == -3) {
+            if (events & (EPOLLHUP | EPOLLERR)) break;
+            return;                                        // wait for more
+        }
+        if (n <= 0) {                                      // -4 cannot happen: commands fit the buffer
+            DPRINT("awg_reader_fill_nb returned %d, client likely disconnected.\n", n);
             break;
         }
-        
-        if (g_active_client_fd >= 0) {
-            DPRINT("Another client tried to connect. Closing old fd=%d and accepting new fd=%d.\n", g_active_client_fd, fd);
-            close(g_active_client_fd);
+        budget -= (size_t)n < budget ? (size_t)n : budget;
+    }
+    drop_session(s);
+}
+
+static void on_queue_accept(int lfd, uint32_t events, void *ctx){
+    (void)events; (void)ctx;
+    for (;;) {
+        int fd = accept4(lfd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                DPRINT("accept() failed with error %d (%s).\n", errno, strerror(errno));
+            return;
         }
-        g_active_client_fd = fd;
-        serve_client(fd);
-        g_active_client_fd = -1;
+        queue_session_t *s = NULL;
+        for (int i = 0; i < QUEUE_MAX_CLIENTS && !s; ++i)
+            if (g_sess[i].fd < 0) s = &g_sess[i];
+        if (!s) {
+            DPRINT("ERROR: %d clients connected already, refusing fd=%d.\n", QUEUE_MAX_CLIENTS, fd);
+            close(fd);
+            continue;
+        }
+        if (awg_reader_init(&s->rd, fd, AWG_READER_DEFAULT_CAP, IO_TIMEOUT_MS) != 0 ||
+            awg_reactor_add(fd, EPOLLIN | EPOLLRDHUP, on_queue_client, s) != 0) {
+            DPRINT("ERROR: Failed to set up client fd=%d.\n", fd);
+            awg_reader_free(&s->rd);
+            close(fd);
+            continue;
+        }
+        awg_reader_count(&s->rd, &g_rx);
+        stat_inc(&g_net.connects, 1);
+        s->fd   = fd;
+        s->role = ROLE_NONE;
+        s->paused = false;
+        s->lib_wait = false;
+        s->events = EPOLLIN | EPOLLRDHUP;
+        s->out_len = 0;
+        s->bulk.op = 0;
+        DPRINT("client connected (fd=%d)\n", fd);
     }
-    DPRINT("Accept loop thread exiting.\n");
-    return NULL;
 }
 
 // --- [MODIFIED] The start_queue_server function ---
 int start_queue_server(unsigned short port){
-  g_stop_queue = 0;
-  struct sigaction sa; memset(&sa, 0, sizeof(sa));
-  sa.sa_handler = dummy_signal_handler;
-  if (sigaction(SIGUSR1, &sa, NULL) == -1) { DPRINT("sigaction failed: %s\n", strerror(errno)); return -1; }
-  
+  g_stop_player = 0;
   init_lists();
+  for (int i = 0; i < QUEUE_MAX_CLIENTS; ++i) g_sess[i].fd = -1;
+  g_owner = NULL;
+  g_job.job = JOB_NONE;
+  g_job.s = NULL;
+
+  // [NEW] Completion/wakeup eventfds between the player and the control side
+  G.done_efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  G.wake_efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (G.done_efd < 0 || G.wake_efd < 0) {
+      perror("[QSRV] eventfd");
+      if (G.done_efd >= 0) close(G.done_efd);
+      if (G.wake_efd >= 0) close(G.wake_efd);
+      G.done_efd = G.wake_efd = -1;
+      return -5;
+  }
   start_player_if_needed(); 
 
+  // [NEW] Worker thread for STORE file writes
+  g_worker.stop = false;
+  g_worker.posted = false;
+  g_worker.efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (g_worker.efd < 0 || awg_reactor_add(g_worker.efd, EPOLLIN, on_worker_done, NULL) != 0) {
+      perror("[QSRV] worker eventfd");
+      if (g_worker.efd >= 0) { close(g_worker.efd); g_worker.efd = -1; }
+  } else if (pthread_create(&g_worker.th, NULL, worker_thread, NULL) != 0) {
+      perror("[QSRV] pthread_create(worker)");
+  } else {
+      g_worker.running = true;
+  }
+
+  // [NEW] Shared-memory ingest for local producers: AWG_SHM_SLOTS slots of
+  // AWG_SHM_SLOT_WORDS words (off by default)
+  const char *shm_slots = getenv("AWG_SHM_SLOTS");
+  if (shm_slots && atoi(shm_slots) > 0) {
+      const char *sw = getenv("AWG_SHM_SLOT_WORDS");
+      uint32_t slot_words = sw ? (uint32_t)strtoul(sw, NULL, 0) : SHM_DEFAULT_SLOT_WORDS;
+      if (awg_shm_open((uint32_t)atoi(shm_slots), slot_words) != 0)
+          printf("[QSRV] Shared-memory ingest disabled (AWG_SHM_SLOTS=%s, AWG_SHM_SLOT_WORDS=%u).\n",
+                 shm_slots, slot_words);
+  }
+
   // --- [NEW] Synchronously flush PL buffers with zero-gain waveforms on startup ---
   DPRINT("Priming PL buffers with zero-gain waveforms on startup...\n");
   
   if (G.player_thread_running) {
-      // --- Flush List 0 ---
-      pthread_mutex_lock(&G.mtx);
-      DPRINT("Priming PL buffer for list 0...\n");
-      if (load_zero_gain_list(&G.list[0], SHUTDOWN_FLUSH_FRAMES)) {
-          G.cur_list = 0; G.next_list = 1; G.cur_frame = 0; G.playing = true;
-      }
-      pthread_mutex_unlock(&G.mtx);
-      while (g_list_status[0] != LIST_IDLE) { usleep(10000); }
-      DPRINT("PL buffer for list 0 primed.\n");
-
-      // --- Flush List 1 ---
-      pthread_mutex_lock(&G.mtx);
-      DPRINT("Priming PL buffer for list 1...\n");
-      if (load_zero_gain_list(&G.list[1], SHUTDOWN_FLUSH_FRAMES)) {
-          G.cur_list = 1; G.next_list = 0; G.cur_frame = 0; G.playing = true;
-      }
-      pthread_mutex_unlock(&G.mtx);
-      while (g_list_status[1] != LIST_IDLE) { usleep(10000); }
-      DPRINT("PL buffer for list 1 primed.\n");
+      zero_pl_banks();
   }
   
   DPRINT("PL priming complete. Server is ready to accept connections.\n");
 
-  // --- Now, proceed with setting up network listening ---
-  g_listen_queue = socket(AF_INET, SOCK_STREAM, 0);
-  if (g_listen_queue < 0){ DPRINT("socket() failed: %s\n", strerror(errno)); return -1; }
-  int one=1;
-  setsockopt(g_listen_queue, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
-  struct sockaddr_in addr={0};
-  addr.sin_family=AF_INET; addr.sin_addr.s_addr=htonl(INADDR_ANY); addr.sin_port=htons(port);
-  if (bind(g_listen_queue,(struct sockaddr*)&addr,sizeof(addr))<0){ DPRINT("bind() failed: %s\n", strerror(errno)); close(g_listen_queue); return -2; }
-  if (listen(g_listen_queue,1)<0){ DPRINT("listen() failed: %s\n", strerror(errno)); close(g_listen_queue); return -3; }
-  if (pthread_create(&g_accept_thread_queue, NULL, accept_loop_queue, NULL) != 0) {
-      DPRINT("pthread_create() failed: %s\n", strerror(errno)); close(g_listen_queue); return -4;
+  // [NEW] From now on player signals drive RESET on the reactor (on_player_done())
+  if (awg_reactor_add(G.done_efd, EPOLLIN, on_player_done, NULL) != 0) return -6;
+
+  // --- Now, proceed with setting up network listening (served by the reactor) ---
+  g_listen_queue = awg_reactor_listen_tcp(port, 1);
+  if (g_listen_queue < 0) return -2;
+  if (awg_reactor_add(g_listen_queue, EPOLLIN, on_queue_accept, NULL) != 0) {
+      close(g_listen_queue); g_listen_queue = -1; return -4;
   }
-  g_accept_thread_running = true;
   return 0;
 }
 
@@ -758,60 +2721,45 @@ int start_queue_server(unsigned short port){
 void stop_queue_server(void){
     DPRINT("Queue server stopping sequence initiated...\n");
 
-    // --- Phase 1: Shut down network services and join the accept thread ---
+    // --- Phase 1: Close our sockets (the reactor thread has been stopped by main) ---
     DPRINT("Stopping network services...\n");
-    g_stop_queue = 1;
     if (g_listen_queue >= 0) {
-        shutdown(g_listen_queue, SHUT_RDWR); // Help unblock accept()
+        awg_reactor_del(g_listen_queue);
         close(g_listen_queue);
         g_listen_queue = -1;
     }
-    if (g_active_client_fd >= 0) {
-        shutdown(g_active_client_fd, SHUT_RDWR);
-        close(g_active_client_fd);
-        g_active_client_fd = -1;
-    }
-    if (g_accept_thread_running) {
-        pthread_kill(g_accept_thread_queue, SIGUSR1); // Interrupt if still blocked
-        pthread_join(g_accept_thread_queue, NULL);
-        g_accept_thread_running = false;
+    for (int i = 0; i < QUEUE_MAX_CLIENTS; ++i) drop_session(&g_sess[i]);
+    if (g_worker.running) {                       // [NEW] a STORE in progress is finished first
+        pthread_mutex_lock(&g_worker.mu);
+        g_worker.stop = true;
+        pthread_cond_signal(&g_worker.cv);
+        pthread_mutex_unlock(&g_worker.mu);
+        pthread_join(g_worker.th, NULL);
+        g_worker.running = false;
     }
+    if (g_worker.efd >= 0) { awg_reactor_del(g_worker.efd); close(g_worker.efd); g_worker.efd = -1; }
+    g_job.job = JOB_NONE;
     DPRINT("Network services stopped.\n");
 
     // --- Phase 2: Flush PL buffers (player_thread is still running) ---
     DPRINT("Starting PL buffer flush.\n");
     if (G.player_thread_running) {
-        // --- Flush List 0 ---
-        pthread_mutex_lock(&G.mtx);
-        G.playing = false;
-        clear_list_fully(&G.list[0]);
-        clear_list_fully(&G.list[1]);
-        if (load_zero_gain_list(&G.list[0], SHUTDOWN_FLUSH_FRAMES)) {
-            G.cur_list = 0; G.next_list = 1; G.cur_frame = 0; G.playing = true;
-        }
-        pthread_mutex_unlock(&G.mtx);
-        while (g_list_status[0] != LIST_IDLE) { usleep(10000); }
-        DPRINT("PL buffer for list 0 flushed.\n");
-
-        // --- Flush List 1 ---
-        pthread_mutex_lock(&G.mtx);
-        G.playing = false;
-        clear_list_fully(&G.list[1]);
-        if (load_zero_gain_list(&G.list[1], SHUTDOWN_FLUSH_FRAMES)) {
-            G.cur_list = 1; G.next_list = 0; G.cur_frame = 0; G.playing = true;
-        }
-        pthread_mutex_unlock(&G.mtx);
-        while (g_list_status[1] != LIST_IDLE) { usleep(10000); }
-        DPRINT("PL buffer for list 1 flushed.\n");
+        request_player_flush();
+        zero_pl_banks();
     }
 
     // --- Phase 3: Finally, join the player thread ---
     DPRINT("PL flush complete. Stopping player thread.\n");
     if (G.player_thread_running) {
+        g_stop_player = 1;
+        wake_player();
         pthread_join(G.player_thread_h, NULL);
         G.player_thread_running = false;
     }
+    if (G.done_efd >= 0) { awg_reactor_del(G.done_efd); close(G.done_efd); G.done_efd = -1; }
+    if (G.wake_efd >= 0) { close(G.wake_efd); G.wake_efd = -1; }
+    for (int id = 0; id < G.n_lists; ++id) free_list_arena(&G.list[id]);
+    awg_shm_close();
 
-    pthread_mutex_destroy(&G.mtx);
     DPRINT("Queue server stopped successfully.\n");
 }
@@ -5,6 +5,8 @@
 #define AWG_SERVER_SHARED_H
 
 #include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
 
 // Defines the three possible states for a list.
 enum list_status {
@@ -13,20 +15,148 @@ enum list_status {
     LIST_READY
 };
 
+// [NEW] Upper bound of the list queue depth (AWG_QUEUE_DEPTH, default 2).
+// Must stay <= 32: coalesced notifications are tracked in a 32-bit mask.
+#define AWG_MAX_LISTS     32
+#define AWG_DEFAULT_LISTS 2
+
 // --- Global variables shared between modules ---
 // Defined in awg_server_raw_notify.c and used by awg_server_raw_queue.c.
 
-// Mutex to protect access to the notification state.
+// Mutex to protect the notify client socket (reactor + drain thread only).
 extern pthread_mutex_t g_notify_mutex;
 
-// Status of the two lists (0 and 1).
-extern volatile int g_list_status[2];
+// Status of lists 0 .. g_list_count-1.
+extern volatile int g_list_status[AWG_MAX_LISTS];
+
+// Number of lists in use; set by the queue server before clients connect.
+extern int g_list_count;
 
 // --- Public functions exported by the notification server ---
 
+// [NEW] Binary notify events (port 9101 after the client sends 'B'),
+// 20 bytes, big-endian:
+//   u8 type | u8 list_id | u8 status | u8 flags | u32 seq | u32 frame | u64 t_ns
+// seq counts events on this connection (0 = first event of the snapshot),
+// t_ns is CLOCK_MONOTONIC when the event was posted.
+//   STATUS: list_id changed to status; frame = frames of it played (player) or 0
+//   START:  the player put list_id on air; frame = frames in one pass
+#define NOTIFY_EVENT_BYTES    20
+#define NOTIFY_FLAG_COALESCED 0x01   // queue overflowed: earlier events of this list were merged
+enum notify_event_type {
+    NOTIFY_EV_STATUS = 1,
+    NOTIFY_EV_START  = 2
+};
+
 // Call this function to send a status update for a specific list.
 void send_status_update(int list_id);
 
+// Set g_list_status[list_id] and notify.
+void update_list_status(int list_id, int status);
+
+// [MODIFIED] Never block and never send(): events go through a lock-free
+// queue to the notify drain thread. False if the queue was full (a status
+// is then delivered later, coalesced); any thread may call these.
+bool post_list_event(int type, int list_id, int status, uint32_t frame);
+bool post_list_status(int list_id, int status);
+
+// --- Player statistics exported by the queue server ---
+typedef struct {
+    uint64_t ticks;          // player loop iterations
+    uint64_t frames;         // frames handed to the hardware
+    uint64_t list_switches;  // lists taken from the ready ring
+    uint64_t notify_coalesced; // notify queue full: coalesced instead of queued
+    uint64_t overrun_burst;  // [NEW] late ticks caught up by sending back-to-back
+    uint64_t overrun_skip;   // [NEW] late ticks resolved by dropping the missed frames
+    uint64_t overrun_stretch;// [NEW] late ticks resolved by shifting the time grid
+    uint64_t skipped_frames; // [NEW] frames dropped by the skip policy
+    uint64_t override_frames;// [NEW] frames sent with port-9000 overrides merged
+    uint64_t underruns;      // [NEW] a list ended with no next one ready (playback stopped)
+} queue_player_stats_t;
+
+void get_queue_player_stats(queue_player_stats_t *st);
+
+// [NEW] Network side of the TCP servers (reactor thread, relaxed atomics)
+typedef struct {
+    uint64_t connects;       // accepted connections (reconnects show up here)
+    uint64_t bytes_in;       // bytes received from clients
+    uint64_t read_timeouts;  // queue: command bodies that timed out (the client is dropped); direct: 0
+    uint64_t frames;         // queue: frames in lists handed to the player; direct: frames applied
+    uint64_t lists;          // queue: lists handed to the player
+    uint64_t errors;         // queue: clients dropped on a bad command; direct: frames rejected
+} tcp_server_stats_t;
+
+void get_queue_server_stats(tcp_server_stats_t *st);
+void get_direct_server_stats(tcp_server_stats_t *st);
+
+// [NEW] Port 9000 frame. Idle GPIO player: written to the PL at once. While the GPIO player has a list, the frame is merged instead:
+// INDEX/GAIN become sticky overrides that the player writes into every frame
+// it emits, ahead of that frame's COMMIT, until released by a RELEASE word,
+// RESET, or the player running out of lists. A merged value is on air with
+// the next frame the player sends, one period of the list on air at most
+// (two if that frame caught the update mid-write); no frame goes out while
+// a START_AT waits. That bound starts when this is called: a frame that
+// arrives while the reactor is busy with other clients waits for them
+// first. Released slots get the list's own last value back for two frames.
+// COMMIT words are implied; any other command there is rejected (-5).
+// RELEASE (server-side only): ch/tone select the slot, data bit0 = index,
+// bit1 = gain, bit2 = every slot. Returns 0 or an awg_* error code.
+// Called by the reactor (port 9000) and the UDP thread, one at a time.
+// [MODIFIED] DMA backend (AWG_BACKEND=dma|seq): an idle DMA player sends the
+// frame through the DMA as is, within about one DMA round trip (-7 if 16
+// are already waiting); while it streams a list, or waits for a START_AT,
+// the frame is rejected (-6): nothing can be merged into a transfer.
+#define AWG_CMD_RELEASE    0xEu
+#define AWG_RELEASE_INDEX  0x1u
+#define AWG_RELEASE_GAIN   0x2u
+#define AWG_RELEASE_ALL    0x4u
+
+int queue_direct_frame(const uint32_t *words, int count);
+
+// [NEW] True when the queue server streams through the DMA backend
+// (AWG_BACKEND=dma|seq); every PL write then goes through the DMA.
+bool queue_server_uses_dma(void);
+
+// [NEW] Per-tick timing histograms (GPIO player). Bucket 0 is < 1 us,
+// bucket b >= 1 covers [2^(b-1), 2^b) us, the last bucket is open-ended.
+#define AWG_HIST_BUCKETS 16
+
+typedef struct {
+    uint64_t late[AWG_HIST_BUCKETS];        // wakeup lateness vs. the tick deadline
+    uint64_t send[AWG_HIST_BUCKETS];        // duration of one frame's GPIO burst
+    uint64_t switch_gap[AWG_HIST_BUCKETS];  // last frame of a list -> first frame of the next
+    uint64_t missed;                        // ticks woken a full period (or more) late
+    uint64_t max_late_ns;
+    uint64_t max_send_ns;
+    uint64_t max_switch_gap_ns;
+} queue_player_hist_t;
+
+void get_queue_player_hist(queue_player_hist_t *h);
+
+// --- [NEW] UDP direct server (awg_server_raw_udp.c) ---
+typedef struct {
+    uint64_t datagrams;      // received datagrams
+    uint64_t batches;        // recvmmsg() calls that returned data
+    uint64_t max_batch;      // most datagrams returned by one call
+    uint64_t hex_frames;     // 336-byte ASCII hex frames applied
+    uint64_t word_frames;    // binary word frames applied
+    uint64_t bad_len;        // dropped: size matches neither format (or truncated)
+    uint64_t bad_hex;        // dropped: 336-byte frame with a non-hex character
+    uint64_t apply_errors;   // queue_direct_frame() returned an error
+    uint64_t kernel_drops;   // dropped by the kernel, receive queue full (SO_RXQ_OVFL)
+    uint64_t last_rate;      // datagrams/sec over the last second with traffic
+} udp_server_stats_t;
+
+int  start_udp_server(unsigned short port);
+void stop_udp_server(void);
+void get_udp_server_stats(udp_server_stats_t *st);
+
+// --- [NEW] Metrics endpoint (awg_server_raw_metrics.c) ---
+// Plain-text Prometheus exposition of every counter above over HTTP/1.0 on
+// AWG_METRICS_PORT (default 9102, 0 = off), served by the reactor.
+int  start_metrics_server(unsigned short port);
+void stop_metrics_server(void);
+
 // Functions to start and stop the notification server.
 int start_notify_server(unsigned short port);
 void stop_notify_server(void);
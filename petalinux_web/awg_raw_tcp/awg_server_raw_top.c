@@ -1,30 +1,63 @@
 /*
  * awg_server_raw_top.c — Top-level launcher
- * - Initializes AWG (/dev/mem mmap)
+ * - Initializes AWG (libawg_core, backend from AWG_CORE_BACKEND)
  * - Starts two listeners:
  *     port 9000 -> direct (no-queue) server
  *     port 9100 -> queued (single-writer) server
  *     port 9101 -> queued-notify server
+ *     udp  8766 -> direct UDP server (AWG_UDP_PORT, 0 = off)
+ *     port 9102 -> metrics, Prometheus text over HTTP (AWG_METRICS_PORT, 0 = off)
  *
- * Build:
+ * Build (make -f Makefile.onboard does the same; WITH_GPIOD=1 adds
+ * awg_core_libgpiod.c -DAWG_WITH_GPIOD -lgpiod):
  *  gcc -O2 -pthread -Wall -DDEBUG -o awg_server \
  *       awg_server_raw_top.c \
  *       awg_server_raw_direct.c \
  *       awg_server_raw_queue.c \
  *       awg_server_raw_notify.c \
- *       awg_core_mmap.c
+ *       awg_core.c \
+ *       awg_core_mmap.c \
+ *       awg_core_dma.c \
+ *       awg_core_sim.c \
+ *       awg_core_dt.c \
+ *       awg_sock_reader.c \
+ *       awg_rt.c \
+ *       awg_reactor.c \
+ *       awg_server_raw_udp.c \
+ *       awg_hex_decode.c \
+ *       awg_list_file.c \
+ *       awg_shm_ingest.c \
+ *       awg_server_raw_metrics.c -lrt
  *
  * Run (root for /dev/mem):
  *   sudo ./awg_server
  *
+ * Backend (environment, see awg_server.service):
+ *   AWG_BACKEND=gpio  (default) player strobes frames through AXI GPIO
+ *   AWG_BACKEND=dma   queued lists are streamed by AXI DMA (awg_core_dma.c)
+ *   AWG_BACKEND=seq   DMA + PL frame sequencer (frame_sequencer_axis.v) fires COMMITs
+ *   AWG_CORE_BACKEND=auto|mmap|gpiod|dma|sim  how the core writes words (awg_core.c);
+ *                     with 'dma' the queued server keeps the frame-by-frame player
+ *
+ * Real-time setup (environment, see awg_rt.h): AWG_RT_PLAYER_CPU, AWG_RT_NET_CPU,
+ *   AWG_RT_MLOCK, AWG_RT_PROBE (jitter report before/after the setup)
+ * AWG_BURST_STATS=1 counts words and strobe time of every burst (awg_core.c)
+ *
+ * All three ports are served by one epoll loop (awg_reactor.c) on the net CPU.
+ *
  * Debug prints:
  *   add -DDEBUG to build line
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <signal.h>
 #include <unistd.h>
 #include "awg_core.h"
+#include "awg_server_raw_shared.h"
+#include "awg_rt.h"
+#include "awg_reactor.h"
 
 // [ADD] Define a debug print macro specific to this file
 #ifdef DEBUG
@@ -49,10 +82,38 @@ int main(void) {
         fprintf(stderr, "awg_init failed\n");
         return 1;
     }
+    printf("[MAIN] core backend: %s, %d tones per channel\n", awg_core_backend_name(), awg_tones());
+
+    // [NEW] Optional DMA backend for the queued server. The DMA stream is
+    // then the only input of the waveform core: RESET, the shutdown zero-out
+    // and port 9000/UDP frames go through it as well (awg_server_raw_queue.c).
+    const char *backend = getenv("AWG_BACKEND");
+    if (backend && (strcmp(backend, "dma") == 0 || strcmp(backend, "seq") == 0)) {
+        if (awg_dma_init() != 0) {
+            fprintf(stderr, "awg_dma_init failed, falling back to GPIO backend\n");
+        } else if (strcmp(backend, "seq") == 0 && awg_seq_init() != 0) {
+            fprintf(stderr, "awg_seq_init failed, using DMA pacer only\n");
+        } else {
+            printf("[MAIN] %s backend enabled\n", backend);
+        }
+    }
+
+    // [NEW] Real-time setup before any server thread exists, so every thread
+    // inherits the network core and the locked address space
+    awg_rt_cfg_t rt;
+    awg_rt_load_config(&rt);
+    awg_rt_probe("before RT setup", rt.probe_ticks, -1, 0);
+    awg_rt_setup(&rt);
+    awg_rt_probe("after RT setup", rt.probe_ticks, rt.player_cpu, 98);
 
     signal(SIGINT,  on_signal);
     signal(SIGTERM, on_signal);
 
+    if (awg_reactor_init() != 0) {
+        fprintf(stderr, "failed to create event loop\n");
+        return 5;
+    }
+
     // start both modes
     if (start_direct_server(9000) != 0) {
         fprintf(stderr, "failed to start direct server on 9000\n");
@@ -69,14 +130,41 @@ int main(void) {
         return 3;
     }
 
+    // [NEW] Live counters for unattended operation (awg_server_raw_metrics.c)
+    const char *metrics_env = getenv("AWG_METRICS_PORT");
+    int metrics_port = metrics_env ? atoi(metrics_env) : 9102;
+    if (metrics_port > 0 && start_metrics_server((unsigned short)metrics_port) != 0) {
+        fprintf(stderr, "failed to start metrics server on %d\n", metrics_port);
+        metrics_port = 0;
+    }
 
-    
+    if (awg_reactor_start() != 0) {
+        fprintf(stderr, "failed to start event loop\n");
+        return 5;
+    }
+
+    // [NEW] Native UDP fast path (replaces awg_udp_mmap/awg_server_udp_mmap.py)
+    const char *udp_env = getenv("AWG_UDP_PORT");
+    int udp_port = udp_env ? atoi(udp_env) : 8766;
+    if (udp_port > 0 && start_udp_server((unsigned short)udp_port) != 0) {
+        fprintf(stderr, "failed to start UDP server on %d\n", udp_port);
+        udp_port = 0;
+    }
 
     printf("[MAIN] servers up. Ports: 9000=direct, 9100=queued, 9101=notify\n");
     while (!g_stop) usleep(100000); // 100 ms tick
 
     DPRINT_MAIN("\nStop signal received. Shutting down...\n");
 
+    awg_reactor_stop();   // no handler runs past this point
+
+    if (metrics_port > 0) stop_metrics_server();
+
+    if (udp_port > 0) {
+        DPRINT_MAIN("Stopping UDP server...\n");
+        stop_udp_server();
+    }
+
     DPRINT_MAIN("Stopping direct server...\n");
     stop_direct_server();
     DPRINT_MAIN("Direct server stopped.\n");
@@ -88,12 +176,72 @@ int main(void) {
     DPRINT_MAIN("Stopping notify server...\n");
     stop_notify_server();
     DPRINT_MAIN("Notify server stopped.\n");
+    awg_reactor_close();
+
+    queue_player_stats_t pst;
+    get_queue_player_stats(&pst);
+    printf("[MAIN] player: %llu ticks, %llu frames, %llu list switches, %llu notify coalesced\n",
+           (unsigned long long)pst.ticks, (unsigned long long)pst.frames,
+           (unsigned long long)pst.list_switches, (unsigned long long)pst.notify_coalesced);
+    printf("[MAIN] overruns: %llu burst, %llu skip (%llu frames dropped), %llu stretch\n",
+           (unsigned long long)pst.overrun_burst, (unsigned long long)pst.overrun_skip,
+           (unsigned long long)pst.skipped_frames, (unsigned long long)pst.overrun_stretch);
+    printf("[MAIN] direct overrides: %llu frames merged\n", (unsigned long long)pst.override_frames);
+    printf("[MAIN] underruns: %llu lists ended with no next list ready\n", (unsigned long long)pst.underruns);
+    tcp_server_stats_t qst, dst;
+    get_queue_server_stats(&qst);
+    get_direct_server_stats(&dst);
+    printf("[MAIN] tcp queue: %llu connects, %llu bytes, %llu lists (%llu frames), %llu timeouts, %llu errors\n",
+           (unsigned long long)qst.connects, (unsigned long long)qst.bytes_in, (unsigned long long)qst.lists,
+           (unsigned long long)qst.frames, (unsigned long long)qst.read_timeouts, (unsigned long long)qst.errors);
+    printf("[MAIN] tcp direct: %llu connects, %llu bytes, %llu frames, %llu rejected\n",
+           (unsigned long long)dst.connects, (unsigned long long)dst.bytes_in, (unsigned long long)dst.frames,
+           (unsigned long long)dst.errors);
+    queue_player_hist_t hst;
+    get_queue_player_hist(&hst);
+    printf("[MAIN] player timing: %llu missed ticks, max late %llu us, max send %llu us, max switch gap %llu us\n",
+           (unsigned long long)hst.missed, (unsigned long long)(hst.max_late_ns / 1000),
+           (unsigned long long)(hst.max_send_ns / 1000), (unsigned long long)(hst.max_switch_gap_ns / 1000));
+
+    if (udp_port > 0) {
+        udp_server_stats_t ust;
+        get_udp_server_stats(&ust);
+        printf("[MAIN] udp: %llu datagrams (%llu hex, %llu words) in %llu batches (max %llu), last %llu/sec\n",
+               (unsigned long long)ust.datagrams, (unsigned long long)ust.hex_frames,
+               (unsigned long long)ust.word_frames, (unsigned long long)ust.batches,
+               (unsigned long long)ust.max_batch, (unsigned long long)ust.last_rate);
+        printf("[MAIN] udp drops: %llu bad length, %llu bad hex, %llu kernel queue, %llu apply errors\n",
+               (unsigned long long)ust.bad_len, (unsigned long long)ust.bad_hex, (unsigned long long)ust.kernel_drops,
+               (unsigned long long)ust.apply_errors);
+    }
+
+    awg_burst_stats_t bst;
+    awg_get_burst_stats(&bst);
+    if (bst.enabled)
+        printf("[MAIN] burst engine: %llu words in %llu bursts, %.0f words/sec\n",
+               (unsigned long long)bst.words, (unsigned long long)bst.bursts, bst.words_per_sec);
+
+    // [NEW] Simulated PL: what reached the banks and the commit timing it saw
+    awg_sim_state_t sst;
+    if (awg_sim_get_state(&sst) == 0) {
+        printf("[MAIN] sim: %llu words, %llu commits, %llu blocked, commit gap min %llu / mean %llu / max %llu us (%llu gaps)\n",
+               (unsigned long long)sst.words, (unsigned long long)sst.commits,
+               (unsigned long long)sst.blocked_commits, (unsigned long long)(sst.gap_min_ns / 1000),
+               (unsigned long long)(sst.gap_count ? sst.gap_sum_ns / sst.gap_count / 1000 : 0),
+               (unsigned long long)(sst.gap_max_ns / 1000), (unsigned long long)sst.gap_count);
+    }
 
     // [MODIFIED] Add the zero-out call before closing the core hardware interface.
-    DPRINT_MAIN("Setting hardware to a safe (zero) state...\n");
-    awg_zero_output();
+    // [MODIFIED] Both banks and SAFE, not only the shadow bank's gains.
+    // [MODIFIED] DMA backend: stop_queue_server() did it through the DMA,
+    // the GPIO feed is not connected to the waveform core there.
+    if (!queue_server_uses_dma()) {
+        DPRINT_MAIN("Setting hardware to a safe (zero) state...\n");
+        awg_reset_banks();
+    }
 
     DPRINT_MAIN("Closing AWG core...\n");
+    if (awg_dma_ready()) awg_dma_close();
     awg_close();
     DPRINT_MAIN("AWG core closed.\n");
 
@@ -0,0 +1,203 @@
+/*
+ * awg_server_raw_udp.c — Direct (no-queue) UDP server, native replacement
+ * for awg_udp_mmap/awg_server_udp_mmap.py
+ * Datagram formats (one frame per datagram, applied immediately):
+ *   336 bytes       ASCII hex: idxA(24) gainA(144) idxB(24) gainB(144),
+ *                   decoded and validated by awg_hex_decode_frame() (commit included)
+ *   4*N bytes       N big-endian 32-bit words (1 <= N <= MAX_WORDS), sent
+ *                   like one W frame of the direct TCP port (caller commits)
+ * Anything else is counted as a bad datagram and dropped.
+ * [MODIFIED] Both go through queue_direct_frame() like port 9000: while the
+ * queue player has a list they are merged into its frames, and datagrams
+ * with other commands than INDEX/GAIN/COMMIT/RELEASE count as apply errors.
+ * With the DMA backend datagrams arriving while a list streams are rejected
+ * and count as apply errors too.
+ * Datagrams are received in batches of up to UDP_BATCH with recvmmsg(); the
+ * kernel's receive-queue drop count is read through SO_RXQ_OVFL.
+ *
+ * Exported API (see awg_server_raw_shared.h):
+ *   int  start_udp_server(unsigned short port);
+ *   void stop_udp_server(void);
+ *   void get_udp_server_stats(udp_server_stats_t *st);
+ */
+
+#define _GNU_SOURCE
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+#include "awg_core.h"
+#include "awg_hex_decode.h"
+#include "awg_server_raw_shared.h"
+
+#ifdef DEBUG
+  #define DPRINT(fmt, ...) printf("[UDP] " fmt, ##__VA_ARGS__)
+#else
+  #define DPRINT(fmt, ...) do{}while(0)
+#endif
+
+#define SOCK_RCVBUF       (1<<20)
+#define UDP_BATCH         32          // datagrams per recvmmsg()
+#define UDP_MAX_DGRAM     512         // larger than any valid frame: oversize shows up as MSG_TRUNC
+#define MAX_WORDS         AWG_FRAME_WORDS_MAX   // [MODIFIED] a full 16-tone frame (65)
+#define HEX_FRAME_LEN     336
+#define POLL_MS           100         // stop flag check interval
+
+static int g_sock = -1;
+static pthread_t g_thread;
+static bool g_thread_running = false;
+static volatile int g_stop_udp = 0;
+
+static udp_server_stats_t g_st;       // written by the UDP thread, read with relaxed atomics
+static uint32_t g_ovfl_last = 0;      // last SO_RXQ_OVFL value seen
+
+static inline uint64_t mono_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static inline void st_add(uint64_t *c, uint64_t v){ __atomic_fetch_add(c, v, __ATOMIC_RELAXED); }
+
+// Kernel drop counter is cumulative per socket; account only the increase.
+static void note_ovfl(struct msghdr *h){
+    for (struct cmsghdr *c = CMSG_FIRSTHDR(h); c; c = CMSG_NXTHDR(h, c)) {
+        if (c->cmsg_level != SOL_SOCKET || c->cmsg_type != SO_RXQ_OVFL) continue;
+        uint32_t v; memcpy(&v, CMSG_DATA(c), sizeof(v));
+        if (v != g_ovfl_last) { st_add(&g_st.kernel_drops, (uint32_t)(v - g_ovfl_last)); g_ovfl_last = v; }
+    }
+}
+
+static void apply_datagram(const uint8_t *p, size_t len, int flags){
+    if (flags & MSG_TRUNC) { st_add(&g_st.bad_len, 1); return; }
+
+    uint32_t words[MAX_WORDS];
+    int count;
+    if (len == HEX_FRAME_LEN) {
+        if (awg_hex_decode_frame((const char*)p, words) != 0) { st_add(&g_st.bad_hex, 1); return; }
+        count = AWG_HEX_FRAME_WORDS;
+        st_add(&g_st.hex_frames, 1);
+    } else if (len >= 4 && len % 4 == 0 && len / 4 <= MAX_WORDS) {
+        count = (int)(len / 4);
+        memcpy(words, p, len);
+        for (int i = 0; i < count; ++i) words[i] = ntohl(words[i]);
+        st_add(&g_st.word_frames, 1);
+    } else {
+        st_add(&g_st.bad_len, 1);
+        DPRINT("dropping datagram of %zu bytes\n", len);
+        return;
+    }
+    if (queue_direct_frame(words, count) != 0) st_add(&g_st.apply_errors, 1);
+}
+
+static void *udp_thread(void *arg){
+    (void)arg;
+    prctl(PR_SET_NAME, "awg_udp", 0, 0, 0);
+
+    static uint8_t bufs[UDP_BATCH][UDP_MAX_DGRAM];
+    static uint8_t ctl[UDP_BATCH][CMSG_SPACE(sizeof(uint32_t))];
+    struct mmsghdr msgs[UDP_BATCH];
+    struct iovec iov[UDP_BATCH];
+
+    uint64_t rate_t0 = mono_ns(), rate_n0 = 0;
+    while (!g_stop_udp) {
+        struct pollfd pfd = { .fd = g_sock, .events = POLLIN };
+        int pr = poll(&pfd, 1, POLL_MS);
+        if (pr < 0 && errno != EINTR) { perror("[UDP] poll"); break; }
+
+        // Drain everything queued, UDP_BATCH datagrams per syscall
+        while (pr > 0 && !g_stop_udp) {
+            for (int i = 0; i < UDP_BATCH; ++i) {
+                iov[i].iov_base = bufs[i];
+                iov[i].iov_len  = UDP_MAX_DGRAM;
+                memset(&msgs[i].msg_hdr, 0, sizeof(msgs[i].msg_hdr));
+                msgs[i].msg_hdr.msg_iov = &iov[i];
+                msgs[i].msg_hdr.msg_iovlen = 1;
+                msgs[i].msg_hdr.msg_control = ctl[i];
+                msgs[i].msg_hdr.msg_controllen = sizeof(ctl[i]);
+            }
+            int n = recvmmsg(g_sock, msgs, UDP_BATCH, MSG_DONTWAIT, NULL);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                if (errno != EAGAIN && errno != EWOULDBLOCK) perror("[UDP] recvmmsg");
+                break;
+            }
+            st_add(&g_st.batches, 1);
+            st_add(&g_st.datagrams, (uint64_t)n);
+            if ((uint64_t)n > __atomic_load_n(&g_st.max_batch, __ATOMIC_RELAXED))
+                __atomic_store_n(&g_st.max_batch, (uint64_t)n, __ATOMIC_RELAXED);
+            for (int i = 0; i < n; ++i) {
+                note_ovfl(&msgs[i].msg_hdr);
+                apply_datagram(bufs[i], msgs[i].msg_len, msgs[i].msg_hdr.msg_flags);
+            }
+            if (n < UDP_BATCH) break;     // queue drained
+        }
+
+        uint64_t now = mono_ns();
+        if (now - rate_t0 >= 1000000000ull) {
+            uint64_t dg = __atomic_load_n(&g_st.datagrams, __ATOMIC_RELAXED);
+            double rate = (double)(dg - rate_n0) * 1e9 / (double)(now - rate_t0);
+            __atomic_store_n(&g_st.last_rate, (uint64_t)rate, __ATOMIC_RELAXED);
+            if (dg != rate_n0) DPRINT("%.0f datagrams/sec\n", rate);
+            rate_t0 = now; rate_n0 = dg;
+        }
+    }
+    DPRINT("UDP thread exiting.\n");
+    return NULL;
+}
+
+int start_udp_server(unsigned short port){
+    g_sock = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (g_sock < 0) { perror("[UDP] socket"); return -1; }
+    int one = 1;
+    setsockopt(g_sock, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    setsockopt(g_sock, SOL_SOCKET, SO_RCVBUF, &(int){SOCK_RCVBUF}, sizeof(int));
+    if (setsockopt(g_sock, SOL_SOCKET, SO_RXQ_OVFL, &one, sizeof(one)) != 0)
+        DPRINT("SO_RXQ_OVFL unavailable, kernel drops not reported\n");
+
+    struct sockaddr_in addr = {0};
+    addr.sin_family = AF_INET; addr.sin_addr.s_addr = htonl(INADDR_ANY); addr.sin_port = htons(port);
+    if (bind(g_sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("[UDP] bind"); close(g_sock); g_sock = -1; return -2;
+    }
+
+    memset(&g_st, 0, sizeof(g_st));
+    g_ovfl_last = 0;
+    g_stop_udp = 0;
+    if (pthread_create(&g_thread, NULL, udp_thread, NULL) != 0) {
+        perror("[UDP] pthread_create"); close(g_sock); g_sock = -1; return -3;
+    }
+    g_thread_running = true;
+    printf("[UDP] listening on %u (hex336 / binary words, no-queue)\n", port);
+    return 0;
+}
+
+void stop_udp_server(void){
+    g_stop_udp = 1;
+    if (g_thread_running) { pthread_join(g_thread, NULL); g_thread_running = false; }
+    if (g_sock >= 0) { close(g_sock); g_sock = -1; }
+}
+
+void get_udp_server_stats(udp_server_stats_t *st){
+    st->datagrams    = __atomic_load_n(&g_st.datagrams,    __ATOMIC_RELAXED);
+    st->batches      = __atomic_load_n(&g_st.batches,      __ATOMIC_RELAXED);
+    st->max_batch    = __atomic_load_n(&g_st.max_batch,    __ATOMIC_RELAXED);
+    st->hex_frames   = __atomic_load_n(&g_st.hex_frames,   __ATOMIC_RELAXED);
+    st->word_frames  = __atomic_load_n(&g_st.word_frames,  __ATOMIC_RELAXED);
+    st->bad_len      = __atomic_load_n(&g_st.bad_len,      __ATOMIC_RELAXED);
+    st->bad_hex      = __atomic_load_n(&g_st.bad_hex,      __ATOMIC_RELAXED);
+    st->apply_errors = __atomic_load_n(&g_st.apply_errors, __ATOMIC_RELAXED);
+    st->kernel_drops = __atomic_load_n(&g_st.kernel_drops, __ATOMIC_RELAXED);
+    st->last_rate    = __atomic_load_n(&g_st.last_rate,    __ATOMIC_RELAXED);
+}
@@ -0,0 +1,116 @@
+/*
+ * awg_shm_ingest.c — Shared-memory preload region (see awg_shm_ingest.h).
+ * The server maps the object MAP_SHARED|MAP_POPULATE (mlockall(MCL_FUTURE)
+ * also locks it), so the player reads slots without faulting. Only the
+ * reactor thread calls into this module.
+ */
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "awg_shm_ingest.h"
+
+#ifdef DEBUG
+  #define DPRINT(fmt, ...) printf("[SHM] " fmt, ##__VA_ARGS__)
+#else
+  #define DPRINT(fmt, ...) do{}while(0)
+#endif
+
+#define MAX_SLOT_WORDS (64u << 20)      // 256 MiB per slot
+
+static awg_shm_hdr_t *g_hdr  = NULL;
+static size_t         g_len  = 0;
+static size_t         g_slot_bytes = 0;
+
+_Static_assert(sizeof(awg_shm_hdr_t) <= AWG_SHM_ALIGN, "shm header must fit its page");
+_Static_assert((AWG_SHM_RING_SIZE & (AWG_SHM_RING_SIZE - 1)) == 0, "ring size must be a power of two");
+
+int awg_shm_open(uint32_t slots, uint32_t slot_words)
+{
+    if (slots == 0 || slots > AWG_SHM_MAX_SLOTS || slot_words == 0 || slot_words > MAX_SLOT_WORDS) return -1;
+    g_slot_bytes = ((size_t)slot_words * sizeof(uint32_t) + AWG_SHM_ALIGN - 1) & ~(size_t)(AWG_SHM_ALIGN - 1);
+    size_t len = AWG_SHM_ALIGN + (size_t)slots * g_slot_bytes;
+
+    shm_unlink(AWG_SHM_NAME);                     // a stale region of an earlier run
+    int fd = shm_open(AWG_SHM_NAME, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0660);
+    if (fd < 0) { perror("shm_open " AWG_SHM_NAME); return -2; }
+    if (ftruncate(fd, (off_t)len) != 0) {
+        perror("ftruncate " AWG_SHM_NAME);
+        close(fd); shm_unlink(AWG_SHM_NAME);
+        return -2;
+    }
+    void *map = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) { perror("mmap " AWG_SHM_NAME); shm_unlink(AWG_SHM_NAME); return -2; }
+
+    g_hdr = map;
+    g_len = len;
+    g_hdr->slots      = slots;
+    g_hdr->slot_words = slot_words;
+    g_hdr->ring_size  = AWG_SHM_RING_SIZE;
+    g_hdr->version    = AWG_SHM_VERSION;
+    __atomic_store_n(&g_hdr->magic, AWG_SHM_MAGIC, __ATOMIC_RELEASE);   // last: region ready
+    DPRINT("Ingest region %s: %u slots of %u words (%zu bytes).\n", AWG_SHM_NAME, slots, slot_words, len);
+    return 0;
+}
+
+void awg_shm_close(void)
+{
+    if (!g_hdr) return;
+    munmap(g_hdr, g_len);
+    shm_unlink(AWG_SHM_NAME);
+    g_hdr = NULL;
+    g_len = 0;
+}
+
+bool awg_shm_active(void) { return g_hdr != NULL; }
+
+int awg_shm_pop(awg_shm_desc_t *d)
+{
+    if (!g_hdr) return 0;
+    uint32_t tail = g_hdr->tail;
+    if (__atomic_load_n(&g_hdr->head, __ATOMIC_ACQUIRE) == tail) return 0;
+    memcpy(d, &g_hdr->ring[tail & (AWG_SHM_RING_SIZE - 1)], sizeof(*d));   // snapshot: checked after this
+    __atomic_store_n(&g_hdr->tail, tail + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+int awg_shm_check(const awg_shm_desc_t *d, uint32_t max_frame_words, uint32_t max_frames)
+{
+    if (!g_hdr || d->slot >= g_hdr->slots) return -1;
+    uint64_t cap = g_hdr->slot_words;
+    bool ok = d->frames > 0 && d->frames <= max_frames && d->words <= cap;
+    if (ok && d->frame_words)
+        ok = d->frame_words <= max_frame_words && (uint64_t)d->frames * d->frame_words == d->words;
+    else if (ok)
+        ok = d->index_off >= d->words && (uint64_t)d->index_off + d->frames + 1 <= cap;
+    return ok ? 0 : -3;
+}
+
+const uint32_t *awg_shm_words(uint32_t slot)
+{
+    return (const uint32_t *)((const uint8_t *)g_hdr + AWG_SHM_ALIGN + (size_t)slot * g_slot_bytes);
+}
+
+bool awg_shm_copy_index(const awg_shm_desc_t *d, uint32_t *dst, uint32_t max_frame_words)
+{
+    memcpy(dst, awg_shm_words(d->slot) + d->index_off, ((size_t)d->frames + 1) * sizeof(uint32_t));
+    if (dst[0] != 0 || dst[d->frames] != d->words) return false;
+    for (uint32_t i = 0; i < d->frames; ++i)
+        if (dst[i + 1] <= dst[i] || dst[i + 1] - dst[i] > max_frame_words) return false;
+    return true;
+}
+
+void awg_shm_release(uint32_t slot)
+{
+    if (!g_hdr || slot >= g_hdr->slots) return;
+    __atomic_store_n(&g_hdr->slot_state[slot], AWG_SHM_SLOT_FREE, __ATOMIC_RELEASE);
+    DPRINT("Slot %u handed back to the producer.\n", slot);
+}
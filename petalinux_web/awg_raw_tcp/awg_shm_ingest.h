@@ -0,0 +1,99 @@
+// awg_shm_ingest.h — Shared-memory preload for producers on the board.
+// The queue server creates the POSIX shm object AWG_SHM_NAME (visible as
+// /dev/shm/awg_ingest) when AWG_SHM_SLOTS > 0. A local process writes a
+// list's words into a free slot in native byte order, queues a descriptor
+// and rings the doorbell ('I' on port 9100); the GPIO player then plays the
+// words straight from the slot, no socket copy, byte swap or memcpy.
+//
+// Layout (native byte order, offsets in bytes):
+//   0x0000          header awg_shm_hdr_t (rest of the page zero)
+//     0   magic, version, slots, slot_words, ring_size
+//     64  head       descriptors queued (producer stores only)
+//     128 tail       descriptors taken  (server stores only)
+//     192 slot_state[AWG_SHM_MAX_SLOTS]  AWG_SHM_SLOT_*
+//     320 ring[AWG_SHM_RING_SIZE]        awg_shm_desc_t, entry head % ring_size
+//   AWG_SHM_ALIGN + k*slot_bytes   slot k, slot_bytes = slot_words*4 rounded up to 4 KiB
+//
+// Producer, per list:
+//   1. pick a slot whose state is FREE, write words[] at its start (and for
+//      variable frame sizes the prefix sums starts[frames+1] at index_off)
+//   2. set its state to SERVER, fill ring[head % ring_size], then head + 1
+//   3. send 'I'; the server takes every queued descriptor (READY/notify as for
+//      'E'; an invalid one drops the connection and hands its slot back)
+// A slot stays SERVER until its list is loaded again, RESET, or the server
+// stops; keep at least queue depth + 1 slots to fill one while others play.
+// The doorbell is a syscall, which orders the producer's stores for
+// languages without atomics.
+
+#ifndef AWG_SHM_INGEST_H
+#define AWG_SHM_INGEST_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define AWG_SHM_NAME          "/awg_ingest"
+#define AWG_SHM_MAGIC         0x53475741u   // "AWGS" read as little-endian uint32
+#define AWG_SHM_VERSION       1u
+#define AWG_SHM_ALIGN         4096u
+#define AWG_SHM_MAX_SLOTS     32
+#define AWG_SHM_RING_SIZE     32            // power of two
+#define AWG_SHM_SLOT_FREE     0u            // the producer owns the slot
+#define AWG_SHM_SLOT_SERVER   1u            // queued or held by a list: do not touch
+
+typedef struct {
+    uint32_t slot;
+    uint32_t list_id;
+    uint32_t frames;
+    uint32_t words;          // words[0..words) at the start of the slot
+    uint32_t frame_words;    // >0: fixed frame size; 0: starts[] at index_off
+    uint32_t index_off;      // word offset of starts[frames+1] in the slot
+    uint32_t period_us;      // 0 = global period
+    uint32_t repeat;         // 0 = loop
+    uint32_t flags;          // AWG_LIST_FILE_DELTA
+    uint32_t reserved[3];
+} awg_shm_desc_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slots;
+    uint32_t slot_words;
+    uint32_t ring_size;
+    uint32_t reserved[11];
+    uint32_t head;
+    uint32_t pad0[15];
+    uint32_t tail;
+    uint32_t pad1[15];
+    uint32_t slot_state[AWG_SHM_MAX_SLOTS];
+    awg_shm_desc_t ring[AWG_SHM_RING_SIZE];
+} awg_shm_hdr_t;
+
+// Create (or recreate) and map the region, every slot FREE. Returns 0,
+// -1 bad size, -2 shm/mmap error.
+int  awg_shm_open(uint32_t slots, uint32_t slot_words);
+
+// Unmap and unlink the region.
+void awg_shm_close(void);
+
+bool awg_shm_active(void);
+
+// Next queued descriptor, copied out of the ring. Returns 1, or 0 if none
+// (or no region).
+int  awg_shm_pop(awg_shm_desc_t *d);
+
+// Bounds-check a popped descriptor's slot and fixed-size geometry
+// (frames 1..max_frames, frame_words ≤ max_frame_words, words inside the slot).
+// Returns 0, -1 bad slot, -3 bad geometry.
+int  awg_shm_check(const awg_shm_desc_t *d, uint32_t max_frame_words, uint32_t max_frames);
+
+// Words of a slot (valid while the region is open).
+const uint32_t *awg_shm_words(uint32_t slot);
+
+// Variable frame sizes: copy starts[frames+1] to dst, then check the copy
+// (the producer could still write the slot). False if it does not tile words[].
+bool awg_shm_copy_index(const awg_shm_desc_t *d, uint32_t *dst, uint32_t max_frame_words);
+
+// Hand a slot back to the producer.
+void awg_shm_release(uint32_t slot);
+
+#endif // AWG_SHM_INGEST_H
@@ -0,0 +1,136 @@
+/*
+ * awg_sock_reader.c — Buffered socket reader (see awg_sock_reader.h)
+ * The buffer is linear: unread bytes are slid to the front before a refill,
+ * which moves less than one command since the parsers drain it as they go.
+ */
+#include <errno.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+
+#include "awg_sock_reader.h"
+
+int64_t awg_reader_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+int awg_reader_init(awg_reader_t *r, int fd, size_t cap, int timeout_ms) {
+    memset(r, 0, sizeof(*r));
+    r->fd = fd;
+    r->timeout_ms = timeout_ms;
+    r->cap = cap ? cap : AWG_READER_DEFAULT_CAP;
+    r->buf = (uint8_t*)malloc(r->cap);
+    return r->buf ? 0 : -1;
+}
+
+void awg_reader_free(awg_reader_t *r) {
+    free(r->buf);
+    r->buf = NULL;
+    r->cap = r->rd = r->wr = 0;
+}
+
+static inline void count_bytes(awg_reader_t *r, ssize_t n) {
+    if (r->ctr) __atomic_fetch_add(&r->ctr->bytes, (uint64_t)n, __ATOMIC_RELAXED);
+}
+
+// Wait until fd is readable. Return 1 readable, 0 closed, -2 timeout, -1 error.
+static int wait_readable(awg_reader_t *r, int64_t deadline_ms) {
+    for (;;) {
+        int to = r->timeout_ms;
+        if (deadline_ms >= 0) {
+            int64_t rem = deadline_ms - awg_reader_now_ms();
+            if (rem <= 0) return -2;
+            to = (rem > 60000) ? 60000 : (int)rem;
+        }
+        struct pollfd pfd = { .fd = r->fd, .events = POLLIN };
+        int pr = poll(&pfd, 1, to);
+        if (pr == 0) return -2;
+        if (pr < 0) { if (errno == EINTR) continue; return -1; }
+        if (pfd.revents & POLLIN) return 1;     // drain data before honouring HUP
+        if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) return 0;
+    }
+}
+
+// One recv() of up to len bytes into p. Try without waiting first, poll only
+// when the socket is empty. Return bytes (>0), 0 closed, -2 timeout, -1 error.
+static ssize_t recv_some(awg_reader_t *r, void *p, size_t len, int64_t deadline_ms) {
+    for (;;) {
+        ssize_t n = recv(r->fd, p, len, MSG_DONTWAIT);
+        if (n > 0) { count_bytes(r, n); return n; }
+        if (n == 0) return 0;
+        if (errno == EINTR) continue;
+        if (errno != EAGAIN && errno != EWOULDBLOCK) return -1;
+        int w = wait_readable(r, deadline_ms);
+        if (w == -2 && r->ctr) __atomic_fetch_add(&r->ctr->timeouts, 1, __ATOMIC_RELAXED);
+        if (w != 1) return w;
+    }
+}
+
+int awg_reader_read(awg_reader_t *r, void *dst, size_t n, int64_t deadline_ms) {
+    uint8_t *out = (uint8_t*)dst;
+
+    // 1) Whatever is buffered already
+    size_t have = r->wr - r->rd;
+    size_t take = have < n ? have : n;
+    memcpy(out, r->buf + r->rd, take);
+    r->rd += take; out += take; n -= take;
+    if (r->rd == r->wr) r->rd = r->wr = 0;
+    if (n == 0) return 1;
+
+    // 2) Large remainder: receive straight into the caller's buffer
+    while (n >= r->cap) {
+        ssize_t got = recv_some(r, out, n, deadline_ms);
+        if (got <= 0) return (int)got;
+        out += got; n -= (size_t)got;
+    }
+
+    // 3) Small remainder: refill the buffer with as much as the socket has
+    while (r->wr - r->rd < n) {
+        if (r->rd > 0) {                       // slide the unread tail to the front
+            memmove(r->buf, r->buf + r->rd, r->wr - r->rd);
+            r->wr -= r->rd; r->rd = 0;
+        }
+        ssize_t got = recv_some(r, r->buf + r->wr, r->cap - r->wr, deadline_ms);
+        if (got <= 0) return (int)got;
+        r->wr += (size_t)got;
+    }
+    memcpy(out, r->buf + r->rd, n);
+    r->rd += n;
+    if (r->rd == r->wr) r->rd = r->wr = 0;
+    return 1;
+}
+
+int awg_reader_fill_nb(awg_reader_t *r) {
+    if (r->rd > 0) {
+        memmove(r->buf, r->buf + r->rd, r->wr - r->rd);
+        r->wr -= r->rd; r->rd = 0;
+    }
+    if (r->wr == r->cap) return -4;
+    for (;;) {
+        ssize_t n = recv(r->fd, r->buf + r->wr, r->cap - r->wr, MSG_DONTWAIT);
+        if (n > 0) { r->wr += (size_t)n; count_bytes(r, n); return (int)n; }
+        if (n == 0) return 0;
+        if (errno == EINTR) continue;
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? -3 : -1;
+    }
+}
+
+int awg_reader_recv_nb(awg_reader_t *r, void *dst, size_t n) {
+    for (;;) {
+        ssize_t got = recv(r->fd, dst, n, MSG_DONTWAIT);
+        if (got > 0) { count_bytes(r, got); return (int)got; }
+        if (got == 0) return 0;
+        if (errno == EINTR) continue;
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? -3 : -1;
+    }
+}
+
+void awg_reader_consume(awg_reader_t *r, size_t n) {
+    size_t have = r->wr - r->rd;
+    r->rd += n < have ? n : have;
+    if (r->rd == r->wr) r->rd = r->wr = 0;
+}
@@ -0,0 +1,62 @@
+// awg_sock_reader.h — Buffered socket reader shared by the raw TCP servers.
+// One large recv() fills a per-connection buffer; the command parsers then
+// take headers and payloads from user space instead of one poll()+recv()
+// pair per field.
+
+#ifndef AWG_SOCK_READER_H
+#define AWG_SOCK_READER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define AWG_READER_DEFAULT_CAP (64*1024)
+
+// [NEW] Optional per-server totals (relaxed atomics, readable from any thread)
+typedef struct {
+    uint64_t bytes;        // bytes received
+    uint64_t timeouts;     // reads that gave up waiting (-2)
+} awg_reader_counters_t;
+
+typedef struct {
+    int      fd;
+    int      timeout_ms;   // per-refill poll timeout
+    uint8_t *buf;
+    size_t   cap;
+    size_t   rd;           // next unread byte
+    size_t   wr;           // end of buffered data
+    awg_reader_counters_t *ctr;  // [NEW] NULL = not counted
+} awg_reader_t;
+
+// Return 0 ok, -1 out of memory.
+int  awg_reader_init(awg_reader_t *r, int fd, size_t cap, int timeout_ms);
+void awg_reader_free(awg_reader_t *r);
+
+// [NEW] Add this reader's traffic to *ctr from now on (shared by many readers).
+static inline void awg_reader_count(awg_reader_t *r, awg_reader_counters_t *ctr) { r->ctr = ctr; }
+
+// Copy exactly n bytes into dst. Parts larger than the buffer are received
+// straight into dst. deadline_ms: absolute CLOCK_MONOTONIC ms for the whole
+// read, or < 0 for the per-refill timeout only.
+// Return 1 ok, 0 peer closed, -2 timeout, -1 error (errno set).
+int  awg_reader_read(awg_reader_t *r, void *dst, size_t n, int64_t deadline_ms);
+
+// Bytes already buffered (no syscall needed to consume them).
+static inline size_t awg_reader_buffered(const awg_reader_t *r) { return r->wr - r->rd; }
+
+// [NEW] Event-loop use: read whatever the socket has without waiting.
+// Return bytes added (>0), 0 peer closed, -3 nothing available, -1 error,
+// -4 buffer full (consume first).
+int  awg_reader_fill_nb(awg_reader_t *r);
+
+// [NEW] Event-loop use, large payloads: one recv() of up to n bytes straight
+// into dst without waiting, for when nothing is buffered (take those bytes
+// first). Same returns as awg_reader_fill_nb() except -4.
+int  awg_reader_recv_nb(awg_reader_t *r, void *dst, size_t n);
+
+// [NEW] Buffered bytes in place; valid until the next fill/read.
+static inline const uint8_t *awg_reader_peek(const awg_reader_t *r) { return r->buf + r->rd; }
+void awg_reader_consume(awg_reader_t *r, size_t n);
+
+int64_t awg_reader_now_ms(void);
+
+#endif // AWG_SOCK_READER_H
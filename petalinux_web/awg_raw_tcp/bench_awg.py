@@ -0,0 +1,432 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+Throughput / latency benchmark for awg_server (host with the sim backend,
+or the board itself). Results go to stdout as one JSON object.
+
+Measurements:
+  preload_bulk_mb_s / preload_push_mb_s  BEGIN..READY of a list sent with 'M' / 'P' (best of 3)
+  preload_shm_mb_s                       same list written into the shm ingest region + 'I'
+                                         (local server only, AWG_SHM_SLOTS > 0)
+  queue_fps                              frames/s the player sustains at the 10 us period
+  tick_late_p50_us / _p99_us / _max_us   player wakeup lateness at 1 ms ('Q' histogram)
+  reset_ms_median / reset_ms_max         'Z' while a list loops, until every list is IDLE
+  direct_fps                             W frames/s through port 9000
+  udp_offered_fps / udp_applied          binary word datagrams to the UDP port
+
+Usage:
+  python3 bench_awg.py --spawn ./awg_server              # host: fresh sim server per test
+  python3 bench_awg.py --host wavegenz7.local            # against a running server
+  python3 bench_awg.py --spawn ./awg_server --baseline last.json   # exit 1 on regression
+  make -f Makefile.onboard bench                          # build + host run
+"""
+
+import argparse
+import array
+import json
+import mmap
+import os
+import re
+import signal
+import socket
+import statistics
+import struct
+import subprocess
+import sys
+import time
+
+CONTROL_PORT = 9100
+NOTIFY_PORT = 9101
+DIRECT_PORT = 9000
+UDP_PORT = 8766
+
+LIST_IDLE, LIST_LOADING, LIST_READY = 0, 1, 2
+EV_STATUS, EV_START = 1, 2
+HIST_BUCKETS = 16
+SHM_PATH = "/dev/shm/awg_ingest"
+
+# metric -> True if higher is better (used by --baseline)
+HIGHER_BETTER = {
+    "preload_bulk_mb_s": True, "preload_push_mb_s": True, "preload_shm_mb_s": True, "queue_fps": True,
+    "direct_fps": True, "udp_offered_fps": True,
+    "tick_late_p50_us": False, "tick_late_p99_us": False, "tick_late_max_us": False,
+    "reset_ms_median": False, "reset_ms_max": False,
+}
+
+
+def log(msg):
+    print(msg, file=sys.stderr, flush=True)
+
+
+# ---------- Frames ----------
+def frame_words(i):
+    """One full 2x8-tone frame: INDEX+GAIN per tone, then COMMIT (33 words)."""
+    w = []
+    for ch in range(2):
+        for t in range(8):
+            sel = (ch << 27) | (t << 24)
+            w.append((0x1 << 28) | sel | ((i + t) % 900))
+            w.append((0x2 << 28) | sel | 0x1000)
+    w.append(0xF << 28)
+    return w
+
+
+# ---------- Server under test ----------
+class Server:
+    """Optionally spawns a sim server; stop() returns its [MAIN] summary lines."""
+
+    def __init__(self, spawn, host):
+        self.spawn, self.host, self.proc = spawn, host, None
+
+    def start(self):
+        if not self.spawn:
+            return
+        env = dict(os.environ, AWG_CORE_BACKEND=os.environ.get("AWG_CORE_BACKEND", "sim"),
+                   AWG_RT_MLOCK=os.environ.get("AWG_RT_MLOCK", "0"),
+                   AWG_SHM_SLOTS=os.environ.get("AWG_SHM_SLOTS", "3"))
+        self.proc = subprocess.Popen([self.spawn], env=env, stdout=subprocess.PIPE,
+                                     stderr=subprocess.STDOUT, text=True)
+        deadline = time.time() + 5
+        while time.time() < deadline:
+            try:
+                socket.create_connection((self.host, NOTIFY_PORT), timeout=0.2).close()
+                return
+            except OSError:
+                time.sleep(0.05)
+        self.stop()
+        raise RuntimeError("server did not come up")
+
+    def stop(self):
+        if not self.proc:
+            return ""
+        self.proc.send_signal(signal.SIGINT)
+        out, _ = self.proc.communicate(timeout=10)
+        self.proc = None
+        return out
+
+
+class Notify:
+    """Binary event channel (port 9101, 'B' mode)."""
+
+    def __init__(self, host):
+        self.s = socket.create_connection((host, NOTIFY_PORT), timeout=5)
+        self.s.settimeout(0.05)
+        time.sleep(0.05)
+        try:
+            self.s.recv(4096)          # ASCII snapshot sent before the switch
+        except socket.timeout:
+            pass
+        self.s.sendall(b"B")
+        self.buf = b""
+        self.wait(lambda e: False, 0.1)   # drop the binary snapshot
+
+    def wait(self, pred, timeout):
+        """Return the first event matching pred (dict) and its local arrival time."""
+        end = time.time() + timeout
+        while True:
+            while len(self.buf) >= 20:
+                t, lid, st, fl, seq, fr, tns = struct.unpack(">BBBBIIQ", self.buf[:20])
+                self.buf = self.buf[20:]
+                ev = {"type": t, "list": lid, "status": st, "frame": fr, "t_ns": tns}
+                if pred(ev):
+                    return ev, time.perf_counter()
+            if time.time() > end:
+                return None, time.perf_counter()
+            try:
+                d = self.s.recv(65536)
+                if not d:
+                    return None, time.perf_counter()
+                self.buf += d
+            except socket.timeout:
+                pass
+
+    def close(self):
+        self.s.close()
+
+
+def control(host):
+    s = socket.create_connection((host, CONTROL_PORT), timeout=10)
+    s.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+    return s
+
+
+def status_ev(lid, st):
+    return lambda e: e["type"] == EV_STATUS and e["list"] == lid and e["status"] == st
+
+
+def query(c, clear=False):
+    c.sendall(b"Q" + bytes([1 if clear else 0]))
+    need = 6 + 8 * (12 + 3 * HIST_BUCKETS)
+    buf = b""
+    while len(buf) < need:
+        d = c.recv(need - len(buf))
+        if not d:
+            raise RuntimeError("stats reply truncated")
+        buf += d
+    v = struct.unpack(">%dQ" % ((need - 6) // 8), buf[6:])
+    return {"ticks": v[0], "frames": v[1], "missed": v[4], "max_late_ns": v[5],
+            "late": list(v[8:8 + HIST_BUCKETS]), "overrun_burst": v[8 + 3 * HIST_BUCKETS]}
+
+
+def hist_percentile_us(h, p):
+    """Upper edge (us) of the bucket holding the p-quantile."""
+    total = sum(h)
+    if not total:
+        return 0
+    acc = 0
+    for b, n in enumerate(h):
+        acc += n
+        if acc >= p * total:
+            return 1 << b
+    return 1 << (len(h) - 1)
+
+
+def bulk_list(lid, frames):
+    ws = []
+    for i in range(frames):
+        ws += frame_words(i)
+    counts = struct.pack(">%dH" % frames, *([33] * frames))
+    return (b"b" + struct.pack(">BII", lid, frames, len(ws)) + b"M" + struct.pack(">BI", lid, frames)
+            + counts + struct.pack(">%dI" % len(ws), *ws) + b"E" + bytes([lid]))
+
+
+def push_list(lid, frames):
+    msg = [b"b" + struct.pack(">BII", lid, frames, 33 * frames)]
+    for i in range(frames):
+        msg.append(b"P" + struct.pack(">BH", lid, 33) + struct.pack(">33I", *frame_words(i)))
+    msg.append(b"E" + bytes([lid]))
+    return b"".join(msg)
+
+
+class ShmIngest:
+    """Producer side of the shm ingest region (layout in awg_shm_ingest.h)."""
+
+    def __init__(self):
+        self.f = open(SHM_PATH, "r+b")
+        self.m = mmap.mmap(self.f.fileno(), 0)
+        magic, ver, self.slots, self.slot_words, self.ring = struct.unpack_from("=5I", self.m, 0)
+        if magic != 0x53475741 or ver != 1:
+            raise RuntimeError("not an AWG ingest region")
+        self.slot_bytes = (self.slot_words * 4 + 4095) & ~4095
+
+    def submit(self, lid, frames, frame_words, data):
+        """Copy native-endian words into a free slot and queue the descriptor."""
+        for k in range(self.slots):
+            if struct.unpack_from("=I", self.m, 192 + 4 * k)[0] == 0:
+                break
+        else:
+            raise RuntimeError("no free ingest slot")
+        base = 4096 + k * self.slot_bytes
+        self.m[base:base + len(data)] = data
+        struct.pack_into("=I", self.m, 192 + 4 * k, 1)
+        head = struct.unpack_from("=I", self.m, 64)[0]
+        struct.pack_into("=12I", self.m, 320 + 48 * (head % self.ring),
+                         k, lid, frames, len(data) // 4, frame_words, 0, 0, 1, 0, 0, 0, 0)
+        struct.pack_into("=I", self.m, 64, head + 1)
+
+    def close(self):
+        self.m.close(); self.f.close()
+
+
+# ---------- Tests ----------
+def bench_preload(host, frames, m):
+    n = Notify(host)
+    c = control(host)
+    for key, payload in (("preload_bulk_mb_s", bulk_list(0, frames)), ("preload_push_mb_s", push_list(0, frames))):
+        best = 0.0
+        for _ in range(3):            # the first run also sizes the list arena
+            t0 = time.perf_counter()
+            c.sendall(payload)
+            ev, t1 = n.wait(status_ev(0, LIST_READY), 30)
+            if not ev:
+                raise RuntimeError(key + ": list never became READY")
+            best = max(best, len(payload) / (t1 - t0) / 1e6)
+            c.sendall(b"Z")
+            n.wait(status_ev(1, LIST_IDLE), 5)
+        m[key] = round(best, 2)
+        log("  %-20s %8.2f MB/s (%d bytes)" % (key, m[key], len(payload)))
+    if host in ("127.0.0.1", "localhost") and os.path.exists(SHM_PATH):
+        ws = []
+        for i in range(frames):
+            ws += frame_words(i)
+        data = array.array("I", ws).tobytes()
+        shm, best = ShmIngest(), 0.0
+        for _ in range(3):
+            t0 = time.perf_counter()
+            shm.submit(0, frames, 33, data)
+            c.sendall(b"I")
+            ev, t1 = n.wait(status_ev(0, LIST_READY), 30)
+            if not ev:
+                raise RuntimeError("preload_shm_mb_s: list never became READY")
+            best = max(best, len(data) / (t1 - t0) / 1e6)
+            c.sendall(b"Z")
+            n.wait(status_ev(1, LIST_IDLE), 5)
+        shm.close()
+        m["preload_shm_mb_s"] = round(best, 2)
+        log("  %-20s %8.2f MB/s (%d bytes)" % ("preload_shm_mb_s", best, len(data)))
+    c.close(); n.close()
+
+
+def bench_queue_fps(host, frames, m):
+    n = Notify(host)
+    c = control(host)
+    c.sendall(b"T" + struct.pack(">I", 10))
+    c.sendall(bulk_list(0, frames))
+    start, _ = n.wait(lambda e: e["type"] == EV_START and e["list"] == 0, 30)
+    idle, _ = n.wait(lambda e: status_ev(0, LIST_IDLE)(e) and e["frame"] > 0, 60)
+    if not start or not idle:
+        raise RuntimeError("queue_fps: list did not play through")
+    st = query(c)
+    m["queue_fps"] = round(frames / ((idle["t_ns"] - start["t_ns"]) / 1e9))
+    m["queue_overrun_burst"] = st["overrun_burst"]
+    c.sendall(b"T" + struct.pack(">I", 1000))
+    log("  %-20s %8d frames/s (target 100000, %d burst overruns)" % ("queue_fps", m["queue_fps"], st["overrun_burst"]))
+    c.close(); n.close()
+
+
+def bench_jitter(host, frames, m):
+    n = Notify(host)
+    c = control(host)
+    c.sendall(b"T" + struct.pack(">I", 1000))
+    query(c, clear=True)
+    time.sleep(1.1)                   # idle > 1 s: the sim's commit-gap stats skip start-up
+    c.sendall(bulk_list(0, frames))
+    idle, _ = n.wait(lambda e: status_ev(0, LIST_IDLE)(e) and e["frame"] > 0, frames / 1000 + 10)
+    if not idle:
+        raise RuntimeError("jitter: list did not play through")
+    st = query(c)
+    m["tick_late_p50_us"] = hist_percentile_us(st["late"], 0.50)
+    m["tick_late_p99_us"] = hist_percentile_us(st["late"], 0.99)
+    m["tick_late_max_us"] = round(st["max_late_ns"] / 1000, 1)
+    m["tick_missed"] = st["missed"]
+    time.sleep(1.1)                   # ... and the final zero-out
+    log("  %-20s p50 <%d us, p99 <%d us, max %.1f us, %d missed" % ("tick_late", m["tick_late_p50_us"],
+        m["tick_late_p99_us"], m["tick_late_max_us"], st["missed"]))
+    c.close(); n.close()
+
+
+def bench_reset(host, trials, m):
+    n = Notify(host)
+    c = control(host)
+    lat = []
+    for _ in range(trials):
+        c.sendall(b"B" + struct.pack(">BI", 0, 10)
+                  + b"".join(b"P" + struct.pack(">BH", 0, 33) + struct.pack(">33I", *frame_words(i)) for i in range(10))
+                  + b"R" + struct.pack(">BI", 0, 0) + b"E" + bytes([0]))
+        n.wait(lambda e: e["type"] == EV_START and e["list"] == 0, 5)
+        time.sleep(0.02)
+        t0 = time.perf_counter()
+        c.sendall(b"Z")
+        idle = set()
+        while len(idle) < 2:
+            ev, t1 = n.wait(lambda e: e["type"] == EV_STATUS and e["status"] == LIST_IDLE, 5)
+            if not ev:
+                raise RuntimeError("reset: lists did not return to IDLE")
+            idle.add(ev["list"])
+        lat.append((t1 - t0) * 1e3)
+    m["reset_ms_median"] = round(statistics.median(lat), 2)
+    m["reset_ms_max"] = round(max(lat), 2)
+    log("  %-20s median %.2f ms, max %.2f ms (%d trials)" % ("reset", m["reset_ms_median"], m["reset_ms_max"], trials))
+    c.close(); n.close()
+
+
+def bench_direct(host, frames, m):
+    s = socket.create_connection((host, DIRECT_PORT), timeout=30)
+    s.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+    one = [struct.pack(">H", 33) + struct.pack(">33I", *frame_words(i)) for i in range(64)]
+    payload = b"".join(one[i % 64] for i in range(frames))
+    t0 = time.perf_counter()
+    s.sendall(payload)
+    s.shutdown(socket.SHUT_WR)
+    while s.recv(4096):              # EOF once the server applied every frame and closed
+        pass
+    dt = time.perf_counter() - t0
+    s.close()
+    m["direct_fps"] = round(frames / dt)
+    log("  %-20s %8d frames/s" % ("direct_fps", m["direct_fps"]))
+
+
+def bench_udp(host, frames, m):
+    s = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    dgrams = [struct.pack(">33I", *frame_words(i)) for i in range(64)]
+    t0 = time.perf_counter()
+    for i in range(frames):
+        s.sendto(dgrams[i % 64], (host, UDP_PORT))
+    dt = time.perf_counter() - t0
+    s.close()
+    time.sleep(0.2)
+    m["udp_offered_fps"] = round(frames / dt)
+    m["udp_sent"] = frames
+    log("  %-20s %8d frames/s offered" % ("udp_offered_fps", m["udp_offered_fps"]))
+
+
+def parse_summary(out, m, key):
+    """Pick the numbers a spawned server prints at shutdown."""
+    r = re.search(r"\[MAIN\] udp: (\d+) datagrams \((\d+) hex, (\d+) words\)", out)
+    if r and key == "udp":
+        m["udp_applied"] = int(r.group(3))
+    r = re.search(r"\[MAIN\] sim: .*commit gap min (\d+) / mean (\d+) / max (\d+) us", out)
+    if r and key == "jitter":
+        m["sim_commit_gap_min_us"], m["sim_commit_gap_mean_us"], m["sim_commit_gap_max_us"] = map(int, r.groups())
+
+
+def compare(metrics, baseline, tol):
+    bad = []
+    for k, higher in HIGHER_BETTER.items():
+        if k not in metrics or k not in baseline or not baseline[k]:
+            continue
+        ratio = metrics[k] / baseline[k]
+        if (higher and ratio < 1 - tol) or (not higher and ratio > 1 + tol):
+            bad.append("%s: %s -> %s" % (k, baseline[k], metrics[k]))
+    return bad
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--host", default="127.0.0.1")
+    ap.add_argument("--spawn", metavar="SERVER", help="start a fresh (sim) server for every test")
+    ap.add_argument("--frames", type=int, default=20000, help="frames per throughput test")
+    ap.add_argument("--quick", action="store_true", help="small sizes, for every-build runs")
+    ap.add_argument("--out", help="also write the JSON result to this file")
+    ap.add_argument("--baseline", help="JSON result of an earlier run to compare against")
+    ap.add_argument("--tolerance", type=float, default=0.25, help="allowed relative regression")
+    args = ap.parse_args()
+
+    frames = 2000 if args.quick else args.frames
+    tests = [
+        ("preload", lambda m: bench_preload(args.host, frames, m)),
+        ("queue",   lambda m: bench_queue_fps(args.host, frames, m)),
+        ("jitter",  lambda m: bench_jitter(args.host, 500 if args.quick else 2000, m)),
+        ("reset",   lambda m: bench_reset(args.host, 5 if args.quick else 20, m)),
+        ("direct",  lambda m: bench_direct(args.host, frames, m)),
+        ("udp",     lambda m: bench_udp(args.host, frames, m)),
+    ]
+    metrics = {}
+    srv = Server(args.spawn, args.host)
+    for name, fn in tests:
+        log("[BENCH] %s" % name)
+        srv.start()
+        try:
+            fn(metrics)
+        finally:
+            parse_summary(srv.stop(), metrics, name)
+
+    result = {"schema": 1, "host": args.host, "spawned": bool(args.spawn),
+              "backend": os.environ.get("AWG_CORE_BACKEND", "sim") if args.spawn else None,
+              "time": time.strftime("%Y-%m-%dT%H:%M:%S"), "metrics": metrics}
+    text = json.dumps(result, indent=2, sort_keys=True)
+    print(text)
+    if args.out:
+        with open(args.out, "w") as f:
+            f.write(text + "\n")
+    if args.baseline:
+        with open(args.baseline) as f:
+            bad = compare(metrics, json.load(f)["metrics"], args.tolerance)
+        for b in bad:
+            log("[BENCH] REGRESSION " + b)
+        return 1 if bad else 0
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,99 @@
+// bench_hex_decode.c — Micro-benchmark: awg_hex_decode_frame() vs. the
+// scalar parser awg_send_hex4() used before (parse_hex_n, one branch per nibble).
+// No hardware access; checks that both produce the same 33 words.
+//
+// Build / run (on the board or the host):
+//   make -f Makefile.onboard bench_hex && ./bench_hex_decode [iterations]
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "awg_hex_decode.h"
+
+#define N_FRAMES 64      // distinct random frames, cycled
+
+// ---- Reference: the former awg_core_mmap.c scalar path ----
+static inline uint32_t parse_hex_n(const char *p, int n) {
+    uint32_t v = 0;
+    for (int i = 0; i < n; i++) {
+        unsigned char c = (unsigned char)p[i];
+        unsigned int h = (c <= '9') ? (c - '0') : ((c | 32) - 'a' + 10);
+        v = (v << 4) | h;
+    }
+    return v;
+}
+
+static void scalar_decode(const char *f, uint32_t out[AWG_HEX_FRAME_WORDS]) {
+    int k = 0;
+    for (int ch = 0; ch < 2; ++ch) {
+        const char *idx  = f + ch * (AWG_HEX_IDX_LEN + AWG_HEX_GAIN_LEN);
+        const char *gain = idx + AWG_HEX_IDX_LEN;
+        uint32_t sel = (uint32_t)ch << 27;
+        for (int t = 0; t < 8; ++t)
+            out[k++] = (0x1u << 28) | sel | ((uint32_t)t << 24) | (parse_hex_n(idx + 3 * t, 3) & 0xFFFFFu);
+        for (int t = 0; t < 8; ++t)
+            out[k++] = (0x2u << 28) | sel | ((uint32_t)t << 24) | (parse_hex_n(gain + 18 * t + 13, 5) & 0xFFFFFu);
+    }
+    out[k] = 0xFu << 28;
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+int main(int argc, char **argv) {
+    long iters = (argc >= 2) ? atol(argv[1]) : 1000000;
+    static const char digits[] = "0123456789abcdefABCDEF";
+    static char frames[N_FRAMES][AWG_HEX_FRAME_LEN];
+
+    srand(1);
+    for (int i = 0; i < N_FRAMES; ++i)
+        for (int j = 0; j < AWG_HEX_FRAME_LEN; ++j)
+            frames[i][j] = digits[rand() % 22];
+
+    // Correctness: identical words, and every invalid position is caught
+    uint32_t a[AWG_HEX_FRAME_WORDS], b[AWG_HEX_FRAME_WORDS];
+    for (int i = 0; i < N_FRAMES; ++i) {
+        scalar_decode(frames[i], a);
+        if (awg_hex_decode_frame(frames[i], b) != 0 || memcmp(a, b, sizeof(a)) != 0) {
+            printf("MISMATCH on frame %d\n", i);
+            return 1;
+        }
+    }
+    static const char bad_chars[] = "gG /:@`\xb0\xc1\xff";
+    for (int pos = 0; pos < AWG_HEX_FRAME_LEN; ++pos) {
+        for (const char *c = bad_chars; *c; ++c) {
+            char f[AWG_HEX_FRAME_LEN];
+            memcpy(f, frames[0], sizeof(f));
+            f[pos] = *c;
+            if (awg_hex_decode_frame(f, b) != -1) {
+                printf("VALIDATION MISSED char 0x%02X at %d\n", (unsigned char)*c, pos);
+                return 1;
+            }
+        }
+    }
+
+    volatile uint32_t sink = 0;
+    uint64_t t0 = now_ns();
+    for (long i = 0; i < iters; ++i) {
+        scalar_decode(frames[i % N_FRAMES], a);
+        sink ^= a[i % AWG_HEX_FRAME_WORDS];
+    }
+    uint64_t t1 = now_ns();
+    for (long i = 0; i < iters; ++i) {
+        awg_hex_decode_frame(frames[i % N_FRAMES], b);
+        sink ^= b[i % AWG_HEX_FRAME_WORDS];
+    }
+    uint64_t t2 = now_ns();
+
+    double ns_scalar = (double)(t1 - t0) / (double)iters;
+    double ns_new    = (double)(t2 - t1) / (double)iters;
+    printf("[BENCH] %ld frames: scalar %.1f ns/frame (no validation), %s %.1f ns/frame (validated), x%.2f\n",
+           iters, ns_scalar, awg_hex_decode_impl(), ns_new, ns_scalar / ns_new);
+    return 0;
+}
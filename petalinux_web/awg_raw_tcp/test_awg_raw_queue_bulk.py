@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+Bulk 'M' PUSH round trip on the sim backend.
+- Spawns a sim server with AWG_SIM_LOG, so every word the player writes is logged.
+- Pushes one list of variable-size frames in a single 'M' command, sent in
+  small pieces so the body is parsed across many reactor wakeups, then E.
+- Plays it once and checks the logged frames word for word against what
+  was pushed.
+
+Usage (8-tone build):
+  make -f Makefile.onboard && python3 test_awg_raw_queue_bulk.py ./awg_server
+"""
+
+import os
+import signal
+import socket
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+
+# ---------- Connection settings ----------
+HOST = "127.0.0.1"
+CONTROL_PORT = 9100
+TONES = 8
+LIST_ID = 0
+NFRAMES = 50
+CHUNK = 97          # bytes per send; not a multiple of any field size
+
+# --- Protocol and Frame Generation Helpers ---
+def pack_word(cmd: int, ch: int, tone: int, data20: int) -> int: return ((cmd & 0xF) << 28) | ((ch & 1) << 27) | ((tone & 0x7) << 24) | (data20 & 0xFFFFF)
+def make_index_word(ch: int, tone: int, idx20: int) -> int: return pack_word(0x1, ch, tone, idx20)
+def make_gain_word(ch: int, tone: int, g20: int) -> int: return pack_word(0x2, ch, tone, g20)
+def make_commit_word() -> int: return (0xF << 28)
+
+def op_B_begin(list_id: int, total_frames: int) -> bytes: return b'B' + struct.pack(">BI", list_id, total_frames)
+def op_R_repeat(list_id: int, repeat: int) -> bytes: return b'R' + struct.pack(">BI", list_id, repeat)
+def op_E_end(list_id: int) -> bytes: return b'E' + struct.pack(">B", list_id)
+def op_M_bulk(list_id: int, frames) -> bytes:
+    counts = b''.join(struct.pack(">H", len(w)) for w in frames)
+    words  = b''.join(struct.pack(">I", x) for w in frames for x in w)
+    return b'M' + struct.pack(">BI", list_id, len(frames)) + counts + words
+
+def make_frame(i: int):
+    """1..TONES tones on both channels, values unique per frame."""
+    n = i % TONES + 1
+    w = []
+    for t in range(n):
+        for ch in (0, 1):
+            w.append(make_index_word(ch, t, 0x1000 + i * 16 + t))
+            w.append(make_gain_word(ch, t, 0x8000 + i))
+    return w + [make_commit_word()]
+
+# --- Sim server ---
+def start_server(binary: str, log_path: str):
+    env = dict(os.environ, AWG_CORE_BACKEND="sim", AWG_RT_MLOCK="0", AWG_SIM_LOG=log_path)
+    proc = subprocess.Popen([binary], env=env, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    deadline = time.time() + 5
+    while time.time() < deadline:
+        try:
+            return proc, socket.create_connection((HOST, CONTROL_PORT), timeout=1.0)
+        except OSError:
+            time.sleep(0.05)
+    proc.kill()
+    raise RuntimeError("server did not come up")
+
+def stop_server(proc: subprocess.Popen):
+    if proc.poll() is None:
+        proc.send_signal(signal.SIGINT)
+        proc.wait(timeout=10)
+
+def read_frames(log_path: str):
+    """Logged words (complete once the server has exited), split after every COMMIT."""
+    with open(log_path) as f:
+        words = [int(line, 16) for line in f if line.strip()]
+    frames, cur = [], []
+    for w in words:
+        cur.append(w)
+        if (w >> 28) == 0xF:
+            frames.append(cur)
+            cur = []
+    return frames
+
+# --- Main logic ---
+def main():
+    if len(sys.argv) != 2:
+        print(__doc__)
+        return 2
+    fd, log_path = tempfile.mkstemp(prefix="awg_sim_", suffix=".log")
+    os.close(fd)
+    proc, s = start_server(sys.argv[1], log_path)
+    failures = 0
+    try:
+        s.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        pushed = [make_frame(i) for i in range(NFRAMES)]
+        body = op_M_bulk(LIST_ID, pushed)
+        s.sendall(op_B_begin(LIST_ID, NFRAMES))
+        for off in range(0, len(body), CHUNK):
+            s.sendall(body[off:off + CHUNK])
+            time.sleep(0.001)
+        s.sendall(op_R_repeat(LIST_ID, 1) + op_E_end(LIST_ID))
+        time.sleep(0.5)                       # 50 frames at the default 1 ms period
+        stop_server(proc)
+
+        # The list starts at its first frame; skip whatever the startup wrote
+        frames = read_frames(log_path)
+        start = next((i for i, f in enumerate(frames) if f == pushed[0]), len(frames))
+        played = frames[start:start + NFRAMES]
+        if len(played) != NFRAMES:
+            print(f"[FAIL] {len(played)} frames played, expected {NFRAMES}")
+            failures += 1
+        bad = [i for i, (got, want) in enumerate(zip(played, pushed)) if got != want]
+        for i in bad[:5]:
+            print(f"[FAIL] frame {i}: {len(played[i])} words logged, {len(pushed[i])} pushed")
+        failures += len(bad)
+        if not bad and len(played) == NFRAMES:
+            words = sum(len(f) for f in pushed)
+            print(f"[OK] {NFRAMES} frames ({words} words, {len(body)} body bytes in {CHUNK}-byte pieces) played as pushed")
+    finally:
+        s.close()
+        stop_server(proc)
+        os.unlink(log_path)
+    print("[CLIENT] PASS" if not failures else f"[CLIENT] {failures} check(s) failed")
+    return 1 if failures else 0
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+Mixed delta/raw list check on the sim backend.
+- Spawns a sim server with AWG_SIM_LOG, so every word the player writes is logged.
+- Loads one list of 'D' frames with a raw 'M' frame in the middle, plays it once.
+- Checks frame by frame: the two 'D' frames after the raw one are written in
+  full (the raw frame left the PL banks out of step with the delta mirror),
+  then the list goes back to sending only the changed slots.
+
+Usage (8-tone build):
+  make -f Makefile.onboard && python3 test_awg_raw_queue_delta.py ./awg_server
+"""
+
+import os
+import signal
+import socket
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+
+# ---------- Connection settings ----------
+HOST = "127.0.0.1"
+CONTROL_PORT = 9100
+TONES = 8
+LIST_ID = 0
+
+# --- Protocol and Frame Generation Helpers ---
+def pack_word(cmd: int, ch: int, tone: int, data20: int) -> int: return ((cmd & 0xF) << 28) | ((ch & 1) << 27) | ((tone & 0x7) << 24) | (data20 & 0xFFFFF)
+def make_index_word(ch: int, tone: int, idx20: int) -> int: return pack_word(0x1, ch, tone, idx20)
+def make_gain_word(ch: int, tone: int, g20: int) -> int: return pack_word(0x2, ch, tone, g20)
+def make_commit_word() -> int: return (0xF << 28)
+FULL = 2 * 2 * TONES + 1
+
+def op_B_begin(list_id: int, total_frames: int) -> bytes: return b'B' + struct.pack(">BI", list_id, total_frames)
+def op_R_repeat(list_id: int, repeat: int) -> bytes: return b'R' + struct.pack(">BI", list_id, repeat)
+def op_E_end(list_id: int) -> bytes: return b'E' + struct.pack(">B", list_id)
+
+def op_M_bulk(list_id: int, frames) -> bytes:
+    counts = b''.join(struct.pack(">H", len(w)) for w in frames)
+    words  = b''.join(struct.pack(">I", x) for w in frames for x in w)
+    return b'M' + struct.pack(">BI", list_id, len(frames)) + counts + words
+
+def op_D_delta(list_id: int, frames) -> bytes:
+    """frames: (idx {slot: value}, gain {slot: value}), slot = ch*8 + tone."""
+    out = [b'D' + struct.pack(">BI", list_id, len(frames))]
+    for idx, gain in frames:
+        im = sum(1 << t for t in idx)
+        gm = sum(1 << t for t in gain)
+        out.append(struct.pack(">HH", im, gm))
+        out += [struct.pack(">I", idx[t]) for t in sorted(idx)]
+        out += [struct.pack(">I", gain[t]) for t in sorted(gain)]
+    return b''.join(out)
+
+# --- Sim server ---
+def start_server(binary: str, log_path: str):
+    env = dict(os.environ, AWG_CORE_BACKEND="sim", AWG_RT_MLOCK="0", AWG_SIM_LOG=log_path)
+    proc = subprocess.Popen([binary], env=env, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    deadline = time.time() + 5
+    while time.time() < deadline:
+        try:
+            return proc, socket.create_connection((HOST, CONTROL_PORT), timeout=1.0)
+        except OSError:
+            time.sleep(0.05)
+    proc.kill()
+    raise RuntimeError("server did not come up")
+
+def stop_server(proc: subprocess.Popen):
+    if proc.poll() is None:
+        proc.send_signal(signal.SIGINT)
+        proc.wait(timeout=10)
+
+def read_frames(log_path: str):
+    """Logged words (complete once the server has exited), split after every COMMIT."""
+    with open(log_path) as f:
+        words = [int(line, 16) for line in f if line.strip()]
+    frames, cur = [], []
+    for w in words:
+        cur.append(w)
+        if (w >> 28) == 0xF:
+            frames.append(cur)
+            cur = []
+    return frames
+
+# --- Main logic ---
+def main():
+    if len(sys.argv) != 2:
+        print(__doc__)
+        return 2
+    fd, log_path = tempfile.mkstemp(prefix="awg_sim_", suffix=".log")
+    os.close(fd)
+    proc, s = start_server(sys.argv[1], log_path)
+    failures = 0
+    try:
+        s.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        every = {t: 0x100 + t for t in range(2 * TONES)}
+        raw = [make_index_word(0, 0, 0x3FF), make_commit_word()]
+        # (description, expected word count) per played frame
+        expect = [("D first frame, full", FULL),
+                  ("D second frame, full", FULL),
+                  ("D slot 1 changed: slots 0 (previous) and 1", 3),
+                  ("M raw frame", 2),
+                  ("D after M, full", FULL),
+                  ("D after M, full", FULL),
+                  ("D nothing changed: COMMIT only", 1)]
+        msg = (op_B_begin(LIST_ID, len(expect))
+               + op_D_delta(LIST_ID, [(every, every), ({0: 0x200}, {}), ({1: 0x201}, {})])
+               + op_M_bulk(LIST_ID, [raw])
+               + op_D_delta(LIST_ID, [({2: 0x202}, {}), ({}, {}), ({}, {})])
+               + op_R_repeat(LIST_ID, 1))
+        s.sendall(msg + op_E_end(LIST_ID))
+        time.sleep(0.5)                       # 7 frames at the default 1 ms period
+        stop_server(proc)
+
+        # The list starts at its first frame; skip whatever the startup wrote
+        frames = read_frames(log_path)
+        first = make_index_word(0, 0, every[0])
+        start = next((i for i, f in enumerate(frames) if first in f), len(frames))
+        played = frames[start:start + len(expect)]
+        if len(played) != len(expect):
+            print(f"[FAIL] {len(played)} frames played, expected {len(expect)}")
+            failures += 1
+        for i, (frame, (what, n)) in enumerate(zip(played, expect)):
+            ok = len(frame) == n
+            failures += not ok
+            print(f"[{'OK' if ok else 'FAIL'}] frame {i}: {what}: {len(frame)} words (expected {n})")
+        # The full write after M puts the mirror's slot 0 back over the raw 0x3FF
+        if len(played) > 4:
+            ok = make_index_word(0, 0, 0x200) in played[4]
+            failures += not ok
+            print(f"[{'OK' if ok else 'FAIL'}] frame 4 restores INDEX slot 0 = 0x200")
+    finally:
+        s.close()
+        stop_server(proc)
+        os.unlink(log_path)
+    print("[CLIENT] PASS" if not failures else f"[CLIENT] {failures} check(s) failed")
+    return 1 if failures else 0
+
+if __name__ == "__main__":
+    sys.exit(main())
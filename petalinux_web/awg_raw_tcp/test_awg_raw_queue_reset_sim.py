@@ -0,0 +1,151 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+RESET ('Z') on the sim backend, for AWG_RESET=fast and AWG_RESET=flush.
+- Spawns a sim server with AWG_SIM_LOG and loads a looping list.
+- Sends 'Z' with a 'G' pipelined behind: the status must show every list
+  IDLE, i.e. the 'G' waited for the reset to finish.
+- An observer's 'G' sent while the reset runs is answered as well.
+- After the server has exited, checks that the PL got a zero frame and
+  that the looping list was not played again after it.
+
+Usage (8-tone build):
+  make -f Makefile.onboard && python3 test_awg_raw_queue_reset_sim.py ./awg_server
+"""
+
+import os
+import signal
+import socket
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+
+# ---------- Connection settings ----------
+HOST = "127.0.0.1"
+CONTROL_PORT = 9100
+NFRAMES = 20
+LIST_IDLE = 0
+
+# --- Protocol and Frame Generation Helpers ---
+def pack_word(cmd: int, ch: int, tone: int, data20: int) -> int: return ((cmd & 0xF) << 28) | ((ch & 1) << 27) | ((tone & 0x7) << 24) | (data20 & 0xFFFFF)
+def make_index_word(ch: int, tone: int, idx20: int) -> int: return pack_word(0x1, ch, tone, idx20)
+def make_gain_word(ch: int, tone: int, g20: int) -> int: return pack_word(0x2, ch, tone, g20)
+def make_commit_word() -> int: return (0xF << 28)
+
+def op_B_begin(list_id: int, total_frames: int) -> bytes: return b'B' + struct.pack(">BI", list_id, total_frames)
+def op_R_repeat(list_id: int, repeat: int) -> bytes: return b'R' + struct.pack(">BI", list_id, repeat)
+def op_E_end(list_id: int) -> bytes: return b'E' + struct.pack(">B", list_id)
+def op_M_bulk(list_id: int, frames) -> bytes:
+    counts = b''.join(struct.pack(">H", len(w)) for w in frames)
+    words  = b''.join(struct.pack(">I", x) for w in frames for x in w)
+    return b'M' + struct.pack(">BI", list_id, len(frames)) + counts + words
+
+def make_frame(i: int):
+    return [make_index_word(0, 0, 0x3000 + i), make_gain_word(0, 0, 0xA000 + i), make_commit_word()]
+
+def is_zero_frame(f) -> bool:
+    gains = [w for w in f if (w >> 28) == 0x2]
+    return len(gains) > 0 and all((w & 0xFFFFF) == 0 for w in gains)
+
+def recv_exact(s: socket.socket, n: int) -> bytes:
+    b = b''
+    while len(b) < n:
+        chunk = s.recv(n - len(b))
+        if not chunk:
+            raise ConnectionError("server closed the connection")
+        b += chunk
+    return b
+
+def read_status(s: socket.socket):
+    """'G' reply: list states."""
+    hdr = recv_exact(s, 11)
+    if hdr[:4] != b"AWGS":
+        raise ValueError(f"bad status magic {hdr[:4]!r}")
+    n = hdr[4]
+    body = recv_exact(s, 17 * n)
+    return [body[17 * i] for i in range(n)]
+
+# --- Sim server ---
+def start_server(binary: str, log_path: str, mode: str):
+    env = dict(os.environ, AWG_CORE_BACKEND="sim", AWG_RT_MLOCK="0",
+               AWG_SIM_LOG=log_path, AWG_RESET=mode)
+    proc = subprocess.Popen([binary], env=env, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    deadline = time.time() + 5
+    while time.time() < deadline:
+        try:
+            return proc, socket.create_connection((HOST, CONTROL_PORT), timeout=5.0)
+        except OSError:
+            time.sleep(0.05)
+    proc.kill()
+    raise RuntimeError("server did not come up")
+
+def stop_server(proc: subprocess.Popen):
+    if proc.poll() is None:
+        proc.send_signal(signal.SIGINT)
+        proc.wait(timeout=10)
+
+def read_frames(log_path: str):
+    """Logged words (complete once the server has exited), split after every COMMIT."""
+    with open(log_path) as f:
+        words = [int(line, 16) for line in f if line.strip()]
+    frames, cur = [], []
+    for w in words:
+        cur.append(w)
+        if (w >> 28) == 0xF:
+            frames.append(cur)
+            cur = []
+    return frames
+
+def run(binary: str, mode: str) -> int:
+    fd, log_path = tempfile.mkstemp(prefix="awg_sim_", suffix=".log")
+    os.close(fd)
+    proc, s = start_server(binary, log_path, mode)
+    failures = 0
+
+    def check(cond, what):
+        nonlocal failures
+        print(("[OK] " if cond else "[FAIL] ") + f"{mode}: " + what)
+        failures += 0 if cond else 1
+
+    try:
+        s.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        pushed = [make_frame(i) for i in range(NFRAMES)]
+        s.sendall(op_B_begin(0, NFRAMES) + op_M_bulk(0, pushed) + op_R_repeat(0, 0) + op_E_end(0))
+        time.sleep(0.1)                       # looping now
+
+        obs = socket.create_connection((HOST, CONTROL_PORT), timeout=5.0)
+        s.sendall(b'Z' + b'G')
+        obs.sendall(b'C\x02' + b'G')
+        recv_exact(obs, 1)
+        check(len(read_status(obs)) >= 2, "observer answered while the reset runs")
+        obs.close()
+        states = read_status(s)
+        check(all(st == LIST_IDLE for st in states), f"'G' behind 'Z' sees every list IDLE ({states})")
+        time.sleep(0.2)
+        stop_server(proc)
+
+        frames = read_frames(log_path)
+        played = [i for i, f in enumerate(frames) if f in pushed]
+        zero = next((i for i, f in enumerate(frames) if played and i > played[0] and is_zero_frame(f)), None)
+        check(zero is not None, "zero frame written after the list started")
+        if zero is not None:
+            check(all(i < zero for i in played), "looping list stopped by the reset")
+    finally:
+        s.close()
+        stop_server(proc)
+        os.unlink(log_path)
+    return failures
+
+# --- Main logic ---
+def main():
+    if len(sys.argv) != 2:
+        print(__doc__)
+        return 2
+    failures = sum(run(sys.argv[1], mode) for mode in ("fast", "flush"))
+    print("[CLIENT] PASS" if not failures else f"[CLIENT] {failures} check(s) failed")
+    return 1 if failures else 0
+
+if __name__ == "__main__":
+    sys.exit(main())
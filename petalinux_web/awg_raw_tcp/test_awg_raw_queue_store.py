@@ -0,0 +1,188 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+STORE/LOAD round trip on the sim backend.
+- Spawns a sim server with AWG_SIM_LOG and a temporary AWG_LIST_DIR.
+- Loads list 0 with one 'M' command and plays it once.
+- STOREs it with a 'G' pipelined behind: the status byte must arrive first.
+- A bad name is answered with status 1, the session stays up.
+- 'l' lists the stored file; an observer that never reads its replies
+  does not hold up the owner's next reply.
+- LOADs the file into list 1 and checks that it plays the same frames
+  word for word.
+
+Usage (8-tone build):
+  make -f Makefile.onboard && python3 test_awg_raw_queue_store.py ./awg_server
+"""
+
+import os
+import shutil
+import signal
+import socket
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+
+# ---------- Connection settings ----------
+HOST = "127.0.0.1"
+CONTROL_PORT = 9100
+TONES = 8
+NFRAMES = 40
+NAME = b"store_test"
+
+# --- Protocol and Frame Generation Helpers ---
+def pack_word(cmd: int, ch: int, tone: int, data20: int) -> int: return ((cmd & 0xF) << 28) | ((ch & 1) << 27) | ((tone & 0x7) << 24) | (data20 & 0xFFFFF)
+def make_index_word(ch: int, tone: int, idx20: int) -> int: return pack_word(0x1, ch, tone, idx20)
+def make_gain_word(ch: int, tone: int, g20: int) -> int: return pack_word(0x2, ch, tone, g20)
+def make_commit_word() -> int: return (0xF << 28)
+
+def op_B_begin(list_id: int, total_frames: int) -> bytes: return b'B' + struct.pack(">BI", list_id, total_frames)
+def op_E_end(list_id: int) -> bytes: return b'E' + struct.pack(">B", list_id)
+def op_M_bulk(list_id: int, frames) -> bytes:
+    counts = b''.join(struct.pack(">H", len(w)) for w in frames)
+    words  = b''.join(struct.pack(">I", x) for w in frames for x in w)
+    return b'M' + struct.pack(">BI", list_id, len(frames)) + counts + words
+def op_S_store(list_id: int, name: bytes) -> bytes: return b'S' + struct.pack(">BB", list_id, len(name)) + name
+def op_L_load(list_id: int, name: bytes) -> bytes: return b'L' + struct.pack(">BB", list_id, len(name)) + name
+
+def make_frame(i: int):
+    """1..TONES tones on both channels, values unique per frame."""
+    n = i % TONES + 1
+    w = []
+    for t in range(n):
+        for ch in (0, 1):
+            w.append(make_index_word(ch, t, 0x2000 + i * 16 + t))
+            w.append(make_gain_word(ch, t, 0x9000 + i))
+    return w + [make_commit_word()]
+
+def recv_exact(s: socket.socket, n: int) -> bytes:
+    b = b''
+    while len(b) < n:
+        chunk = s.recv(n - len(b))
+        if not chunk:
+            raise ConnectionError("server closed the connection")
+        b += chunk
+    return b
+
+def read_library(s: socket.socket):
+    """'l' reply: {name: frames}."""
+    hdr = recv_exact(s, 8)
+    if hdr[:4] != b"AWGD":
+        raise ValueError(f"bad library magic {hdr[:4]!r}")
+    count = struct.unpack(">H", hdr[6:8])[0]
+    lib = {}
+    for _ in range(count):
+        n = recv_exact(s, 1)[0]
+        name = recv_exact(s, n).decode()
+        frames, _words, _period = struct.unpack(">III", recv_exact(s, 12))
+        lib[name] = frames
+    return lib
+
+def read_status(s: socket.socket):
+    """'G' reply: list states."""
+    hdr = recv_exact(s, 11)
+    if hdr[:4] != b"AWGS":
+        raise ValueError(f"bad status magic {hdr[:4]!r}")
+    n = hdr[4]
+    body = recv_exact(s, 17 * n)
+    return [body[17 * i] for i in range(n)]
+
+# --- Sim server ---
+def start_server(binary: str, log_path: str, list_dir: str):
+    env = dict(os.environ, AWG_CORE_BACKEND="sim", AWG_RT_MLOCK="0",
+               AWG_SIM_LOG=log_path, AWG_LIST_DIR=list_dir)
+    proc = subprocess.Popen([binary], env=env, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    deadline = time.time() + 5
+    while time.time() < deadline:
+        try:
+            return proc, socket.create_connection((HOST, CONTROL_PORT), timeout=5.0)
+        except OSError:
+            time.sleep(0.05)
+    proc.kill()
+    raise RuntimeError("server did not come up")
+
+def stop_server(proc: subprocess.Popen):
+    if proc.poll() is None:
+        proc.send_signal(signal.SIGINT)
+        proc.wait(timeout=10)
+
+def read_frames(log_path: str):
+    """Logged words (complete once the server has exited), split after every COMMIT."""
+    with open(log_path) as f:
+        words = [int(line, 16) for line in f if line.strip()]
+    frames, cur = [], []
+    for w in words:
+        cur.append(w)
+        if (w >> 28) == 0xF:
+            frames.append(cur)
+            cur = []
+    return frames
+
+# --- Main logic ---
+def main():
+    if len(sys.argv) != 2:
+        print(__doc__)
+        return 2
+    fd, log_path = tempfile.mkstemp(prefix="awg_sim_", suffix=".log")
+    os.close(fd)
+    list_dir = tempfile.mkdtemp(prefix="awg_lists_")
+    proc, s = start_server(sys.argv[1], log_path, list_dir)
+    failures = 0
+
+    def check(cond, what):
+        nonlocal failures
+        print(("[OK] " if cond else "[FAIL] ") + what)
+        failures += 0 if cond else 1
+
+    try:
+        s.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        pushed = [make_frame(i) for i in range(NFRAMES)]
+        s.sendall(op_B_begin(0, NFRAMES) + op_M_bulk(0, pushed) + op_E_end(0))
+        time.sleep(0.3)                       # 40 frames at the default 1 ms period
+
+        s.sendall(op_S_store(0, NAME) + b'G')
+        st = recv_exact(s, 1)[0]
+        check(st == 0, f"STORE status {st}, expected 0")
+        check(len(read_status(s)) >= 2, "'G' pipelined behind STORE answered after it")
+        check(os.path.exists(os.path.join(list_dir, NAME.decode() + ".awgl")), "list file written")
+
+        s.sendall(op_S_store(0, b"bad/name"))
+        st = recv_exact(s, 1)[0]
+        check(st == 1, f"STORE with a bad name: status {st}, expected 1")
+
+        s.sendall(b'l')
+        lib = read_library(s)
+        check(lib.get(NAME.decode()) == NFRAMES, f"'l' lists {NAME.decode()} with {NFRAMES} frames")
+
+        slow = socket.create_connection((HOST, CONTROL_PORT), timeout=5.0)
+        slow.sendall(b'C\x02' + b'Q\x00' * 3000)   # observer that never reads
+        time.sleep(0.2)
+        t0 = time.time()
+        s.sendall(b'G')
+        read_status(s)
+        check(time.time() - t0 < 0.5, "owner answered while an observer does not read its replies")
+        slow.close()
+
+        s.sendall(op_L_load(1, NAME) + b'G')
+        read_status(s)                        # LOAD is done once this arrives
+        time.sleep(0.3)
+        stop_server(proc)
+
+        frames = read_frames(log_path)
+        starts = [i for i, f in enumerate(frames) if f == pushed[0]]
+        check(len(starts) >= 2, f"list played {len(starts)} time(s), expected 2 (pushed + LOADed)")
+        if len(starts) >= 2:
+            played = frames[starts[1]:starts[1] + NFRAMES]
+            check(played == pushed, f"LOADed list plays its {NFRAMES} frames as pushed")
+    finally:
+        s.close()
+        stop_server(proc)
+        os.unlink(log_path)
+        shutil.rmtree(list_dir, ignore_errors=True)
+    print("[CLIENT] PASS" if not failures else f"[CLIENT] {failures} check(s) failed")
+    return 1 if failures else 0
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -2,7 +2,11 @@
 import os, socket, ctypes, signal
 
 HOST, PORT = "0.0.0.0", 8766           # 換成你要的 UDP 監聽埠
-LIB_PATH   = os.path.join(os.path.dirname(__file__), "libawg_core_mmap.so")
+# Shared core built in awg_raw_tcp (make -f Makefile.onboard lib); backend via AWG_CORE_BACKEND
+LIB_PATH = os.environ.get("AWG_CORE_LIB") or next(
+    (p for p in (os.path.join(os.path.dirname(__file__), "libawg_core.so"),
+                 "/home/petalinux/libawg_core.so") if os.path.exists(p)),
+    "libawg_core.so")
 
 # 載入 C 函式庫
 lib = ctypes.CDLL(LIB_PATH)
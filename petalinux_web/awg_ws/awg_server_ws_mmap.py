@@ -10,7 +10,11 @@ except Exception:
     pass
 
 WS_HOST, WS_PORT, WS_PATH = "0.0.0.0", 8765, "/ws"
-LIB_PATH = os.path.join(os.path.dirname(__file__), "libawg_core_mmap.so")
+# Shared core built in awg_raw_tcp (make -f Makefile.onboard lib); backend via AWG_CORE_BACKEND
+LIB_PATH = os.environ.get("AWG_CORE_LIB") or next(
+    (p for p in (os.path.join(os.path.dirname(__file__), "libawg_core.so"),
+                 "/home/petalinux/libawg_core.so") if os.path.exists(p)),
+    "libawg_core.so")
 
 lib = ctypes.CDLL(LIB_PATH)
 lib.awg_init.restype = ctypes.c_int
@@ -0,0 +1,74 @@
+`timescale 1ns/1ps
+// -----------------------------------------------------------------------------
+// axis_cmd_frame_pacer
+// - Sits between AXI DMA M_AXIS_MM2S and waveform_generator_v5 S_AXIS
+// - INDEX/GAIN/SAFE words pass straight through (1 word/clk, no buffering)
+// - A COMMIT word is held (s_axis_tready=0) until period_cycles clocks have
+//   elapsed since the previous COMMIT left, so the DMA can prefetch the next
+//   frame into the shadow bank while the current one plays
+// - The first COMMIT after reset goes out immediately
+// - period_cycles = 0 or 1 disables pacing (pure pass-through)
+// - period_cycles is expected from an AXI GPIO in the same clock domain;
+//   it is registered here and may change between frames
+// - Command word format: see gpio_cfg_decoder_axis32 (CMD[31:28], F=COMMIT)
+// -----------------------------------------------------------------------------
+module axis_cmd_frame_pacer #(
+    parameter integer CNT_W = 32
+)(
+    input  wire              clk,
+    input  wire              rst_n,
+
+    // Frame period in clk cycles (COMMIT to COMMIT)
+    input  wire [CNT_W-1:0]  period_cycles,
+
+    // S_AXIS from AXI DMA (MM2S)
+    input  wire [31:0]       s_axis_tdata,
+    input  wire              s_axis_tvalid,
+    output wire              s_axis_tready,
+    input  wire              s_axis_tlast,    // end of DMA transfer (ignored)
+
+    // M_AXIS to waveform_generator_v5
+    output wire [31:0]       m_axis_tdata,
+    output wire              m_axis_tvalid,
+    input  wire              m_axis_tready,
+
+    // Status
+    output reg  [31:0]       commit_cnt,      // COMMITs emitted since reset
+    output wire              commit_pulse     // 1-cycle pulse per emitted COMMIT
+);
+    localparam [3:0] CMD_COMMIT = 4'hF;
+
+    reg [CNT_W-1:0] period_r;
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) period_r <= {CNT_W{1'b0}};
+        else        period_r <= period_cycles;
+    end
+
+    // Cycles since the last emitted COMMIT (saturating)
+    reg [CNT_W-1:0] elapsed;
+    reg             primed;     // 0 until the first COMMIT has gone out
+
+    wire is_commit   = (s_axis_tdata[31:28] == CMD_COMMIT);
+    wire period_done = !primed || (elapsed >= period_r);
+    wire hold        = s_axis_tvalid && is_commit && !period_done;
+
+    assign m_axis_tdata  = s_axis_tdata;
+    assign m_axis_tvalid = s_axis_tvalid && !hold;
+    assign s_axis_tready = m_axis_tready && !hold;
+
+    assign commit_pulse  = s_axis_tvalid && s_axis_tready && is_commit;
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            elapsed    <= {CNT_W{1'b0}};
+            primed     <= 1'b0;
+            commit_cnt <= 32'd0;
+        end else if (commit_pulse) begin
+            elapsed    <= {{(CNT_W-1){1'b0}},1'b1};
+            primed     <= 1'b1;
+            commit_cnt <= commit_cnt + 32'd1;
+        end else if (elapsed != {CNT_W{1'b1}}) begin
+            elapsed    <= elapsed + {{(CNT_W-1){1'b0}},1'b1};
+        end
+    end
+endmodule
@@ -0,0 +1,128 @@
+`timescale 1ns/1ps
+// -----------------------------------------------------------------------------
+// axis_commit_trigger_gate
+// - First stage of waveform_generator_v5: aligns the first COMMIT of a list
+//   on several boards to one shared trigger line (multi-board start)
+// - TRIG word (consumed here, not forwarded):
+//     [31:28] CMD    : B=TRIG
+//     [19:2]  TMO    : timeout in units of 2^TMO_SHIFT clk cycles, 0 = none
+//     [1]     LEAD   : this board drives trig_out when its COMMIT arrives
+//     [0]     ARM    : hold the next COMMIT until a trigger edge
+//   ARM=0 disarms (a no-op when not armed)
+// - While armed, INDEX/GAIN/SAFE words pass into the shadow bank and the next
+//   COMMIT is held (s_axis_tready=0) until a rising edge on trig_in (or the
+//   timeout expires), then forwarded and the gate disarms. An edge that
+//   arrives before the COMMIT releases it as soon as it gets here
+// - LEAD: when the held COMMIT arrives, trig_out pulses for PULSE_W cycles.
+//   The pulse goes through the same synchronizer as trig_in, so the leader
+//   releases on the same cycle as followers wired to its trig_out
+// - trig_in is asynchronous (board-to-board wire), synchronized here
+// - Status: trig_cnt counts COMMITs released by a trigger, miss_cnt those
+//   released by the timeout
+// -----------------------------------------------------------------------------
+module axis_commit_trigger_gate #(
+    parameter integer SYNC_STAGES = 2,
+    parameter integer PULSE_W     = 16,
+    parameter integer TMO_SHIFT   = 10
+)(
+    input  wire         clk,
+    input  wire         rst_n,
+
+    // Shared trigger line
+    input  wire         trig_in,
+    output wire         trig_out,
+
+    // S_AXIS command input
+    input  wire [31:0]  s_axis_tdata,
+    input  wire         s_axis_tvalid,
+    output wire         s_axis_tready,
+
+    // M_AXIS to the command decoder
+    output wire [31:0]  m_axis_tdata,
+    output wire         m_axis_tvalid,
+    input  wire         m_axis_tready,
+
+    // Status
+    output wire         armed_o,
+    output reg  [31:0]  trig_cnt,
+    output reg  [31:0]  miss_cnt
+);
+    localparam [3:0]   CMD_TRIG   = 4'hB;
+    localparam [3:0]   CMD_COMMIT = 4'hF;
+    localparam integer TMO_W      = 18 + TMO_SHIFT;
+    localparam integer PULSE_CW   = (PULSE_W > 1) ? $clog2(PULSE_W + 1) : 1;
+
+    wire [3:0] cmd       = s_axis_tdata[31:28];
+    wire       is_trig   = (cmd == CMD_TRIG);
+    wire       is_commit = (cmd == CMD_COMMIT);
+
+    reg                 armed;
+    reg                 lead;
+    reg                 fired;      // leader pulse already sent for this arm
+    reg                 tmo_en;
+    reg [TMO_W-1:0]     tmo_left;
+    reg [PULSE_CW-1:0]  pulse_left;
+
+    assign trig_out = (pulse_left != {PULSE_CW{1'b0}});
+    assign armed_o  = armed;
+
+    // Trigger synchronizer (trig_out folded in for the leader)
+    (* ASYNC_REG = "TRUE" *) reg [SYNC_STAGES-1:0] sync_r;
+    reg trig_q;
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            sync_r <= {SYNC_STAGES{1'b0}};
+            trig_q <= 1'b0;
+        end else begin
+            sync_r <= {sync_r[SYNC_STAGES-2:0], trig_in | (lead & trig_out)};
+            trig_q <= sync_r[SYNC_STAGES-1];
+        end
+    end
+    wire trig_rise = sync_r[SYNC_STAGES-1] && !trig_q;
+
+    wire hold      = armed && is_commit;
+    wire trig_take = s_axis_tvalid && is_trig;
+    wire tmo_hit   = tmo_en && (tmo_left == {TMO_W{1'b0}});
+
+    assign m_axis_tdata  = s_axis_tdata;
+    assign m_axis_tvalid = s_axis_tvalid && !is_trig && !hold;
+    assign s_axis_tready = is_trig ? 1'b1 : (m_axis_tready && !hold);
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            armed      <= 1'b0;
+            lead       <= 1'b0;
+            fired      <= 1'b0;
+            tmo_en     <= 1'b0;
+            tmo_left   <= {TMO_W{1'b0}};
+            pulse_left <= {PULSE_CW{1'b0}};
+            trig_cnt   <= 32'd0;
+            miss_cnt   <= 32'd0;
+        end else begin
+            if (pulse_left != {PULSE_CW{1'b0}})
+                pulse_left <= pulse_left - {{(PULSE_CW-1){1'b0}},1'b1};
+
+            if (trig_take) begin
+                armed    <= s_axis_tdata[0];
+                lead     <= s_axis_tdata[1];
+                fired    <= 1'b0;
+                tmo_en   <= (s_axis_tdata[19:2] != 18'd0);
+                tmo_left <= {s_axis_tdata[19:2], {TMO_SHIFT{1'b0}}};
+            end else if (armed) begin
+                if (lead && !fired && s_axis_tvalid && is_commit) begin
+                    fired      <= 1'b1;
+                    pulse_left <= PULSE_W[PULSE_CW-1:0];
+                end
+                if (trig_rise) begin
+                    armed    <= 1'b0;
+                    trig_cnt <= trig_cnt + 32'd1;
+                end else if (tmo_hit) begin
+                    armed    <= 1'b0;
+                    miss_cnt <= miss_cnt + 32'd1;
+                end else if (tmo_en) begin
+                    tmo_left <= tmo_left - {{(TMO_W-1){1'b0}},1'b1};
+                end
+            end
+        end
+    end
+endmodule
@@ -2,33 +2,36 @@
 // -----------------------------------------------------------------------------
 // cfg_pingpong_idx_gain_2x8
 // - Double-buffer config for A/B × 8 tones: {index, gain}
+// - [MODIFIED] TONES = 16 for the 16-tone build (the name keeps the default);
+//   wr_tone is 4 bits, the decoder never passes a tone >= TONES
 // - Always write to shadow bank; commit atomically switches active bank
 // -----------------------------------------------------------------------------
 module cfg_pingpong_idx_gain_2x8 #(
     parameter integer IDX_W  = 10,
-    parameter integer GAIN_W = 18
+    parameter integer GAIN_W = 18,
+    parameter integer TONES  = 8     // [NEW] tones per channel: 8 or 16
 )(
     input  wire                clk,
     input  wire                rst_n,
     input  wire                idx_we,       // pulse: write index
     input  wire                gain_we,      // pulse: write gain
     input  wire                wr_ch,        // 0:A, 1:B
-    input  wire [2:0]          wr_tone,      // 0..7
+    input  wire [3:0]          wr_tone,      // 0..TONES-1
     input  wire [IDX_W-1:0]    wr_index,
     input  wire [GAIN_W-1:0]   wr_gain,
     input  wire                commit_req,
     input  wire                commit_safe,
     output reg                 active_bank,
 
-    output wire [8*IDX_W -1:0] index_a_bus,
-    output wire [8*GAIN_W-1:0] gain_a_bus,
-    output wire [8*IDX_W -1:0] index_b_bus,
-    output wire [8*GAIN_W-1:0] gain_b_bus
+    output wire [TONES*IDX_W -1:0] index_a_bus,
+    output wire [TONES*GAIN_W-1:0] gain_a_bus,
+    output wire [TONES*IDX_W -1:0] index_b_bus,
+    output wire [TONES*GAIN_W-1:0] gain_b_bus
 );
-    reg [IDX_W -1:0] idx_a_0 [0:7], idx_a_1 [0:7];
-    reg [GAIN_W-1:0] gn_a_0  [0:7], gn_a_1  [0:7];
-    reg [IDX_W -1:0] idx_b_0 [0:7], idx_b_1 [0:7];
-    reg [GAIN_W-1:0] gn_b_0  [0:7], gn_b_1  [0:7];
+    reg [IDX_W -1:0] idx_a_0 [0:TONES-1], idx_a_1 [0:TONES-1];
+    reg [GAIN_W-1:0] gn_a_0  [0:TONES-1], gn_a_1  [0:TONES-1];
+    reg [IDX_W -1:0] idx_b_0 [0:TONES-1], idx_b_1 [0:TONES-1];
+    reg [GAIN_W-1:0] gn_b_0  [0:TONES-1], gn_b_1  [0:TONES-1];
 
     wire shadow_bank = ~active_bank;
 
@@ -39,7 +42,7 @@ module cfg_pingpong_idx_gain_2x8 #(
     always @(posedge clk or negedge rst_n) begin
         if (!rst_n) begin
             active_bank <= 1'b0;
-            for (i=0; i<8; i=i+1) begin
+            for (i=0; i<TONES; i=i+1) begin
                 idx_a_0[i] <= {IDX_W{1'b0}}; gn_a_0[i] <= {GAIN_W{1'b0}};
                 idx_b_0[i] <= {IDX_W{1'b0}}; gn_b_0[i] <= {GAIN_W{1'b0}};
                 idx_a_1[i] <= {IDX_W{1'b0}}; gn_a_1[i] <= {GAIN_W{1'b0}};
@@ -83,7 +86,7 @@ module cfg_pingpong_idx_gain_2x8 #(
 
     genvar t;
     generate
-        for (t=0; t<8; t=t+1) begin : PACK
+        for (t=0; t<TONES; t=t+1) begin : PACK
             assign index_a_bus[(t+1)*IDX_W -1 -: IDX_W] = (active_bank==1'b0) ? idx_a_0[t] : idx_a_1[t];
             assign gain_a_bus [(t+1)*GAIN_W-1 -: GAIN_W]= (active_bank==1'b0) ? gn_a_0 [t] : gn_a_1 [t];
             assign index_b_bus[(t+1)*IDX_W -1 -: IDX_W] = (active_bank==1'b0) ? idx_b_0[t] : idx_b_1[t];
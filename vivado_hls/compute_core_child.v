@@ -2,15 +2,17 @@
 // -----------------------------------------------------------------------------
 // compute_core_child.v  (Channel-A only)
 // - Pipeline (per-sample when downstream ready):
-//     index/gain cache -> phase accum -> LUT -> 8x Q-mul (AXIS) -> adder_tree8 (AXIS)
-// - Output: sum of 8 tones (Channel A), Q1.31 (DATA_WIDTH)
+//     index/gain cache -> phase accum -> LUT -> TONES x Q-mul (AXIS) -> adder tree (AXIS)
+// - [MODIFIED] TONES = 8 (adder_tree8_axis) or 16 (adder_tree16_axis)
+// - Output: sum of TONES tones (Channel A), Q1.31 (DATA_WIDTH)
 // - Handshake policy inside:
 //     * Local "can_load" gates phase advance and downstream loads
-//     * All 8 multipliers: s_axis_tvalid=advance, m_axis_tready=can_load
+//     * All multipliers: s_axis_tvalid=advance, m_axis_tready=can_load
 //     * Adder tree: s_axis_tvalid fires when all mul lanes valid AND can_load
 // -----------------------------------------------------------------------------
 module compute_core_child #(
     parameter integer DATA_WIDTH   = 32,   // Q1.31
+    parameter integer TONES        = 8,    // [NEW] tones per channel: 8 or 16
     parameter integer IDX_W        = 10,   // index width to phase_incr table
     parameter integer GAIN_W       = 18,   // e.g., Q1.17
     parameter integer PHASE_W      = 32,   // phase accumulator width
@@ -25,9 +27,9 @@ module compute_core_child #(
     input  wire                        clk,
     input  wire                        rst_n,
 
-    // Active configuration buses for Channel A (packed {tone7..tone0})
-    input  wire [8*IDX_W -1:0]         index_a_bus,
-    input  wire [8*GAIN_W-1:0]         gain_a_bus,
+    // Active configuration buses for Channel A (packed {toneN-1..tone0})
+    input  wire [TONES*IDX_W -1:0]     index_a_bus,
+    input  wire [TONES*GAIN_W-1:0]     gain_a_bus,
 
     // AXI-Stream out (sum of Channel A tones)
     output wire [DATA_WIDTH-1:0]       m_axis_tdata,
@@ -35,14 +37,14 @@ module compute_core_child #(
     input  wire                        m_axis_tready
 );
     // -------------------------
-    // Unpack indices & gains (Channel A, 8 tones)
+    // Unpack indices & gains (Channel A, TONES tones)
     // -------------------------
-    wire [IDX_W -1:0] idx_a_now  [0:7];
-    wire [GAIN_W-1:0] gain_a_now [0:7];
+    wire [IDX_W -1:0] idx_a_now  [0:TONES-1];
+    wire [GAIN_W-1:0] gain_a_now [0:TONES-1];
 
     genvar u;
     generate
-        for (u=0; u<8; u=u+1) begin : UNPACK_A
+        for (u=0; u<TONES; u=u+1) begin : UNPACK_A
             assign idx_a_now [u] = index_a_bus[(u+1)*IDX_W -1 -: IDX_W];
             assign gain_a_now[u] = gain_a_bus [(u+1)*GAIN_W-1 -: GAIN_W];
         end
@@ -63,18 +65,18 @@ module compute_core_child #(
         end
     end
 
-    reg [IDX_W-1:0]   last_idx_a [0:7];
-    reg [PHASE_W-1:0] dphi_a_reg [0:7];
+    reg [IDX_W-1:0]   last_idx_a [0:TONES-1];
+    reg [PHASE_W-1:0] dphi_a_reg [0:TONES-1];
 
     integer ca;
     always @(posedge clk or negedge rst_n) begin
         if (!rst_n) begin
-            for (ca=0; ca<8; ca=ca+1) begin
+            for (ca=0; ca<TONES; ca=ca+1) begin
                 last_idx_a[ca] <= {IDX_W{1'b0}};
                 dphi_a_reg[ca] <= {PHASE_W{1'b0}};
             end
         end else begin
-            for (ca=0; ca<8; ca=ca+1) begin
+            for (ca=0; ca<TONES; ca=ca+1) begin
                 if (idx_a_now[ca] != last_idx_a[ca]) begin
                     dphi_a_reg[ca] <= phase_incr_tbl[idx_a_now[ca]]; // capture once
                     last_idx_a[ca] <= idx_a_now[ca];
@@ -84,13 +86,13 @@ module compute_core_child #(
     end
 
     // Cache gains similarly (stable for multiplier inputs)
-    reg [GAIN_W-1:0] gain_a_reg [0:7];
+    reg [GAIN_W-1:0] gain_a_reg [0:TONES-1];
     integer cg;
     always @(posedge clk or negedge rst_n) begin
         if (!rst_n) begin
-            for (cg=0; cg<8; cg=cg+1) gain_a_reg[cg] <= {GAIN_W{1'b0}};
+            for (cg=0; cg<TONES; cg=cg+1) gain_a_reg[cg] <= {GAIN_W{1'b0}};
         end else begin
-            for (cg=0; cg<8; cg=cg+1)
+            for (cg=0; cg<TONES; cg=cg+1)
                 if (gain_a_now[cg] != gain_a_reg[cg]) gain_a_reg[cg] <= gain_a_now[cg];
         end
     end
@@ -109,13 +111,13 @@ module compute_core_child #(
     wire can_load = (~out_valid_r) || (out_valid_r && m_axis_tready);
     wire advance  = can_load;
 
-    reg [PHASE_W-1:0] pha_a [0:7];
+    reg [PHASE_W-1:0] pha_a [0:TONES-1];
     integer k;
     always @(posedge clk or negedge rst_n) begin
         if (!rst_n) begin
-            for (k=0; k<8; k=k+1) pha_a[k] <= {PHASE_W{1'b0}};
+            for (k=0; k<TONES; k=k+1) pha_a[k] <= {PHASE_W{1'b0}};
         end else if (advance) begin
-            for (k=0; k<8; k=k+1) pha_a[k] <= pha_a[k] + dphi_a_reg[k];
+            for (k=0; k<TONES; k=k+1) pha_a[k] <= pha_a[k] + dphi_a_reg[k];
         end
         // else: hold while back-pressured
     end
@@ -123,18 +125,18 @@ module compute_core_child #(
     // =========================================================================
     // 3) Sine LUT BRAMs (dual-read, sync) for Channel A
     // =========================================================================
-    wire [LUT_ADDR_W-1:0] lut_addr_a [0:7];
-    wire signed [31:0]    wav_a      [0:7];
+    wire [LUT_ADDR_W-1:0] lut_addr_a [0:TONES-1];
+    wire signed [31:0]    wav_a      [0:TONES-1];
 
     generate
-        for (u=0; u<8; u=u+1) begin : ADDR_A
+        for (u=0; u<TONES; u=u+1) begin : ADDR_A
             assign lut_addr_a[u] = pha_a[u][PHASE_W-1 -: LUT_ADDR_W];
         end
     endgenerate
 
     genvar l;
     generate
-        for (l=0; l<4; l=l+1) begin : G_LUT_A
+        for (l=0; l<TONES/2; l=l+1) begin : G_LUT_A
             lut_rom2r #(
                 .LUT_DEPTH (LUT_DEPTH),
                 .INIT_FILE (SINE_LUT_INIT)
@@ -150,13 +152,13 @@ module compute_core_child #(
     // wav_a[*] is valid 1 cycle after lut_addr_a[*].
 
     // =========================================================================
-    // 4) 8x multipliers (Q1.31 × Q1.FRAC_BITS -> Q1.31), AXIS handshakes
+    // 4) TONES x multipliers (Q1.31 × Q1.FRAC_BITS -> Q1.31), AXIS handshakes
     // =========================================================================
-    wire                  mul_v [0:7];
-    wire signed [31:0]    mul_y [0:7];
+    wire [TONES-1:0]      mul_v;
+    wire signed [31:0]    mul_y [0:TONES-1];
 
     generate
-        for (u=0; u<8; u=u+1) begin : MULS_A
+        for (u=0; u<TONES; u=u+1) begin : MULS_A
             q_mul_param_hold #(
                 .DATA_WIDTH (DATA_WIDTH),
                 .GAIN_WIDTH (GAIN_W),
@@ -178,33 +180,56 @@ module compute_core_child #(
     endgenerate
 
     // All multipliers share timing → valids align
-    wire mul_all_valid = &{mul_v[0],mul_v[1],mul_v[2],mul_v[3],mul_v[4],mul_v[5],mul_v[6],mul_v[7]};
+    wire mul_all_valid = &mul_v;
 
     // =========================================================================
-    // 5) 8-input adder tree (AXIS) for Channel A
+    // 5) 8- or 16-input adder tree (AXIS) for Channel A
     // =========================================================================
-    wire [8*DATA_WIDTH-1:0] adder_in_bus =
-        { mul_y[7], mul_y[6], mul_y[5], mul_y[4],
-          mul_y[3], mul_y[2], mul_y[1], mul_y[0] };
+    wire [TONES*DATA_WIDTH-1:0] adder_in_bus;
+    generate
+        for (u=0; u<TONES; u=u+1) begin : ADDER_IN_A
+            assign adder_in_bus[(u+1)*DATA_WIDTH-1 -: DATA_WIDTH] = mul_y[u];
+        end
+    endgenerate
 
     wire                    sumA_valid;
     wire signed [31:0]      sumA_q31;
 
-    adder_tree8_axis #(
-        .DATA_WIDTH (DATA_WIDTH),
-        .ACC_WIDTH  (DATA_WIDTH+3)
-    ) u_adder_chA (
-        .clk           (clk),
-        .rst_n         (rst_n),
-        // input AXIS
-        .s_axis_tvalid (mul_all_valid && can_load),
-        .s_axis_tready (/* unused */),
-        .s_axis_tdata  (adder_in_bus),
-        // output AXIS
-        .m_axis_tvalid (sumA_valid),
-        .m_axis_tready (can_load),
-        .m_axis_tdata  (sumA_q31)
-    );
+    generate
+        if (TONES == 16) begin : G_ADDER16
+            adder_tree16_axis #(
+                .DATA_WIDTH (DATA_WIDTH),
+                .ACC_WIDTH  (DATA_WIDTH+4)
+            ) u_adder_chA (
+                .clk           (clk),
+                .rst_n         (rst_n),
+                // input AXIS
+                .s_axis_tvalid (mul_all_valid && can_load),
+                .s_axis_tready (/* unused */),
+                .s_axis_tdata  (adder_in_bus),
+                // output AXIS
+                .m_axis_tvalid (sumA_valid),
+                .m_axis_tready (can_load),
+                .m_axis_tdata  (sumA_q31)
+            );
+        end else begin : G_ADDER8
+            adder_tree8_axis #(
+                .DATA_WIDTH (DATA_WIDTH),
+                .ACC_WIDTH  (DATA_WIDTH+3)
+            ) u_adder_chA (
+                .clk           (clk),
+                .rst_n         (rst_n),
+                // input AXIS
+                .s_axis_tvalid (mul_all_valid && can_load),
+                .s_axis_tready (/* unused */),
+                .s_axis_tdata  (adder_in_bus),
+                // output AXIS
+                .m_axis_tvalid (sumA_valid),
+                .m_axis_tready (can_load),
+                .m_axis_tdata  (sumA_q31)
+            );
+        end
+    endgenerate
 
     // =========================================================================
     // 6) Final output register for this block (AXIS out)
@@ -220,7 +245,7 @@ module compute_core_child #(
 
             // load new when adder output available and we can load
             if (sumA_valid && can_load) begin
-                out_data_r  <= sumA_q31; // Q1.31 sum of 8 tones (Channel A)
+                out_data_r  <= sumA_q31; // Q1.31 sum of TONES tones (Channel A)
                 out_valid_r <= 1'b1;
             end
             // else: hold
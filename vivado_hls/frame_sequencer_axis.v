@@ -0,0 +1,114 @@
+`timescale 1ns/1ps
+// -----------------------------------------------------------------------------
+// frame_sequencer_axis
+// - Hardware frame sequencer between AXI DMA M_AXIS_MM2S (instruction list in
+//   DDR) and waveform_generator_v5 S_AXIS
+// - Instruction list = the normal command words plus optional DWELL words:
+//     [31:28] CMD   : D=DWELL
+//     [27:0]  CYCLES: clk cycles the NEXT committed frame stays on air
+//   A DWELL word is consumed here (not forwarded) and stays in effect for all
+//   following frames until the next DWELL word
+// - INDEX/GAIN/SAFE words pass straight through into the shadow bank
+// - COMMIT is held until the dwell of the frame on air has elapsed, then
+//   forwarded; frame timing is therefore exact to one clk cycle
+// - arm=0: COMMITs are held, the timer is cleared and the dwell falls back
+//   to default_dwell (unless a DWELL word arrives first). arm=1: the first
+//   COMMIT fires immediately, later ones on the dwell grid
+// - Status: frame_cnt counts forwarded COMMITs; late_cnt counts COMMITs that
+//   arrived after their slot had already opened (DMA/list underrun)
+// -----------------------------------------------------------------------------
+module frame_sequencer_axis #(
+    parameter integer DWELL_W = 28
+)(
+    input  wire               clk,
+    input  wire               rst_n,
+
+    // Control (AXI GPIO, same clock domain)
+    input  wire               arm,            // level: 1 = run
+    input  wire               clear,          // level: 1 = clear status counters
+    input  wire [31:0]        default_dwell,  // cycles per frame when no DWELL word
+
+    // S_AXIS from AXI DMA (MM2S)
+    input  wire [31:0]        s_axis_tdata,
+    input  wire               s_axis_tvalid,
+    output wire               s_axis_tready,
+    input  wire               s_axis_tlast,   // end of DMA transfer (ignored)
+
+    // M_AXIS to waveform_generator_v5
+    output wire [31:0]        m_axis_tdata,
+    output wire               m_axis_tvalid,
+    input  wire               m_axis_tready,
+
+    // Status
+    output reg  [31:0]        frame_cnt,
+    output reg  [31:0]        late_cnt,
+    output wire               commit_pulse    // 1-cycle pulse per forwarded COMMIT
+);
+    localparam [3:0] CMD_DWELL  = 4'hD;
+    localparam [3:0] CMD_COMMIT = 4'hF;
+
+    wire [3:0] cmd       = s_axis_tdata[31:28];
+    wire       is_commit = (cmd == CMD_COMMIT);
+    wire       is_dwell  = (cmd == CMD_DWELL);
+
+    reg  [DWELL_W-1:0] dwell_next;   // dwell of the next committed frame
+    reg  [DWELL_W-1:0] timer;        // cycles left before the next COMMIT may fire
+    reg                primed;       // a frame is on air
+    reg                overdue;      // slot opened with no COMMIT waiting
+
+    wire slot_open = arm && (timer == {DWELL_W{1'b0}});
+    wire hold      = is_commit && !slot_open;
+
+    assign m_axis_tdata  = s_axis_tdata;
+    assign m_axis_tvalid = s_axis_tvalid && !is_dwell && !hold;
+    assign s_axis_tready = is_dwell ? 1'b1 : (m_axis_tready && !hold);
+
+    wire dwell_take = s_axis_tvalid && is_dwell;
+    assign commit_pulse = s_axis_tvalid && is_commit && slot_open && m_axis_tready;
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            dwell_next <= {DWELL_W{1'b0}};
+            timer      <= {DWELL_W{1'b0}};
+            primed     <= 1'b0;
+            overdue    <= 1'b0;
+        end else begin
+            // Dwell for upcoming frames
+            if (dwell_take)
+                dwell_next <= s_axis_tdata[DWELL_W-1:0];
+            else if (!arm)
+                dwell_next <= default_dwell[DWELL_W-1:0];
+
+            // Slot timer
+            if (!arm) begin
+                timer   <= {DWELL_W{1'b0}};
+                primed  <= 1'b0;
+                overdue <= 1'b0;
+            end else if (commit_pulse) begin
+                // Committed frame stays on air for dwell cycles (this one included)
+                timer   <= (dwell_next == {DWELL_W{1'b0}}) ? {DWELL_W{1'b0}}
+                                                           : dwell_next - {{(DWELL_W-1){1'b0}},1'b1};
+                primed  <= 1'b1;
+                overdue <= 1'b0;
+            end else begin
+                if (timer != {DWELL_W{1'b0}})
+                    timer <= timer - {{(DWELL_W-1){1'b0}},1'b1};
+                else if (primed)
+                    overdue <= 1'b1;
+            end
+        end
+    end
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            frame_cnt <= 32'd0;
+            late_cnt  <= 32'd0;
+        end else if (clear) begin
+            frame_cnt <= 32'd0;
+            late_cnt  <= 32'd0;
+        end else if (commit_pulse) begin
+            frame_cnt <= frame_cnt + 32'd1;
+            if (overdue) late_cnt <= late_cnt + 32'd1;
+        end
+    end
+endmodule
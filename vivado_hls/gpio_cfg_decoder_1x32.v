@@ -5,16 +5,23 @@
 // - Command word format:
 //     [31:28] CMD   : 1=INDEX, 2=GAIN, C=SAFE, F=COMMIT
 //     [27]    CH    : 0=A, 1=B
-//     [26:24] TONE  : 0..7
-//     [23:20] RSV   : 0
+//     [26:24] TONE  : tone bits 2:0
+//     [23]    TONE3 : [NEW] tone bit 3 (16-tone build), 0 on 8-tone builds
+//     [22:20] RSV   : 0
 //     [19:0]  DATA  : payload (index[IDX_W-1:0] or gain[17:0] or SAFE bit0)
+//   (CMD D=DWELL is consumed by frame_sequencer_axis, B=TRIG by
+//    axis_commit_trigger_gate upstream; any other CMD that reaches this
+//    decoder is a no-op)
+// - INDEX/GAIN for a tone >= TONES are dropped, so a 16-tone stream never
+//   aliases onto tones 0..7 of an 8-tone build
 // - Pulsed outputs (1 cycle when a matching command is accepted).
 // - Always-ready sink by default (s_axis_tready=1). If you need backpressure
 //   later, add a small skid buffer and drive tready accordingly.
 // -----------------------------------------------------------------------------
 module gpio_cfg_decoder_axis32 #(
     parameter integer IDX_W  = 10,
-    parameter integer GAIN_W = 18
+    parameter integer GAIN_W = 18,
+    parameter integer TONES  = 8     // [NEW] tones per channel: 8 or 16
 )(
     input  wire         clk,
     input  wire         rst_n,
@@ -28,7 +35,7 @@ module gpio_cfg_decoder_axis32 #(
     output reg          idx_we,
     output reg          gain_we,
     output reg          wr_ch,
-    output reg  [2:0]   wr_tone,
+    output reg  [3:0]   wr_tone,
     output reg  [IDX_W-1:0]  wr_index,
     output reg  [GAIN_W-1:0] wr_gain,
     output reg          commit_req,
@@ -38,7 +45,8 @@ module gpio_cfg_decoder_axis32 #(
     // Fields
     wire [3:0]  cmd   = s_axis_tdata[31:28];
     wire        ch    = s_axis_tdata[27];
-    wire [2:0]  tone  = s_axis_tdata[26:24];
+    wire [3:0]  tone  = {s_axis_tdata[23], s_axis_tdata[26:24]};
+    wire        tone_ok = (tone < TONES);
     wire [19:0] data  = s_axis_tdata[19:0];
 
     localparam [3:0] CMD_IDX            = 4'h1;
@@ -53,7 +61,7 @@ module gpio_cfg_decoder_axis32 #(
     always @(posedge clk or negedge rst_n) begin
         if (!rst_n) begin
             wr_ch           <= 1'b0;
-            wr_tone         <= 3'd0;
+            wr_tone         <= 4'd0;
             idx_we          <= 1'b0;
             gain_we         <= 1'b0;
             wr_index        <= {IDX_W{1'b0}};
@@ -70,13 +78,13 @@ module gpio_cfg_decoder_axis32 #(
             if (accept) begin
                 case (cmd)
                     CMD_IDX: begin
-                        idx_we    <= 1'b1;
+                        idx_we    <= tone_ok;
                         wr_ch    <= ch;
                         wr_tone  <= tone;
                         wr_index <= data[IDX_W-1:0];
                     end
                     CMD_GAIN: begin
-                        gain_we     <= 1'b1;
+                        gain_we     <= tone_ok;
                         wr_ch       <= ch;
                         wr_tone     <= tone;
                         wr_gain     <= data[GAIN_W-1:0]; // assume Q1.17 in bits[17:0]
@@ -5,10 +5,15 @@
 // - Parameterizable small synchronous FIFO (power-of-two DEPTH recommended)
 // - No backpressure to source (no busy). If FIFO is full and wen=1, set overflow.
 // - Supports simultaneous push (wen) and pop (tvalid&tready) in same cycle.
+// - DEPTH 256: while axis_commit_trigger_gate holds a COMMIT the player keeps
+//   writing; the FIFO holds the held COMMIT plus 3 full 16-tone frames (65
+//   words each). Route overflow to a status GPIO input to see dropped words.
+//   The size comes from that word count; tb_commit_trigger_gate.v covers the
+//   full-FIFO hold but has not been run in a simulator yet
 // -----------------------------------------------------------------------------
 module gpio_to_axis_fifo_sync #(
     parameter integer DATA_WIDTH = 32,
-    parameter integer DEPTH      = 32  // choose sufficiently large (power-of-two preferred)
+    parameter integer DEPTH      = 256 // choose sufficiently large (power-of-two preferred)
 )(
     input  wire                   clk,
     input  wire                   rst_n,
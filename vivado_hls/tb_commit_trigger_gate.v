@@ -0,0 +1,257 @@
+`timescale 1ns / 1ps
+// -----------------------------------------------------------------------------
+// tb_commit_trigger_gate
+// - Self-checking bench for the multi-board start path of waveform_generator_v5:
+//   gpio_to_axis_fifo_sync (GPIO feed, no backpressure) -> waveform_generator_v5
+//   (axis_commit_trigger_gate -> decoder -> ping-pong banks)
+// - Drives the top-level trig_in / trig_out / trig_armed_o ports; a released
+//   COMMIT is seen as a toggle of active_bank_o
+// - Cases: plain COMMIT, follower hold/release with 3 full frames buffered
+//   behind the held COMMIT, FIFO filled to exactly DEPTH behind a held COMMIT,
+//   trigger edge before the COMMIT, timeout (miss_cnt), LEAD pulse on trig_out,
+//   FIFO overflow sticky bit
+// - Prints [PASS]/[FAIL] per check and a summary, then $finish
+// - Run: iverilog -g2005 -o tb_gate tb_commit_trigger_gate.v waveform_top.v
+//        axis_commit_trigger_gate.v gpio_to_axis_fifo_sync.v <core sources>
+//        && vvp tb_gate   (or add it as the xsim top in the Vivado project)
+// - Status: not simulated yet. It was written together with the DEPTH 256
+//   change and neither has been through a simulator; treat both as
+//   unverified until this bench reports [TB] PASS
+// -----------------------------------------------------------------------------
+module tb_commit_trigger_gate;
+
+    localparam integer FRAME_WORDS = 65;     // full 16-tone frame (2*2*16 + COMMIT)
+    localparam integer FIFO_DEPTH  = 256;
+    localparam integer TMO_CYCLES  = 1024;   // one TMO unit (gate TMO_SHIFT = 10)
+
+    reg clk;
+    reg rst_n;
+
+    // Clock generator (8ns period = 125MHz)
+    initial begin
+        clk = 0;
+        forever #4 clk = ~clk;
+    end
+
+    // GPIO-like source
+    reg         wen;
+    reg  [31:0] wdata;
+    wire        fifo_overflow;
+
+    wire [31:0] cmd_tdata;
+    wire        cmd_tvalid;
+    wire        cmd_tready;
+
+    reg         trig_in;
+    wire        trig_out;
+    wire        trig_armed_o;
+    wire        active_bank_o;
+
+    gpio_to_axis_fifo_sync #(
+        .DATA_WIDTH(32),
+        .DEPTH     (FIFO_DEPTH)
+    ) u_fifo (
+        .clk          (clk),
+        .rst_n        (rst_n),
+        .wen          (wen),
+        .wdata        (wdata),
+        .overflow     (fifo_overflow),
+        .m_axis_tdata (cmd_tdata),
+        .m_axis_tvalid(cmd_tvalid),
+        .m_axis_tready(cmd_tready)
+    );
+
+    waveform_generator_v5 dut (
+        .clk          (clk),
+        .rst_n        (rst_n),
+        .s_axis_tdata (cmd_tdata),
+        .s_axis_tvalid(cmd_tvalid),
+        .s_axis_tready(cmd_tready),
+        .trig_in      (trig_in),
+        .trig_out     (trig_out),
+        .trig_armed_o (trig_armed_o),
+        .active_bank_o(active_bank_o),
+        .m_axis_tdata (),
+        .m_axis_tvalid(),
+        .m_axis_tready(1'b1)
+    );
+
+    // -------------------------------------------------------------------------
+    // Monitors
+    // -------------------------------------------------------------------------
+    integer commits;        // COMMITs that reached the banks
+    integer lead_pulses;    // rising edges on trig_out
+    reg     bank_q;
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            commits <= 0;
+            bank_q  <= 1'b0;
+        end else begin
+            bank_q <= active_bank_o;
+            if (active_bank_o != bank_q) commits <= commits + 1;
+        end
+    end
+
+    initial lead_pulses = 0;
+    always @(posedge trig_out) lead_pulses = lead_pulses + 1;
+
+    // -------------------------------------------------------------------------
+    // Helpers
+    // -------------------------------------------------------------------------
+    integer errors;
+
+    task check(input cond, input [8*64-1:0] what);
+        begin
+            if (cond) $display("[PASS] %0s", what);
+            else begin
+                $display("[FAIL] %0s (t=%0t)", what, $time);
+                errors = errors + 1;
+            end
+        end
+    endtask
+
+    // One word through the FIFO: the FIFO enqueues on the rising edge of wen
+    task push(input [31:0] w);
+        begin
+            @(posedge clk); wdata <= w; wen <= 1'b1;
+            @(posedge clk); wen <= 1'b0;
+        end
+    endtask
+
+    // INDEX writes to ch0/tone0, then COMMIT
+    task push_frame;
+        integer k;
+        begin
+            for (k = 0; k < FRAME_WORDS - 1; k = k + 1)
+                push(32'h1000_0000 | k);
+            push(32'hF000_0000);
+        end
+    endtask
+
+    function [31:0] trig_word(input [17:0] tmo, input lead, input arm);
+        trig_word = {4'hB, 8'h00, tmo, lead, arm};
+    endfunction
+
+    // Asynchronous pulse on the shared line (off the clk grid)
+    task pulse_trig_in;
+        begin
+            #3 trig_in = 1'b1;
+            #101 trig_in = 1'b0;
+        end
+    endtask
+
+    task idle(input integer n);
+        begin
+            repeat (n) @(posedge clk);
+        end
+    endtask
+
+    // -------------------------------------------------------------------------
+    // Stimulus
+    // -------------------------------------------------------------------------
+    integer c0, t0, m0;
+
+    initial begin
+        errors  = 0;
+        rst_n   = 1'b0;
+        wen     = 1'b0;
+        wdata   = 32'd0;
+        trig_in = 1'b0;
+        idle(10);
+        rst_n = 1'b1;
+        idle(10);
+
+        // 1) No TRIG: COMMIT passes straight through
+        push(32'hF000_0000);
+        idle(20);
+        check(commits == 1, "plain COMMIT toggles the bank");
+        check(!trig_armed_o, "gate idle without TRIG");
+
+        // 2) Follower: TRIG (no timeout), frame 0 held, 3 full frames queue behind it
+        c0 = commits; t0 = dut.u_trig.trig_cnt;
+        push(trig_word(18'd0, 1'b0, 1'b1));
+        idle(4);
+        check(trig_armed_o, "TRIG ARM sets trig_armed_o");
+        push_frame;                         // frame 0: INDEX words pass, COMMIT held
+        push_frame;
+        push_frame;
+        push_frame;
+        idle(200);
+        check(commits == c0, "COMMIT held while armed");
+        check(trig_armed_o, "still armed before the trigger");
+        check(!fifo_overflow, "FIFO holds the held COMMIT plus 3 frames");
+        pulse_trig_in;
+        idle(400);
+        check(!trig_armed_o, "trig_in edge disarms the gate");
+        check(commits == c0 + 4, "held COMMIT and the buffered frames released");
+        check(dut.u_trig.trig_cnt == t0 + 1, "trig_cnt counts the release");
+        check(lead_pulses == 0, "follower does not drive trig_out");
+
+        // 2b) Full FIFO: the held COMMIT plus DEPTH-1 words, not one more
+        c0 = commits;
+        push(trig_word(18'd0, 1'b0, 1'b1));
+        idle(4);
+        push_frame;                         // INDEX words pass, COMMIT held at the head
+        push_frame;
+        push_frame;
+        push_frame;
+        repeat (FIFO_DEPTH - 1 - 3*FRAME_WORDS) push(32'h1000_0000);
+        idle(20);
+        check(u_fifo.count == FIFO_DEPTH, "FIFO full behind the held COMMIT");
+        check(!fifo_overflow, "a full FIFO is not an overflow");
+        check(commits == c0, "COMMIT still held with the FIFO full");
+        pulse_trig_in;
+        idle(FIFO_DEPTH + 100);
+        check(commits == c0 + 4, "full FIFO drains: held COMMIT and 3 frames released");
+        check(u_fifo.count == 0, "FIFO empty after the release");
+        check(!fifo_overflow, "no word lost across the full hold");
+
+        // 3) Edge before the COMMIT: it goes through as soon as it arrives
+        c0 = commits;
+        push(trig_word(18'd0, 1'b0, 1'b1));
+        idle(4);
+        pulse_trig_in;
+        idle(10);
+        push(32'hF000_0000);
+        idle(20);
+        check(commits == c0 + 1, "early edge releases the next COMMIT");
+        check(!trig_armed_o, "gate disarmed after an early edge");
+
+        // 4) Timeout: no edge, released after TMO units
+        c0 = commits; m0 = dut.u_trig.miss_cnt;
+        push(trig_word(18'd2, 1'b0, 1'b1));
+        push(32'hF000_0000);
+        idle(TMO_CYCLES);
+        check(commits == c0 && trig_armed_o, "COMMIT held until the timeout");
+        idle(TMO_CYCLES + 100);
+        check(commits == c0 + 1, "timeout releases the COMMIT");
+        check(dut.u_trig.miss_cnt == m0 + 1, "miss_cnt counts the timeout");
+        check(!trig_armed_o, "gate disarmed after the timeout");
+
+        // 5) LEAD: the held COMMIT pulses trig_out and releases on its own edge
+        c0 = commits; t0 = dut.u_trig.trig_cnt;
+        push(trig_word(18'd0, 1'b1, 1'b1));
+        push(32'hF000_0000);
+        idle(60);
+        check(lead_pulses == 1, "LEAD COMMIT pulses trig_out once");
+        check(commits == c0 + 1, "leader releases on its own trig_out");
+        check(dut.u_trig.trig_cnt == t0 + 1, "leader release counted in trig_cnt");
+        check(!trig_armed_o, "leader disarmed after release");
+
+        // 6) Overflow: more than DEPTH words behind a held COMMIT
+        push(trig_word(18'd0, 1'b0, 1'b1));
+        push(32'hF000_0000);
+        repeat (FIFO_DEPTH + 1) push(32'h1000_0000);
+        idle(10);
+        check(fifo_overflow, "FIFO overflow sticky bit set on a full push");
+        pulse_trig_in;
+        idle(FIFO_DEPTH + 50);
+        check(fifo_overflow, "overflow stays set until reset");
+
+        if (errors == 0) $display("[TB] PASS");
+        else             $display("[TB] %0d check(s) failed", errors);
+        $finish;
+    end
+
+endmodule
@@ -1,7 +1,12 @@
 `timescale 1ns/1ps
 // -----------------------------------------------------------------------------
 // waveform_generator_v5 (Top Shell) -- Dual channel (A+B) with AXI-Stream cmd in
-// - S_AXIS 32-bit commands -> decoder -> ping-pong config (A/B, 8 tones each)
+// - S_AXIS 32-bit commands -> trigger gate -> decoder -> ping-pong config (A/B, TONES each)
+// - TONES = 8 (default) or 16: the 16-tone build sums through adder_tree16_axis
+//   and takes tone bit 3 from command bit [23]
+// - TRIG command holds the next COMMIT for the shared trigger line (trig_in /
+//   trig_out), so several boards start a list on the same clk edge
+//   (GPIO feed: gpio_to_axis_fifo_sync needs DEPTH >= 256 to buffer behind it)
 // - SAFE command writes commit_safe_reg; COMMIT toggles active bank if safe==1
 // - Two compute_core_child instances (A / B) produce Q1.31 streams
 // - AND-join both channels and pack {A[31:16], B[31:16]} to 32-bit M_AXIS
@@ -11,6 +16,7 @@ module waveform_generator_v5 #(
     parameter integer DATA_WIDTH    = 32,  // child stream data width (Q1.31 typical)
     parameter integer IDX_W         = 10,  // index width into phase/LUT tables
     parameter integer GAIN_W        = 18,  // gain width (e.g., Q1.17)
+    parameter integer TONES         = 8,   // [NEW] tones per channel: 8 or 16
     parameter integer STARTUP_DELAY = 0
 )(
     input  wire                   clk,
@@ -21,6 +27,11 @@ module waveform_generator_v5 #(
     input  wire                   s_axis_tvalid,
     output wire                   s_axis_tready,
 
+    // Multi-board start trigger (axis_commit_trigger_gate)
+    input  wire                   trig_in,
+    output wire                   trig_out,
+    output wire                   trig_armed_o,
+
     // Debug/monitor
     output wire                   active_bank_o,
 
@@ -29,13 +40,36 @@ module waveform_generator_v5 #(
     output wire                   m_axis_tvalid,
     input  wire                   m_axis_tready
 );
+    // -------------------------------------------------------------------------
+    // 0) Commit trigger gate (TRIG consumed, first COMMIT held for trig_in)
+    // -------------------------------------------------------------------------
+    wire [31:0] cmd_tdata;
+    wire        cmd_tvalid;
+    wire        cmd_tready;
+
+    axis_commit_trigger_gate u_trig (
+        .clk          (clk),
+        .rst_n        (rst_n),
+        .trig_in      (trig_in),
+        .trig_out     (trig_out),
+        .s_axis_tdata (s_axis_tdata),
+        .s_axis_tvalid(s_axis_tvalid),
+        .s_axis_tready(s_axis_tready),
+        .m_axis_tdata (cmd_tdata),
+        .m_axis_tvalid(cmd_tvalid),
+        .m_axis_tready(cmd_tready),
+        .armed_o      (trig_armed_o),
+        .trig_cnt     (),
+        .miss_cnt     ()
+    );
+
     // -------------------------------------------------------------------------
     // 1) AXIS command decoder (INDEX/GAIN/SAFE/COMMIT)
     // -------------------------------------------------------------------------
     wire               idx_we;
     wire               gain_we;
     wire               wr_ch;
-    wire [2:0]         wr_tone;
+    wire [3:0]         wr_tone;
     wire [IDX_W-1:0]   wr_index;
     wire [GAIN_W-1:0]  wr_gain;
     wire               commit_req;
@@ -44,13 +78,14 @@ module waveform_generator_v5 #(
 
     gpio_cfg_decoder_axis32 #(
         .IDX_W (IDX_W),
-        .GAIN_W(GAIN_W)
+        .GAIN_W(GAIN_W),
+        .TONES (TONES)
     ) u_dec (
         .clk          (clk),
         .rst_n        (rst_n),
-        .s_axis_tdata (s_axis_tdata),
-        .s_axis_tvalid(s_axis_tvalid),
-        .s_axis_tready(s_axis_tready),   // currently always 1
+        .s_axis_tdata (cmd_tdata),
+        .s_axis_tvalid(cmd_tvalid),
+        .s_axis_tready(cmd_tready),      // currently always 1
         .idx_we       (idx_we),
         .gain_we      (gain_we),
         .wr_ch        (wr_ch),
@@ -72,17 +107,18 @@ module waveform_generator_v5 #(
     end
 
     // -------------------------------------------------------------------------
-    // 2) Ping-pong configuration banks (A/B, 8 tones each)
+    // 2) Ping-pong configuration banks (A/B, TONES each)
     // -------------------------------------------------------------------------
-    wire [8*IDX_W -1:0] index_a_bus_int;
-    wire [8*GAIN_W-1:0] gain_a_bus_int;
-    wire [8*IDX_W -1:0] index_b_bus_int;
-    wire [8*GAIN_W-1:0] gain_b_bus_int;
+    wire [TONES*IDX_W -1:0] index_a_bus_int;
+    wire [TONES*GAIN_W-1:0] gain_a_bus_int;
+    wire [TONES*IDX_W -1:0] index_b_bus_int;
+    wire [TONES*GAIN_W-1:0] gain_b_bus_int;
     wire                 active_bank_int;
 
     cfg_pingpong_idx_gain_2x8 #(
         .IDX_W (IDX_W),
-        .GAIN_W(GAIN_W)
+        .GAIN_W(GAIN_W),
+        .TONES (TONES)
     ) u_cfg (
         .clk         (clk),
         .rst_n       (rst_n),
@@ -113,6 +149,7 @@ module waveform_generator_v5 #(
 
     compute_core_child #(
         .DATA_WIDTH(DATA_WIDTH),
+        .TONES     (TONES),
         .IDX_W     (IDX_W),
         .GAIN_W    (GAIN_W)
     ) u_core_A (
@@ -132,6 +169,7 @@ module waveform_generator_v5 #(
 
     compute_core_child #(
         .DATA_WIDTH(DATA_WIDTH),
+        .TONES     (TONES),
         .IDX_W     (IDX_W),
         .GAIN_W    (GAIN_W)
     ) u_core_B (